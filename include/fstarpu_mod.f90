@@ -67,6 +67,7 @@ module fstarpu_mod
         type(c_ptr), bind(C) :: FSTARPU_TASK_END_DEP
         type(c_ptr), bind(C) :: FSTARPU_NODE_SELECTION_POLICY
         type(c_ptr), bind(C) :: FSTARPU_TASK_SCHED_DATA
+        type(c_ptr), bind(C) :: FSTARPU_TASK_DEADLINE
 
         type(c_ptr), bind(C) :: FSTARPU_VALUE
         type(c_ptr), bind(C) :: FSTARPU_SCHED_CTX
@@ -87,6 +88,7 @@ module fstarpu_mod
         type(c_ptr), bind(C) :: FSTARPU_SCHED_CTX_AWAKE_WORKERS
         type(c_ptr), bind(C) :: FSTARPU_SCHED_CTX_POLICY_INIT
         type(c_ptr), bind(C) :: FSTARPU_SCHED_CTX_USER_DATA
+        type(c_ptr), bind(C) :: FSTARPU_SCHED_CTX_FAIR_SHARE_WEIGHT
 
         type(c_ptr), bind(C) :: FSTARPU_NOWHERE
         type(c_ptr), bind(C) :: FSTARPU_CPU
@@ -2551,6 +2553,7 @@ module fstarpu_mod
                         FSTARPU_NAME    = fstarpu_get_constant(C_CHAR_"FSTARPU_NAME"//C_NULL_CHAR)
                         FSTARPU_NODE_SELECTION_POLICY   = fstarpu_get_constant(C_CHAR_"FSTARPU_NODE_SELECTION_POLICY"//C_NULL_CHAR)
                         FSTARPU_TASK_SCHED_DATA = fstarpu_get_constant(C_CHAR_"FSTARPU_TASK_SCHED_DATA"//C_NULL_CHAR)
+                        FSTARPU_TASK_DEADLINE = fstarpu_get_constant(C_CHAR_"FSTARPU_TASK_DEADLINE"//C_NULL_CHAR)
 
                         FSTARPU_VALUE   = fstarpu_get_constant(C_CHAR_"FSTARPU_VALUE"//C_NULL_CHAR)
                         FSTARPU_SCHED_CTX   = fstarpu_get_constant(C_CHAR_"FSTARPU_SCHED_CTX"//C_NULL_CHAR)
@@ -2579,6 +2582,8 @@ module fstarpu_mod
                             fstarpu_get_constant(C_CHAR_"FSTARPU_SCHED_CTX_POLICY_INIT"//C_NULL_CHAR)
                         FSTARPU_SCHED_CTX_USER_DATA    = &
                             fstarpu_get_constant(C_CHAR_"FSTARPU_SCHED_CTX_USER_DATA"//C_NULL_CHAR)
+                        FSTARPU_SCHED_CTX_FAIR_SHARE_WEIGHT    = &
+                            fstarpu_get_constant(C_CHAR_"FSTARPU_SCHED_CTX_FAIR_SHARE_WEIGHT"//C_NULL_CHAR)
 
                         FSTARPU_NOWHERE = &
                             fstarpu_get_constant(C_CHAR_"FSTARPU_NOWHERE"//C_NULL_CHAR)
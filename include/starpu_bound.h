@@ -62,6 +62,22 @@ void starpu_bound_print_dot(FILE *output);
 */
 void starpu_bound_compute(double *res, double *integer_res, int integer);
 
+/**
+   Get theoretical lower bounds (in ms) which are cheap to compute even
+   for large numbers of tasks. \p area is set to the total work of the
+   tasks on their fastest worker divided by the number of workers. \p
+   critical_path is set to the longest chain of task dependencies, each
+   task running on its fastest worker, or 0 if dependencies were not
+   recorded. \p kinds is set to the solution of the linear program over
+   task kinds and worker kinds, bounded by the critical path (the
+   maximum of the two other bounds if glpk support was not detected by
+   the configure script). Tasks whose performance models are not
+   calibrated are ignored. Any of the pointers may be <c>NULL</c>.
+
+   See \ref TheoreticalLowerBoundOnExecutionTime for more details.
+*/
+void starpu_bound_compute_fast(double *area, double *critical_path, double *kinds);
+
 /**
    Emit the Linear Programming system on \p output for the recorded
    tasks, in the lp format
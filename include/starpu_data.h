@@ -550,6 +550,23 @@ void starpu_data_wont_use(starpu_data_handle_t handle);
 */
 int starpu_data_evict_from_node(starpu_data_handle_t handle, unsigned node);
 
+/**
+   Move the pages of the home copy of \p handle to the NUMA memory node
+   \p node in place, i.e. without allocating a new replicate and
+   copying the data, and make \p node the new home node of \p handle.
+   This waits for the tasks accessing \p handle to complete. The home
+   node and \p node have to be CPU memory nodes, and \p handle must not
+   be partitioned. Since pages are moved as a whole, other data sharing
+   pages with \p handle are moved as well. See also \ref
+   STARPU_DATA_NUMA_HOME to let StarPU determine the home node from the
+   page placement on registration.
+
+   Return 0 on success, -EINVAL if the nodes are not CPU memory nodes,
+   -ENOSYS if this is not supported, or -EBUSY if the data is
+   partitioned or was allocated on \p node meanwhile.
+*/
+int starpu_data_migrate_home_node(starpu_data_handle_t handle, unsigned node);
+
 /**
    Set the write-through mask of the data \p handle (and
    its children), i.e. a bitmask of nodes where the data should be always
@@ -167,6 +167,17 @@ struct starpu_profiling_worker_info
 	/* TODO: add wasted time due to failed tasks */
 
 	double flops;
+
+	/** Part of the idle time that the worker spent spinning, waiting
+	 * for a task to come soon, during the profiling measurement interval. */
+	struct timespec spinning_time;
+	/** Part of the idle time that the worker spent yielding the CPU to
+	 * other threads between checks for tasks, during the profiling
+	 * measurement interval. */
+	struct timespec yielding_time;
+	/** Part of the idle time that the worker spent blocked in the system
+	 * until being woken up, during the profiling measurement interval. */
+	struct timespec parked_time;
 };
 
 /**
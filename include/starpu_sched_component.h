@@ -492,6 +492,67 @@ int starpu_sched_component_is_prio(struct starpu_sched_component *component);
 
 /** @} */
 
+/**
+   @name Flow-control Sharded Component API
+   @{
+*/
+
+/**
+   Parameters of the sharded component
+*/
+struct starpu_sched_component_sharded_data
+{
+	/**
+	   Number of shards, 0 means one per worker
+	*/
+	unsigned nshards;
+	/**
+	   Whether to keep the tasks of each shard sorted by priority
+	*/
+	int prio;
+};
+
+/**
+   return a component which stores tasks and lets its children pull them, like the fifo component (or the prio component when \p sharded_data->prio is set), but whose queue is split into several shards, each protected by its own lock. Each thread always pushes to the same shard, so that many threads can submit tasks concurrently without contending on a single lock. The order of the tasks is thus only kept between the tasks pushed by the same thread. \p sharded_data may be <c>NULL</c>, in which case there is one fifo shard per worker.
+*/
+struct starpu_sched_component *starpu_sched_component_sharded_create(struct starpu_sched_tree *tree, struct starpu_sched_component_sharded_data *sharded_data) STARPU_ATTRIBUTE_MALLOC;
+
+/**
+   return true iff \p component is a sharded component
+*/
+int starpu_sched_component_is_sharded(struct starpu_sched_component *component);
+
+/** @} */
+
+/**
+   @name Flow-control Deadline Component API
+   @{
+*/
+
+/**
+   Parameters of the deadline component
+*/
+struct starpu_sched_component_deadline_data
+{
+	/**
+	   Whether to subtract the expected length of the tasks from their
+	   deadline, to order them by laxity rather than by deadline
+	*/
+	int laxity;
+};
+
+/**
+   return a component which stores tasks and lets its children pull them. Tasks which have a starpu_task::deadline are given first, in increasing order of their deadline minus their shortest expected length, and minus the expected length of the path remaining after them when \ref STARPU_CRITICAL_PATH is set (least laxity first), or of their deadline when the length is not known or when \p deadline_data->laxity is 0 (earliest deadline first). Tasks without a deadline are given after them, by priority order. \p deadline_data may be <c>NULL</c>, in which case laxity is used.
+*/
+struct starpu_sched_component *starpu_sched_component_deadline_create(struct starpu_sched_tree *tree, struct starpu_sched_component_deadline_data *deadline_data) STARPU_ATTRIBUTE_MALLOC;
+
+/**
+   return true iff \p component is a deadline component
+*/
+int starpu_sched_component_is_deadline(struct starpu_sched_component *component);
+
+/** @} */
+
 /**
    @name Resource-mapping Work-Stealing Component API
    @{
@@ -514,6 +575,23 @@ int starpu_sched_tree_work_stealing_push_task(struct starpu_task *task);
 
 /** @} */
 
+/**
+   @name Resource-mapping Locality Component API
+   @{
+*/
+
+/**
+   return a component meant to be stacked following the machine hierarchy. Tasks are pushed to the child which already holds most of their input data, then to the child of the pushing worker, then to the least loaded child. Tasks for worker children are kept in one priority queue per child. When a worker pulls, it takes a task from its own queue, then steals from its siblings, and then from further and further subtrees through the parents.
+*/
+struct starpu_sched_component *starpu_sched_component_locality_create(struct starpu_sched_tree *tree, void *arg) STARPU_ATTRIBUTE_MALLOC;
+
+/**
+   return true iff \p component is a locality component
+*/
+int starpu_sched_component_is_locality(struct starpu_sched_component *component);
+
+/** @} */
+
 /**
    @name Resource-mapping Random Component API
    @{
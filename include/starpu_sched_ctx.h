@@ -100,6 +100,13 @@ extern "C" {
 */
 #define STARPU_SCHED_CTX_SUB_CTXS (11 << 16)
 
+/**
+   Used when calling starpu_sched_ctx_create() to specify the weight
+   of the context in the fair share of the workers it has in common
+   with other contexts, see starpu_sched_ctx_set_fair_share_weight().
+*/
+#define STARPU_SCHED_CTX_FAIR_SHARE_WEIGHT (12 << 16)
+
 /**
    Create a scheduling context with the given parameters
    (see below) and assign the workers in \p workerids_ctx to execute the
@@ -132,6 +139,10 @@ extern "C" {
    <li> ::STARPU_SCHED_CTX_USER_DATA, followed by a pointer
    to a custom user data structure, to be retrieved by \ref starpu_sched_ctx_get_user_data().
    </li>
+   <li> ::STARPU_SCHED_CTX_FAIR_SHARE_WEIGHT, followed by a double
+   representing the weight of the context in the fair share of the
+   workers, see starpu_sched_ctx_set_fair_share_weight().
+   </li>
    </ul>
    See \ref CreatingAContext for more details.
 */
@@ -422,6 +433,40 @@ int starpu_sched_ctx_max_priority_is_set(unsigned sched_ctx_id);
 
 /** @} */
 
+/**
+   @name Scheduling Context Fair Share
+   @{
+*/
+
+/**
+   Set the weight of the context \p sched_ctx_id in the fair share of
+   the workers it has in common with other contexts. Once a weight has
+   been set on any context, workers belonging to several contexts do
+   not pick the first context which has ready tasks any more, but the
+   one which has consumed the least execution time relative to its
+   weight (stride scheduling), so that over time each context gets a
+   share of the common workers proportional to its weight. Contexts
+   whose weight was not set get a weight of 1. This relies on the
+   scheduling policies of the contexts maintaining the task counters
+   of the contexts, see starpu_sched_ctx_list_task_counters_increment().
+   See \ref FairShareBetweenContexts for more details.
+*/
+void starpu_sched_ctx_set_fair_share_weight(unsigned sched_ctx_id, double weight);
+
+/**
+   Return the weight of the context \p sched_ctx_id in the fair share of
+   the workers, 1 if it was not set.
+*/
+double starpu_sched_ctx_get_fair_share_weight(unsigned sched_ctx_id);
+
+/**
+   Return the execution time (in µs) consumed by the tasks of the
+   context \p sched_ctx_id since fair share was enabled.
+*/
+double starpu_sched_ctx_get_fair_share_consumed(unsigned sched_ctx_id);
+
+/** @} */
+
 /**
    @name Scheduling Context Worker Collection
    @{
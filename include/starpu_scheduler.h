@@ -188,6 +188,13 @@ struct starpu_sched_policy
 	*/
 	int prefetches;
 
+	/** Whether this scheduling policy lets the core give a task made
+	    ready by the termination of another task directly to the worker
+	    which ran the latter, without pushing it to the policy. This is
+	    only done when \ref STARPU_SUCCESSOR_CONTINUATION is set.
+	*/
+	int successor_continuation;
+
 	/**
 	   Optional field. Name of the policy.
 	*/
@@ -492,12 +499,56 @@ double starpu_task_expected_energy_average(struct starpu_task *task, unsigned sc
 */
 double starpu_task_expected_conversion_time(struct starpu_task *task, struct starpu_perfmodel_arch *arch, unsigned nimpl);
 
+/**
+   Return the bottom level of the task \p task in micro-seconds, i.e. the
+   expected length of the longest path from the start of \p task to the end
+   of the task graph submitted so far, including \p task itself. Expected
+   lengths are averaged over the workers of the task context, see
+   starpu_task_expected_length_average(). This is only maintained when the
+   environment variable \ref STARPU_CRITICAL_PATH is set, 0 is returned
+   otherwise, or once the task has terminated.
+   See \ref SchedulingHelpers for more details.
+*/
+double starpu_task_bottom_level(struct starpu_task *task);
+
+/**
+   Return the slack of the task \p task in micro-seconds, i.e. by how much
+   its execution can be delayed without making the critical path of the task
+   graph submitted so far longer. 0 means that the task is on the critical
+   path. This is only maintained when the environment variable \ref
+   STARPU_CRITICAL_PATH is set, 0 is returned otherwise, or once the task has
+   terminated.
+   See \ref SchedulingHelpers for more details.
+*/
+double starpu_task_slack(struct starpu_task *task);
+
+/**
+   Return a priority hint for the task \p task, obtained by scaling its
+   bottom level relatively to the critical path length into the priority
+   range of the context \p sched_ctx_id. Tasks on the critical path thus get
+   the maximum priority. Scheduling policies can call it when a task is pushed
+   to order ready tasks. The minimum priority is returned when \ref
+   STARPU_CRITICAL_PATH is not set.
+   See \ref SchedulingHelpers for more details.
+*/
+int starpu_task_critical_path_priority(struct starpu_task *task, unsigned sched_ctx_id);
+
+/**
+   Return the expected length in micro-seconds of the critical path of the
+   task graph submitted so far, when the environment variable \ref
+   STARPU_CRITICAL_PATH is set.
+   See \ref SchedulingHelpers for more details.
+*/
+double starpu_critical_path_length(void);
+
 typedef void (*starpu_notify_ready_soon_func)(void *data, struct starpu_task *task, double delay);
 
 /**
    Register a callback to be called when it is determined when a task
    will be ready an estimated amount of time from now, because its
    last dependency has just started and we know how long it will take.
+   Only one callback can be registered at a time, passing <c>NULL</c> as
+   \p f unregisters it.
    See \ref SchedulingHelpers for more details.
 */
 void starpu_task_notify_ready_soon_register(starpu_notify_ready_soon_func f, void *data);
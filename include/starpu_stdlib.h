@@ -96,6 +96,21 @@ extern "C" {
 */
 #define STARPU_MALLOC_SIMULATION_UNIQUE ((1ULL)<<7)
 
+/**
+   Value passed to the function starpu_malloc_flags() to indicate that
+   the allocation should be backed by huge pages, to reduce TLB misses
+   when accessing big pieces of data. This is only used for
+   allocations of at least one huge page. By default transparent huge
+   pages are requested from the system, see \ref STARPU_HUGEPAGE_SIZE
+   for using explicitly reserved huge pages instead. This is ignored
+   when the allocation gets pinned for CUDA or HIP. Memory allocated
+   this way needs to be freed by calling the function
+   starpu_free_flags() with the same flag and size. \ref
+   STARPU_HUGEPAGES can be used to make StarPU use this flag for the
+   data it allocates in main memory.
+*/
+#define STARPU_MALLOC_HUGEPAGES ((1ULL) << 8)
+
 /**
    @deprecated
    Equivalent to starpu_malloc(). This macro is provided to avoid
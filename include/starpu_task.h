@@ -118,6 +118,26 @@ extern "C" {
 */
 #define STARPU_CODELET_NOPLANS (1 << 2)
 
+/**
+   Value to be set in starpu_codelet::flags to run the CPU functions of
+   the codelet on their own stack, so that they can call
+   starpu_task_yield() and the like.
+   See \ref CooperativeTaskYielding for more details.
+*/
+#define STARPU_CODELET_YIELDABLE (1 << 3)
+
+/**
+   Value to be set in starpu_codelet::flags to let a CPU worker run the
+   tasks of the codelet that it makes ready (by completing their last
+   dependency, or by submitting them from a task), right after its current
+   task, instead of pushing them to the scheduler, when their
+   performance model predicts they are shorter than \ref
+   STARPU_INLINE_TASK_THRESHOLD and their input is already in the memory
+   node of the worker.
+   See \ref InlineSmallTasks for more details.
+*/
+#define STARPU_CODELET_INLINE (1 << 4)
+
 /**
    Value to be set in starpu_codelet::cuda_flags to allow asynchronous
    CUDA kernel execution.
@@ -1371,6 +1391,24 @@ struct starpu_task
 	*/
 
 	double flops;
+
+	/**
+	   Optional field. The application can set this to the date (in
+	   microseconds, as returned by starpu_timing_now()) by which the
+	   task should have completed, or leave it to 0 when the task has
+	   no deadline. To give a deadline to a whole DAG, e.g. the tasks
+	   serving a request, set the same deadline on all its tasks, and
+	   set \ref STARPU_CRITICAL_PATH so that the scheduler accounts for
+	   the successors of each task. Deadline-aware schedulers such as \b modular-deadline run these
+	   tasks first, and the tasks which complete after their deadline
+	   are counted by the \c starpu.task.g_deadline_missed performance
+	   counter.
+
+	   With starpu_task_insert() and alike this can be specified thanks to
+	   ::STARPU_TASK_DEADLINE followed by a double.
+	*/
+	double deadline;
+
 	/**
 	   Output field. Predicted duration of the task in microseconds. This field is
 	   only set if the scheduling strategy uses performance
@@ -1522,6 +1560,7 @@ struct starpu_task
 		.sched_ctx		      = STARPU_NMAX_SCHED_CTXS, \
 		.hypervisor_tag		      = 0,                      \
 		.flops			      = 0.0,                    \
+		.deadline		      = 0.0,                    \
 		.scheduled		      = 0,                      \
 		.prefetched		      = 0,                      \
 		.dyn_handles		      = NULL,                   \
@@ -2047,6 +2086,114 @@ void starpu_set_limit_max_submitted_tasks(int limit_min);
 
 /** @} */
 
+/**
+   @defgroup API_Task_Graph_Capture Task Graph Capture
+   @{
+*/
+
+/**
+   Opaque type of a task graph captured with
+   starpu_task_graph_capture_begin() and starpu_task_graph_capture_end().
+*/
+typedef struct _starpu_task_graph *starpu_task_graph_t;
+
+/**
+   Start capturing a task graph: until starpu_task_graph_capture_end()
+   is called, the tasks submitted by the calling thread are not
+   executed, but only recorded along their dependencies. Only one graph
+   can be captured at a time.
+
+   Tasks with tags, synchronous, regenerated or bundled tasks, and
+   data accessed in ::STARPU_REDUX mode or with asynchronous
+   partitioning are not supported.
+   See \ref TaskGraphCapture for more details.
+*/
+void starpu_task_graph_capture_begin(void);
+
+/**
+   Stop capturing, and return the captured task graph. The implicit
+   data dependencies between the captured tasks are turned into
+   explicit task dependencies, so that they do not need to be detected
+   again on each launch.
+   See \ref TaskGraphCapture for more details.
+*/
+starpu_task_graph_t starpu_task_graph_capture_end(void);
+
+/**
+   Submit all the tasks of \p graph, with the dependencies recorded at
+   capture time. If \p graph was already launched, wait for the
+   termination of the previous launch first. The implicit data
+   dependencies with tasks submitted outside the graph are not
+   enforced, the application has to call starpu_task_graph_wait()
+   before accessing the data from other tasks.
+   See \ref TaskGraphCapture for more details.
+*/
+int starpu_task_graph_launch(starpu_task_graph_t graph);
+
+/**
+   Wait for the termination of the last launch of \p graph.
+   See \ref TaskGraphCapture for more details.
+*/
+int starpu_task_graph_wait(starpu_task_graph_t graph);
+
+/**
+   Return the number of tasks of \p graph.
+*/
+unsigned starpu_task_graph_get_ntasks(starpu_task_graph_t graph);
+
+/**
+   Return the \p i -th task captured in \p graph, in submission order.
+   Its parameters (e.g. \ref starpu_task::cl_arg) can be modified
+   between launches, but not its data handles and access modes.
+*/
+struct starpu_task *starpu_task_graph_get_task(starpu_task_graph_t graph, unsigned i);
+
+/**
+   Wait for the termination of \p graph, and destroy it. The captured
+   tasks which were to be destroyed automatically are destroyed.
+   See \ref TaskGraphCapture for more details.
+*/
+void starpu_task_graph_destroy(starpu_task_graph_t graph);
+
+/** @} */
+
+/**
+   @defgroup API_Task_Yield Cooperative Task Yielding
+   @{
+*/
+
+/**
+   Give the worker back to StarPU from the CPU function of a codelet
+   with the ::STARPU_CODELET_YIELDABLE flag. The task is pushed to the
+   scheduler again, and the function returns when a CPU worker resumes
+   it. Parallel tasks cannot yield.
+   Return -EINVAL when not called from a yieldable codelet, and
+   -ENOSYS when StarPU was built without support for user-level
+   contexts (i.e. without OpenMP support).
+   See \ref CooperativeTaskYielding for more details.
+*/
+int starpu_task_yield(void);
+
+/**
+   Same as starpu_task_yield(), but the task is pushed to the scheduler
+   again only once the \p ndeps tasks of \p task_array have terminated.
+   These tasks have to be still valid, i.e. not destroyed yet.
+   See \ref CooperativeTaskYielding for more details.
+*/
+int starpu_task_yield_until(unsigned ndeps, struct starpu_task *task_array[]);
+
+/**
+   Same as starpu_task_yield(), but the task is pushed to the scheduler
+   again only once \p handle can be accessed in mode \p mode, i.e.
+   once the tasks submitted before which access \p handle in a
+   conflicting mode have terminated. \p handle must not be one of the
+   data of the calling task.
+   See \ref CooperativeTaskYielding for more details.
+*/
+int starpu_task_yield_until_data(starpu_data_handle_t handle, enum starpu_data_access_mode mode);
+
+/** @} */
+
 /**
    @defgroup API_Transactions Transactions
    @{
@@ -272,6 +272,11 @@ int _fstarpu_mpi_task_decode_v(struct starpu_codelet *codelet, int me, int nb_no
 			arg_i++;
 			/* double* */
 		}
+		else if (arg_type==STARPU_TASK_DEADLINE)
+		{
+			arg_i++;
+			/* double* */
+		}
 		else if (arg_type==STARPU_SCHED_CTX)
 		{
 			arg_i++;
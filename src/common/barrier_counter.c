@@ -15,6 +15,24 @@
  */
 
 #include <common/barrier_counter.h>
+#include <core/workers.h>
+
+/*
+ * The counters of submitted and ready tasks are updated by all workers on
+ * each task termination. To avoid having them all contend on the same mutex
+ * and cache line, sharded counters let each worker update its own shard
+ * without locking. Reading the counter then has to sum the shards, which is
+ * fine since this is much less frequent.
+ *
+ * Threads waiting for the counter register themselves in nwaiters before
+ * reading the counter. While somebody is waiting, workers do not update their
+ * shard but reached_start, with the mutex held, so that they can check in
+ * constant time whether the waiters have to be woken up, like without shards.
+ * Workers which had already started updating their shard check nwaiters after
+ * updating it, with a full barrier in between on both sides, so that either
+ * the worker sees the waiter and sums the shards again for it, or the waiter
+ * sees the update.
+ */
 
 int _starpu_barrier_counter_init(struct _starpu_barrier_counter *barrier_c, unsigned count)
 {
@@ -22,6 +40,25 @@ int _starpu_barrier_counter_init(struct _starpu_barrier_counter *barrier_c, unsi
 	barrier_c->min_threshold = 0;
 	barrier_c->max_threshold = 0;
 	STARPU_PTHREAD_COND_INIT(&barrier_c->cond2, NULL);
+	barrier_c->shards = NULL;
+	barrier_c->nshards = 0;
+	barrier_c->nwaiters = 0;
+	barrier_c->shards_count = 0;
+	/* Read by workers without the mutex, to know whether to wake waiters */
+	STARPU_HG_DISABLE_CHECKING(barrier_c->nwaiters);
+	return 0;
+}
+
+int _starpu_barrier_counter_init_sharded(struct _starpu_barrier_counter *barrier_c, unsigned count, unsigned nshards)
+{
+	_starpu_barrier_counter_init(barrier_c, count);
+	if (nshards)
+	{
+		_STARPU_CALLOC(barrier_c->shards, nshards, sizeof(*barrier_c->shards));
+		barrier_c->nshards = nshards;
+		/* Summed without synchronizing with the workers, see get_count */
+		VALGRIND_HG_DISABLE_CHECKING(barrier_c->shards, nshards * sizeof(*barrier_c->shards));
+	}
 	return 0;
 }
 
@@ -29,20 +66,158 @@ int _starpu_barrier_counter_destroy(struct _starpu_barrier_counter *barrier_c)
 {
 	_starpu_barrier_destroy(&barrier_c->barrier);
 	STARPU_PTHREAD_COND_DESTROY(&barrier_c->cond2);
+	free(barrier_c->shards);
+	barrier_c->shards = NULL;
+	barrier_c->nshards = 0;
 	return 0;
 }
 
+/* Return the shard of the calling thread, or NULL if it has to take the mutex */
+static struct _starpu_barrier_counter_shard *get_shard(struct _starpu_barrier_counter *barrier_c)
+{
+	struct _starpu_worker *worker;
+
+	if (!barrier_c->nshards)
+		return NULL;
+	worker = _starpu_get_local_worker_key();
+	if (!worker || (unsigned) worker->workerid >= barrier_c->nshards)
+		return NULL;
+	return &barrier_c->shards[worker->workerid];
+}
+
+/* Get the value of the counter, summing the shards again. Must be called with
+ * the mutex held */
+static unsigned get_count(struct _starpu_barrier_counter *barrier_c, double *flops)
+{
+	struct _starpu_barrier *barrier = &barrier_c->barrier;
+	unsigned long count, ops, prev_ops = 0;
+	double reached_flops;
+	unsigned i;
+	int first = 1;
+
+	while (1)
+	{
+		count = 0;
+		reached_flops = 0.;
+		ops = 0;
+		for (i = 0; i < barrier_c->nshards; i++)
+		{
+			struct _starpu_barrier_counter_shard *shard = &barrier_c->shards[i];
+			unsigned long nincr, ndecr;
+			nincr = shard->nincr;
+			ndecr = shard->ndecr;
+			/* Tasks may be counted in a shard and uncounted in
+			 * another one, the sum is what matters */
+			count += nincr - ndecr;
+			ops += nincr + ndecr;
+			reached_flops += shard->flops;
+		}
+		/* Since shards only increase, if no operation happened between
+		 * the two passes, this is a consistent snapshot */
+		if (!first && ops == prev_ops)
+			break;
+		first = 0;
+		prev_ops = ops;
+		STARPU_RMB();
+	}
+
+	barrier_c->shards_count = (unsigned) count;
+	/* Tasks may also be counted in a shard and uncounted in reached_start,
+	 * the sum modulo the size of unsigned is what matters */
+	if (flops)
+		*flops = barrier->reached_flops + reached_flops;
+	return barrier->reached_start + (unsigned) count;
+}
+
+/* Get the value of the counter with the shards summed the last time. Must be
+ * called with the mutex held */
+static unsigned get_cached_count(struct _starpu_barrier_counter *barrier_c)
+{
+	return barrier_c->barrier.reached_start + barrier_c->shards_count;
+}
+
+/* The counter was changed to count, wake up whoever was waiting for it. Must
+ * be called with the mutex held */
+static void counter_changed(struct _starpu_barrier_counter *barrier_c, unsigned count)
+{
+	struct _starpu_barrier *barrier = &barrier_c->barrier;
+
+	if (count == 0)
+		STARPU_PTHREAD_COND_BROADCAST(&barrier->cond);
+	else if (barrier_c->max_threshold && count <= barrier_c->max_threshold)
+	{
+		/* have those not happy enough tell us how much again */
+		barrier_c->max_threshold = 0;
+		STARPU_PTHREAD_COND_BROADCAST(&barrier->cond);
+	}
+}
+
+/* Update the counter from a worker: its shard when nobody is waiting, and
+ * reached_start otherwise */
+static void shard_update(struct _starpu_barrier_counter *barrier_c, struct _starpu_barrier_counter_shard *shard, int incr, double flops)
+{
+	struct _starpu_barrier *barrier = &barrier_c->barrier;
+
+	if (STARPU_LIKELY(!barrier_c->nwaiters))
+	{
+		shard->flops += flops;
+		if (incr)
+			shard->nincr++;
+		else
+			shard->ndecr++;
+		STARPU_SYNCHRONIZE();
+		if (STARPU_LIKELY(!barrier_c->nwaiters))
+			return;
+
+		/* Somebody started waiting meanwhile, and may have summed
+		 * the shards before our update, do it again for it */
+		STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
+		counter_changed(barrier_c, get_count(barrier_c, NULL));
+		if (incr)
+			STARPU_PTHREAD_COND_BROADCAST(&barrier_c->cond2);
+		STARPU_PTHREAD_MUTEX_UNLOCK(&barrier->mutex);
+		return;
+	}
+
+	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
+	barrier->reached_flops += flops;
+	if (incr)
+	{
+		barrier->reached_start++;
+		STARPU_PTHREAD_COND_BROADCAST(&barrier_c->cond2);
+	}
+	else
+	{
+		barrier->reached_start--;
+		counter_changed(barrier_c, get_cached_count(barrier_c));
+	}
+	STARPU_PTHREAD_MUTEX_UNLOCK(&barrier->mutex);
+}
+
+/* Register as a waiter, must be called with the mutex held */
+static void add_waiter(struct _starpu_barrier_counter *barrier_c)
+{
+	barrier_c->nwaiters++;
+	/* Make sure workers see us before we look at their shards */
+	STARPU_SYNCHRONIZE();
+}
 
 int _starpu_barrier_counter_wait_for_empty_counter(struct _starpu_barrier_counter *barrier_c)
 {
 	struct _starpu_barrier *barrier = &barrier_c->barrier;
+	unsigned count;
 	int ret;
 	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
+	add_waiter(barrier_c);
 
-	ret = barrier->reached_start;
-	while (barrier->reached_start > 0)
+	ret = count = get_count(barrier_c, NULL);
+	while (count > 0)
+	{
 		STARPU_PTHREAD_COND_WAIT(&barrier->cond, &barrier->mutex);
+		count = get_count(barrier_c, NULL);
+	}
 
+	barrier_c->nwaiters--;
 	STARPU_PTHREAD_MUTEX_UNLOCK(&barrier->mutex);
 	return ret;
 }
@@ -51,14 +226,16 @@ int _starpu_barrier_counter_wait_until_counter_reaches_down_to_n(struct _starpu_
 {
 	struct _starpu_barrier *barrier = &barrier_c->barrier;
 	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
+	add_waiter(barrier_c);
 
-	while (barrier->reached_start > n)
+	while (get_count(barrier_c, NULL) > n)
 	{
 		if (barrier_c->max_threshold < n)
 			barrier_c->max_threshold = n;
 		STARPU_PTHREAD_COND_WAIT(&barrier->cond, &barrier->mutex);
 	}
 
+	barrier_c->nwaiters--;
 	STARPU_PTHREAD_MUTEX_UNLOCK(&barrier->mutex);
 	return 0;
 }
@@ -67,14 +244,16 @@ int _starpu_barrier_counter_wait_until_counter_reaches_up_to_n(struct _starpu_ba
 {
 	struct _starpu_barrier *barrier = &barrier_c->barrier;
 	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
+	add_waiter(barrier_c);
 
-	while (barrier->reached_start < n)
+	while (get_count(barrier_c, NULL) < n)
 	{
 		if (barrier_c->min_threshold > n)
 			barrier_c->min_threshold = n;
 		STARPU_PTHREAD_COND_WAIT(&barrier_c->cond2, &barrier->mutex);
 	}
 
+	barrier_c->nwaiters--;
 	STARPU_PTHREAD_MUTEX_UNLOCK(&barrier->mutex);
 	return 0;
 }
@@ -83,33 +262,37 @@ int _starpu_barrier_counter_wait_for_full_counter(struct _starpu_barrier_counter
 {
 	struct _starpu_barrier *barrier = &barrier_c->barrier;
 	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
+	add_waiter(barrier_c);
 
-	while (barrier->reached_start < barrier->count)
+	while (get_count(barrier_c, NULL) < barrier->count)
 		STARPU_PTHREAD_COND_WAIT(&barrier_c->cond2, &barrier->mutex);
 
+	barrier_c->nwaiters--;
 	STARPU_PTHREAD_MUTEX_UNLOCK(&barrier->mutex);
 	return 0;
 }
 
+/* Return 1 if the counter reached 0. Workers with a shard always get 0, the
+ * counter is only checked there when somebody is waiting for it. */
 int _starpu_barrier_counter_decrement_until_empty_counter(struct _starpu_barrier_counter *barrier_c, double flops)
 {
 	struct _starpu_barrier *barrier = &barrier_c->barrier;
-	int ret = 0;
-	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
+	struct _starpu_barrier_counter_shard *shard = get_shard(barrier_c);
+	unsigned count;
+	int ret;
 
-	barrier->reached_flops -= flops;
-	if (--barrier->reached_start == 0)
+	if (shard)
 	{
-		ret = 1;
-		STARPU_PTHREAD_COND_BROADCAST(&barrier->cond);
-	}
-	if (barrier_c->max_threshold && barrier->reached_start == barrier_c->max_threshold)
-	{
-		/* have those not happy enough tell us how much again */
-		barrier_c->max_threshold = 0;
-		STARPU_PTHREAD_COND_BROADCAST(&barrier->cond);
+		shard_update(barrier_c, shard, 0, -flops);
+		return 0;
 	}
 
+	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
+	barrier->reached_flops -= flops;
+	barrier->reached_start--;
+	count = barrier_c->nwaiters ? get_cached_count(barrier_c) : get_count(barrier_c, NULL);
+	counter_changed(barrier_c, count);
+	ret = count == 0;
 	STARPU_PTHREAD_MUTEX_UNLOCK(&barrier->mutex);
 	return ret;
 }
@@ -117,21 +300,13 @@ int _starpu_barrier_counter_decrement_until_empty_counter(struct _starpu_barrier
 int _starpu_barrier_counter_increment_until_full_counter(struct _starpu_barrier_counter *barrier_c, double flops)
 {
 	struct _starpu_barrier *barrier = &barrier_c->barrier;
-	int ret = 0;
+	int ret;
 	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
 
 	barrier->reached_flops += flops;
-	if(++barrier->reached_start == barrier->count)
-	{
-		ret = 1;
-		STARPU_PTHREAD_COND_BROADCAST(&barrier_c->cond2);
-	}
-	if (barrier_c->min_threshold && barrier->reached_start == barrier_c->min_threshold)
-	{
-		/* have those not happy enough tell us how much again */
-		barrier_c->min_threshold = 0;
-		STARPU_PTHREAD_COND_BROADCAST(&barrier_c->cond2);
-	}
+	barrier->reached_start++;
+	ret = get_count(barrier_c, NULL) == barrier->count;
+	STARPU_PTHREAD_COND_BROADCAST(&barrier_c->cond2);
 
 	STARPU_PTHREAD_MUTEX_UNLOCK(&barrier->mutex);
 	return ret;
@@ -140,8 +315,15 @@ int _starpu_barrier_counter_increment_until_full_counter(struct _starpu_barrier_
 int _starpu_barrier_counter_increment(struct _starpu_barrier_counter *barrier_c, double flops)
 {
 	struct _starpu_barrier *barrier = &barrier_c->barrier;
-	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
+	struct _starpu_barrier_counter_shard *shard = get_shard(barrier_c);
 
+	if (shard)
+	{
+		shard_update(barrier_c, shard, 1, flops);
+		return 0;
+	}
+
+	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
 	barrier->reached_start++;
 	barrier->reached_flops += flops;
 	STARPU_PTHREAD_COND_BROADCAST(&barrier_c->cond2);
@@ -154,7 +336,7 @@ int _starpu_barrier_counter_check(struct _starpu_barrier_counter *barrier_c)
 	struct _starpu_barrier *barrier = &barrier_c->barrier;
 	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
 
-	if(barrier->reached_start == 0)
+	if (get_count(barrier_c, NULL) == 0)
 		STARPU_PTHREAD_COND_BROADCAST(&barrier->cond);
 
 	STARPU_PTHREAD_MUTEX_UNLOCK(&barrier->mutex);
@@ -166,7 +348,7 @@ int _starpu_barrier_counter_get_reached_start(struct _starpu_barrier_counter *ba
 	struct _starpu_barrier *barrier = &barrier_c->barrier;
 	int ret;
 	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
-	ret = barrier->reached_start;
+	ret = get_count(barrier_c, NULL);
 	STARPU_PTHREAD_MUTEX_UNLOCK(&barrier->mutex);
 	return ret;
 }
@@ -186,7 +368,7 @@ double _starpu_barrier_counter_get_reached_flops(struct _starpu_barrier_counter
 	struct _starpu_barrier *barrier = &barrier_c->barrier;
 	double ret;
 	STARPU_PTHREAD_MUTEX_LOCK(&barrier->mutex);
-	ret = barrier->reached_flops;
+	get_count(barrier_c, &ret);
 	STARPU_PTHREAD_MUTEX_UNLOCK(&barrier->mutex);
 	return ret;
 }
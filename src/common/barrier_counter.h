@@ -25,16 +25,47 @@
 
 #pragma GCC visibility push(hidden)
 
+/** Part of a sharded counter updated by a given worker */
+struct _starpu_barrier_counter_shard
+{
+	/** These only ever increase, so that readers can check that they got a
+	 * consistent view of all shards */
+	unsigned long nincr;
+	unsigned long ndecr;
+	double flops;
+	/** Only the worker writes to its shard, keep them in separate cache
+	 * lines */
+	char padding[STARPU_CACHELINE_SIZE];
+};
+
 struct _starpu_barrier_counter
 {
 	struct _starpu_barrier barrier;
 	unsigned min_threshold;
 	unsigned max_threshold;
 	starpu_pthread_cond_t cond2;
+	/** When not NULL, workers update their own shard without taking the
+	 * mutex, and the value of the counter is the sum of barrier.reached_start
+	 * (updated by other threads) and of the shards. */
+	struct _starpu_barrier_counter_shard *shards;
+	unsigned nshards;
+	/** Number of threads waiting for the counter to reach some value.
+	 * Workers then update barrier.reached_start with the mutex held
+	 * instead of their shard, so that whether the target of the waiters
+	 * is reached can be checked without summing the shards */
+	unsigned nwaiters;
+	/** Sum of the shards, as of the last time they were summed. Shards
+	 * only change when nobody is waiting, or just before a worker notices
+	 * a new waiter and sums them again */
+	unsigned shards_count;
 };
 
 int _starpu_barrier_counter_init(struct _starpu_barrier_counter *barrier_c, unsigned count);
 
+/** Initialize a counter which is updated by the workers without contending
+ * on a single lock, with one shard per worker. */
+int _starpu_barrier_counter_init_sharded(struct _starpu_barrier_counter *barrier_c, unsigned count, unsigned nshards);
+
 int _starpu_barrier_counter_destroy(struct _starpu_barrier_counter *barrier_c);
 
 int _starpu_barrier_counter_wait_for_empty_counter(struct _starpu_barrier_counter *barrier_c);
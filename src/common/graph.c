@@ -23,12 +23,27 @@
  * This is because we drop nodes lazily: when a job terminates, we just add the
  * node to the dropped list (to avoid having to take the mutex on the whole
  * graph).  The graph gets updated whenever the graph mutex becomes available.
+ *
+ * When STARPU_CRITICAL_PATH is set, we additionally maintain online the top
+ * level and bottom level of each node, i.e. the expected length of the longest
+ * path from the top of the graph to the node, and from the node to the bottom
+ * of the graph, based on the performance models.  Since nodes only get added
+ * at the bottom of the graph, these values can only increase, so we just
+ * propagate increases from the modified nodes.
+ *
+ * When a lookahead scheduler enables it, we also maintain the optimistic cost
+ * table of each node (as in PEFT), i.e. for each class of workers the expected
+ * length of the rest of the graph if the node runs on that class. It can only
+ * increase as well, so it is propagated the same way, but only over a bounded
+ * number of nodes (STARPU_SCHED_LOOKAHEAD_WINDOW) to keep submission cheap.
  */
 
+#include <math.h>
 #include <starpu.h>
 #include <core/jobs.h>
 #include <common/graph.h>
 #include <core/workers.h>
+#include <datawizard/coherency.h>
 
 /* Protects the whole task graph except the dropped list */
 static starpu_pthread_rwlock_t graph_lock;
@@ -48,6 +63,34 @@ static starpu_pthread_mutex_t dropped_lock;
 /* This list contains all dropped nodes, i.e. the job terminated by the corresponding node is still int he graph */
 static struct _starpu_graph_node_multilist_dropped dropped;
 
+/* Whether we should maintain the critical path information */
+int _starpu_graph_critical_path;
+/* Whether we should display critical path statistics on shutdown */
+static int critical_path_stats;
+
+/* The following are protected by graph_lock */
+/* Expected length of the critical path of the whole graph */
+static double critical_path;
+/* Measured length of the critical path of the whole graph */
+static double achieved_critical_path;
+/* Whether all terminated jobs had a measured length */
+static int achieved_critical_path_measured;
+/* Number of jobs submitted */
+static unsigned long critical_path_njobs;
+/* Date of the first submission and of the last termination */
+static double critical_path_start, critical_path_end;
+
+/* Number of scheduling contexts which need the lookahead information */
+int _starpu_graph_lookahead;
+/* Workers are grouped by classes of the same performance model architecture
+ * and memory node */
+static unsigned lookahead_nclasses;
+static unsigned lookahead_class_worker[STARPU_NMAXWORKERS];
+static unsigned lookahead_class_node[STARPU_NMAXWORKERS];
+static unsigned lookahead_worker_class[STARPU_NMAXWORKERS];
+/* Maximum number of nodes visited when propagating the optimistic cost table */
+static unsigned lookahead_window;
+
 void _starpu_graph_init(void)
 {
 	STARPU_PTHREAD_RWLOCK_INIT(&graph_lock, NULL);
@@ -56,6 +99,17 @@ void _starpu_graph_init(void)
 	_starpu_graph_node_multilist_head_init_all(&all);
 	STARPU_PTHREAD_MUTEX_INIT(&dropped_lock, NULL);
 	_starpu_graph_node_multilist_head_init_dropped(&dropped);
+
+	critical_path_stats = starpu_getenv_number_default("STARPU_CRITICAL_PATH_STATS", 0);
+	_starpu_graph_critical_path = critical_path_stats || starpu_getenv_number_default("STARPU_CRITICAL_PATH", 0);
+	if (_starpu_graph_critical_path)
+		_starpu_graph_record = 1;
+	critical_path = 0.;
+	achieved_critical_path = 0.;
+	achieved_critical_path_measured = 1;
+	critical_path_njobs = 0;
+	critical_path_start = -1.;
+	critical_path_end = -1.;
 }
 
 /* LockWR the graph lock */
@@ -171,6 +225,182 @@ static unsigned add_node(struct _starpu_graph_node *node, struct _starpu_graph_n
 	return ret;
 }
 
+/* Record the longest path going through node. Graph lock has to be held */
+static void update_critical_path(struct _starpu_graph_node *node)
+{
+	double path = node->top_level + node->bottom_level;
+	if (path > critical_path)
+		critical_path = path;
+}
+
+/* Recompute the bottom level of node from its successors, and propagate any
+ * increase to its predecessors. Graph lock has to be held */
+static void propagate_bottom_level(struct _starpu_graph_node *node)
+{
+	struct _starpu_graph_node **set = NULL;
+	unsigned n = 0, alloc = 0, i;
+
+	add_node(node, &set, &n, &alloc, NULL);
+	while (n)
+	{
+		double bottom_level = 0.;
+
+		node = set[--n];
+		for (i = 0; i < node->n_outgoing; i++)
+		{
+			struct _starpu_graph_node *next = node->outgoing[i];
+			if (next && next->bottom_level > bottom_level)
+				bottom_level = next->bottom_level;
+		}
+		bottom_level += node->length;
+		if (bottom_level <= node->bottom_level)
+			/* No change, no need to go further */
+			continue;
+
+		node->bottom_level = bottom_level;
+		update_critical_path(node);
+		for (i = 0; i < node->n_incoming; i++)
+		{
+			struct _starpu_graph_node *prev = node->incoming[i];
+			if (prev)
+				add_node(prev, &set, &n, &alloc, NULL);
+		}
+	}
+	free(set);
+}
+
+/* Recompute the top level of node from its predecessors, and propagate any
+ * increase to its successors. Graph lock has to be held */
+static void propagate_top_level(struct _starpu_graph_node *node)
+{
+	struct _starpu_graph_node **set = NULL;
+	unsigned n = 0, alloc = 0, i;
+
+	add_node(node, &set, &n, &alloc, NULL);
+	while (n)
+	{
+		double top_level = 0.;
+
+		node = set[--n];
+		for (i = 0; i < node->n_incoming; i++)
+		{
+			struct _starpu_graph_node *prev = node->incoming[i];
+			if (prev && prev->top_level + prev->length > top_level)
+				top_level = prev->top_level + prev->length;
+		}
+		if (top_level <= node->top_level)
+			/* No change, no need to go further */
+			continue;
+
+		node->top_level = top_level;
+		update_critical_path(node);
+		for (i = 0; i < node->n_outgoing; i++)
+		{
+			struct _starpu_graph_node *next = node->outgoing[i];
+			if (next)
+				add_node(next, &set, &n, &alloc, NULL);
+		}
+	}
+	free(set);
+}
+
+/* Recompute the optimistic cost table of node from its successors, and
+ * propagate any increase to its predecessors. Graph lock has to be held */
+static void propagate_oct(struct _starpu_graph_node *node)
+{
+	struct _starpu_graph_node **set = NULL;
+	unsigned n = 0, alloc = 0, visited = 0, i;
+	unsigned class, next_class;
+
+	add_node(node, &set, &n, &alloc, NULL);
+	while (n && visited++ < lookahead_window)
+	{
+		int changed = 0;
+
+		node = set[--n];
+		if (!node->oct)
+			/* Not submitted yet */
+			continue;
+
+		for (class = 0; class < lookahead_nclasses; class++)
+		{
+			double oct = 0.;
+			for (i = 0; i < node->n_outgoing; i++)
+			{
+				struct _starpu_graph_node *next = node->outgoing[i];
+				double best = INFINITY;
+				if (!next || !next->oct)
+					continue;
+				for (next_class = 0; next_class < lookahead_nclasses; next_class++)
+				{
+					double cost = next->oct[next_class] + next->class_length[next_class];
+					if (lookahead_class_node[next_class] != lookahead_class_node[class])
+						cost += starpu_transfer_predict(lookahead_class_node[class], lookahead_class_node[next_class], next->data_size);
+					if (cost < best)
+						best = cost;
+				}
+				if (!isinf(best) && best > oct)
+					oct = best;
+			}
+			if (oct > node->oct[class])
+			{
+				node->oct[class] = oct;
+				changed = 1;
+			}
+		}
+		if (!changed)
+			/* No change, no need to go further */
+			continue;
+
+		for (i = 0; i < node->n_incoming; i++)
+		{
+			struct _starpu_graph_node *prev = node->incoming[i];
+			if (prev)
+				add_node(prev, &set, &n, &alloc, NULL);
+		}
+	}
+	free(set);
+}
+
+/* Compute the expected length of task on each worker class, followed by room
+ * for the optimistic cost table */
+static double *compute_class_lengths(struct starpu_task *task, size_t *data_size)
+{
+	unsigned nbuffers;
+	unsigned class, nimpl, i;
+	double *class_length;
+
+	_STARPU_CALLOC(class_length, 2 * lookahead_nclasses, sizeof(*class_length));
+	*data_size = 0;
+
+	if (!task->cl)
+		return class_length;
+	nbuffers = STARPU_TASK_GET_NBUFFERS(task);
+
+	for (class = 0; class < lookahead_nclasses; class++)
+	{
+		unsigned workerid = lookahead_class_worker[class];
+		double length = INFINITY;
+		for (nimpl = 0; nimpl < STARPU_MAXIMPLEMENTATIONS; nimpl++)
+		{
+			double d;
+			if (!starpu_worker_can_execute_task(workerid, task, nimpl))
+				continue;
+			d = starpu_task_worker_expected_length(task, workerid, task->sched_ctx, nimpl);
+			/* Uncalibrated models do not contribute */
+			if (isnan(d))
+				d = 0.;
+			if (d < length)
+				length = d;
+		}
+		class_length[class] = length;
+	}
+
+	for (i = 0; i < nbuffers; i++)
+		*data_size += _starpu_data_get_size(STARPU_TASK_GET_HANDLE(task, i));
+	return class_length;
+}
+
 /* Add a dependency between nodes */
 void _starpu_graph_add_job_dep(struct _starpu_job *job, struct _starpu_job *prev_job)
 {
@@ -199,6 +429,82 @@ void _starpu_graph_add_job_dep(struct _starpu_job *job, struct _starpu_job *prev
 	prev_node->outgoing_slot[rank_outgoing] = rank_incoming;
 	node->incoming_slot[rank_incoming] = rank_outgoing;
 
+	if (_starpu_graph_critical_path)
+	{
+		propagate_bottom_level(prev_node);
+		propagate_top_level(node);
+	}
+	if (_starpu_graph_lookahead)
+		propagate_oct(prev_node);
+
+	_starpu_graph_wrunlock();
+}
+
+/* Submission of a job, we can now compute its expected length */
+void _starpu_graph_submit_job(struct _starpu_job *job)
+{
+	struct starpu_task *task = job->task;
+	double length = 0.;
+	double *class_length = NULL;
+	size_t data_size = 0;
+	unsigned i;
+
+	if (!job->graph_node)
+		return;
+
+	if (task->cl && _starpu_graph_critical_path)
+	{
+		length = starpu_task_expected_length_average(task, task->sched_ctx);
+		/* Uncalibrated models do not contribute to the critical path */
+		if (isnan(length) || isinf(length))
+			length = 0.;
+	}
+
+	if (_starpu_graph_lookahead)
+		class_length = compute_class_lengths(task, &data_size);
+
+	_starpu_graph_wrlock();
+	struct _starpu_graph_node *node = job->graph_node;
+	if (!node)
+	{
+		/* Already gone */
+		_starpu_graph_wrunlock();
+		free(class_length);
+		return;
+	}
+
+	if (_starpu_graph_critical_path)
+	{
+		if (critical_path_start < 0.)
+			critical_path_start = starpu_timing_now();
+		critical_path_njobs++;
+
+		node->length = length;
+		propagate_bottom_level(node);
+		for (i = 0; i < node->n_outgoing; i++)
+		{
+			struct _starpu_graph_node *next = node->outgoing[i];
+			if (next)
+				propagate_top_level(next);
+		}
+	}
+
+	if (class_length && !node->class_length)
+	{
+		node->class_length = class_length;
+		node->oct = class_length + lookahead_nclasses;
+		node->data_size = data_size;
+		/* Our predecessors can now take us into account */
+		for (i = 0; i < node->n_incoming; i++)
+		{
+			struct _starpu_graph_node *prev = node->incoming[i];
+			if (prev)
+				propagate_oct(prev);
+		}
+	}
+	else
+		free(class_length);
+
 	_starpu_graph_wrunlock();
 }
 
@@ -208,6 +514,21 @@ void _starpu_graph_drop_node(struct _starpu_graph_node *node)
 	unsigned i;
 	STARPU_ASSERT(!node->job);
 
+	if (_starpu_graph_critical_path)
+	{
+		/* Propagate the measured path to our successors */
+		double achieved_end = node->achieved_top_level + node->achieved_length;
+		if (achieved_end > achieved_critical_path)
+			achieved_critical_path = achieved_end;
+		for (i = 0; i < node->n_outgoing; i++)
+		{
+			struct _starpu_graph_node *next = node->outgoing[i];
+			if (next && next->achieved_top_level < achieved_end)
+				next->achieved_top_level = achieved_end;
+		}
+		critical_path_end = starpu_timing_now();
+	}
+
 	if (_starpu_graph_node_multilist_queued_bottom(node))
 		_starpu_graph_node_multilist_erase_bottom(&bottom, node);
 	if (_starpu_graph_node_multilist_queued_top(node))
@@ -244,6 +565,7 @@ void _starpu_graph_drop_node(struct _starpu_graph_node *node)
 	free(node->incoming_slot);
 	node->incoming_slot = NULL;
 	node->alloc_incoming = 0;
+	free(node->class_length);
 	free(node);
 }
 
@@ -258,6 +580,19 @@ void _starpu_graph_drop_job(struct _starpu_job *job)
 	starpu_worker_relax_on();
 	STARPU_PTHREAD_MUTEX_LOCK(&node->mutex);
 	starpu_worker_relax_off();
+	if (_starpu_graph_critical_path)
+	{
+		struct starpu_profiling_task_info *info = job->task->profiling_info;
+		if (info && starpu_profiling_status_get())
+			node->achieved_length = starpu_timing_timespec_delay_us(&info->start_time, &info->end_time);
+		else
+		{
+			/* No measurement, use the expected length */
+			node->achieved_length = node->length;
+			if (job->task->cl && node->length)
+				achieved_critical_path_measured = 0;
+		}
+	}
 	/* Will not be able to use the job any more */
 	node->job = NULL;
 	STARPU_PTHREAD_MUTEX_UNLOCK(&node->mutex);
@@ -491,3 +826,204 @@ void _starpu_graph_node_outgoing(struct _starpu_graph_node *node, unsigned *n_ou
 
 	_starpu_graph_rdunlock();
 }
+
+/* Return the node of the task, with the graph lock held in read mode, or NULL
+ * (and the lock released) if it is not in the graph any more. */
+static struct _starpu_graph_node *critical_path_task_node(struct starpu_task *task)
+{
+	struct _starpu_job *job;
+	struct _starpu_graph_node *node;
+
+	if (!_starpu_graph_critical_path)
+		return NULL;
+
+	job = _starpu_get_job_associated_to_task(task);
+	_starpu_graph_rdlock();
+	node = job->graph_node;
+	if (!node)
+		_starpu_graph_rdunlock();
+	return node;
+}
+
+double starpu_task_bottom_level(struct starpu_task *task)
+{
+	double bottom_level;
+	struct _starpu_graph_node *node = critical_path_task_node(task);
+	if (!node)
+		return 0.;
+	bottom_level = node->bottom_level;
+	_starpu_graph_rdunlock();
+	return bottom_level;
+}
+
+double starpu_task_slack(struct starpu_task *task)
+{
+	double slack;
+	struct _starpu_graph_node *node = critical_path_task_node(task);
+	if (!node)
+		return 0.;
+	slack = critical_path - (node->top_level + node->bottom_level);
+	_starpu_graph_rdunlock();
+	return slack;
+}
+
+int starpu_task_critical_path_priority(struct starpu_task *task, unsigned sched_ctx_id)
+{
+	int min_prio = starpu_sched_ctx_get_min_priority(sched_ctx_id);
+	int max_prio = starpu_sched_ctx_get_max_priority(sched_ctx_id);
+	double ratio;
+	struct _starpu_graph_node *node = critical_path_task_node(task);
+	if (!node)
+		return min_prio;
+	ratio = critical_path > 0. ? node->bottom_level / critical_path : 0.;
+	_starpu_graph_rdunlock();
+	return min_prio + (int) lround(ratio * (max_prio - min_prio));
+}
+
+double starpu_critical_path_length(void)
+{
+	double length;
+	_starpu_graph_rdlock();
+	length = critical_path;
+	_starpu_graph_rdunlock();
+	return length;
+}
+
+void _starpu_graph_critical_path_display_stats(void)
+{
+	FILE *stream = stderr;
+	double achieved_time;
+
+	if (!critical_path_stats)
+		return;
+
+	/* Make sure all terminated jobs have been accounted */
+	_starpu_graph_wrlock();
+	_starpu_graph_wrunlock();
+
+	_starpu_graph_rdlock();
+	achieved_time = critical_path_end >= critical_path_start ? critical_path_end - critical_path_start : 0.;
+
+	fprintf(stream, "\n#---------------------\n");
+	fprintf(stream, "Critical path stats:\n");
+	fprintf(stream, "\t%lu task(s)\n", critical_path_njobs);
+	fprintf(stream, "\tachieved time: %.2lf ms\n", achieved_time / 1000.);
+	fprintf(stream, "\texpected critical path: %.2lf ms", critical_path / 1000.);
+	if (achieved_time > 0.)
+		fprintf(stream, " (%.2lf%% of achieved time)", critical_path * 100. / achieved_time);
+	fprintf(stream, "\n");
+	if (achieved_critical_path_measured)
+	{
+		fprintf(stream, "\tmeasured critical path: %.2lf ms", achieved_critical_path / 1000.);
+		if (achieved_time > 0.)
+			fprintf(stream, " (%.2lf%% of achieved time)", achieved_critical_path * 100. / achieved_time);
+		fprintf(stream, "\n");
+	}
+	else
+		fprintf(stream, "\tmeasured critical path: not available, set STARPU_PROFILING to 1\n");
+	fprintf(stream, "#---------------------\n");
+	_starpu_graph_rdunlock();
+}
+
+void _starpu_graph_lookahead_enable(void)
+{
+	_starpu_graph_wrlock();
+	if (_starpu_graph_lookahead++ == 0)
+	{
+		unsigned workerid, class;
+
+		lookahead_window = starpu_getenv_number_default("STARPU_SCHED_LOOKAHEAD_WINDOW", 10000);
+		lookahead_nclasses = 0;
+		for (workerid = 0; workerid < starpu_worker_get_count(); workerid++)
+		{
+			struct starpu_perfmodel_arch *arch = starpu_worker_get_perf_archtype(workerid, STARPU_NMAX_SCHED_CTXS);
+			int comb = starpu_perfmodel_arch_comb_get(arch->ndevices, arch->devices);
+			unsigned node = starpu_worker_get_memory_node(workerid);
+
+			for (class = 0; class < lookahead_nclasses; class++)
+			{
+				struct starpu_perfmodel_arch *class_arch = starpu_worker_get_perf_archtype(lookahead_class_worker[class], STARPU_NMAX_SCHED_CTXS);
+				if (lookahead_class_node[class] == node
+				    && starpu_perfmodel_arch_comb_get(class_arch->ndevices, class_arch->devices) == comb)
+					break;
+			}
+			if (class == lookahead_nclasses)
+			{
+				lookahead_class_worker[class] = workerid;
+				lookahead_class_node[class] = node;
+				lookahead_nclasses++;
+			}
+			lookahead_worker_class[workerid] = class;
+		}
+	}
+	_starpu_graph_wrunlock();
+	_starpu_graph_record = 1;
+}
+
+void _starpu_graph_lookahead_disable(void)
+{
+	_starpu_graph_wrlock();
+	STARPU_ASSERT(_starpu_graph_lookahead > 0);
+	_starpu_graph_lookahead--;
+	_starpu_graph_wrunlock();
+	_starpu_graph_record_disable();
+}
+
+void _starpu_graph_record_disable(void)
+{
+	_starpu_graph_record = _starpu_graph_critical_path || _starpu_graph_lookahead;
+}
+
+unsigned _starpu_graph_lookahead_nclasses(void)
+{
+	return lookahead_nclasses;
+}
+
+unsigned _starpu_graph_lookahead_worker_class(unsigned workerid)
+{
+	STARPU_ASSERT(workerid < starpu_worker_get_count());
+	return lookahead_worker_class[workerid];
+}
+
+int _starpu_graph_task_remaining_path(struct starpu_task *task, double *remaining)
+{
+	struct _starpu_job *job = _starpu_get_job_associated_to_task(task);
+	struct _starpu_graph_node *node;
+
+	if (!_starpu_graph_critical_path)
+		return 0;
+
+	_starpu_graph_rdlock();
+	node = job->graph_node;
+	if (!node)
+	{
+		_starpu_graph_rdunlock();
+		return 0;
+	}
+	*remaining = node->bottom_level - node->length;
+	_starpu_graph_rdunlock();
+	return 1;
+}
+
+int _starpu_graph_lookahead_task_costs(struct starpu_task *task, double *length, double *oct)
+{
+	struct _starpu_job *job = _starpu_get_job_associated_to_task(task);
+	struct _starpu_graph_node *node;
+
+	if (!_starpu_graph_lookahead)
+		return 0;
+
+	_starpu_graph_rdlock();
+	node = job->graph_node;
+	if (!node || !node->class_length)
+	{
+		_starpu_graph_rdunlock();
+		return 0;
+	}
+	if (length)
+		memcpy(length, node->class_length, lookahead_nclasses * sizeof(*length));
+	if (oct)
+		memcpy(oct, node->oct, lookahead_nclasses * sizeof(*oct));
+	_starpu_graph_rdunlock();
+	return 1;
+}
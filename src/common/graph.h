@@ -83,6 +83,39 @@ struct _starpu_graph_node
 	 */
 	unsigned descendants;
 
+	/**
+	 * Fields for online critical path analysis
+	 * Only available if _starpu_graph_critical_path is set
+	 */
+	/** Expected length of the job according to performance models, in µs */
+	double length;
+	/** Expected length of the longest path from the top of the graph to
+	 * the start of the job */
+	double top_level;
+	/** Expected length of the longest path from the start of the job to
+	 * the bottom of the graph, including the job itself */
+	double bottom_level;
+	/** Measured length of the job, set on termination */
+	double achieved_length;
+	/** Measured length of the longest path from the top of the graph to
+	 * the start of the job, propagated when predecessors terminate */
+	double achieved_top_level;
+
+	/**
+	 * Fields for lookahead scheduling
+	 * Only available if _starpu_graph_lookahead is set
+	 */
+	/** Expected length of the job on each worker class, in µs, INFINITY
+	 * if the class can not execute it */
+	double *class_length;
+	/** Optimistic cost table: for each worker class, expected length of
+	 * the longest path from the end of the job to the bottom of the graph,
+	 * if the job runs on that class and each successor runs on its best
+	 * class, including data transfers between classes */
+	double *oct;
+	/** Size of the data accessed by the job */
+	size_t data_size;
+
 	/** Variable available for graph flow */
 	int graph_n;
 };
@@ -93,6 +126,11 @@ MULTILIST_CREATE_INLINES(struct _starpu_graph_node, _starpu_graph_node, bottom)
 MULTILIST_CREATE_INLINES(struct _starpu_graph_node, _starpu_graph_node, dropped)
 
 extern int _starpu_graph_record;
+/** Whether we maintain the critical path information online */
+extern int _starpu_graph_critical_path;
+/** Whether we maintain the lookahead information online, this counts the
+ * scheduling contexts which use it */
+extern int _starpu_graph_lookahead;
 void _starpu_graph_init(void);
 void _starpu_graph_wrlock(void);
 void _starpu_graph_rdlock(void);
@@ -105,6 +143,10 @@ void _starpu_graph_add_job(struct _starpu_job *job);
 /** Add a dependency between jobs */
 void _starpu_graph_add_job_dep(struct _starpu_job *job, struct _starpu_job *prev_job);
 
+/** Compute the expected length of a job being submitted, and update the
+ * critical path information accordingly */
+void _starpu_graph_submit_job(struct _starpu_job *job);
+
 /** Remove a job from the graph */
 void _starpu_graph_drop_job(struct _starpu_job *job);
 
@@ -152,6 +194,33 @@ struct starpu_task *_starpu_graph_node_task(struct _starpu_graph_node *node);
 
 void _starpu_graph_node_outgoing(struct _starpu_graph_node *node, unsigned *n_outgoing, struct _starpu_graph_node ***outgoing);
 
+/** Set \p remaining to the expected length of the longest path from the end
+ * of \p task to the bottom of the graph. Return 0 if the critical path
+ * information is not available */
+int _starpu_graph_task_remaining_path(struct starpu_task *task, double *remaining);
+
+/** Display the critical path statistics if STARPU_CRITICAL_PATH_STATS is set */
+void _starpu_graph_critical_path_display_stats(void);
+
+/** Start maintaining the optimistic cost table of the submitted jobs, for
+ * lookahead scheduling. Worker classes are determined from the current
+ * workers on the first call. */
+void _starpu_graph_lookahead_enable(void);
+/** Stop maintaining the optimistic cost table, once as many calls as
+ * _starpu_graph_lookahead_enable have been made */
+void _starpu_graph_lookahead_disable(void);
+/** Stop recording the graph, unless it is still needed for the critical path
+ * or the lookahead information */
+void _starpu_graph_record_disable(void);
+/** Number of worker classes used by the lookahead information */
+unsigned _starpu_graph_lookahead_nclasses(void) STARPU_ATTRIBUTE_VISIBILITY_DEFAULT;
+/** Worker class of the worker \p workerid */
+unsigned _starpu_graph_lookahead_worker_class(unsigned workerid);
+/** Fill \p length and \p oct (if not NULL) with the expected length and the
+ * optimistic cost table of \p task for each worker class. Return 0 if they
+ * are not available */
+int _starpu_graph_lookahead_task_costs(struct starpu_task *task, double *length, double *oct) STARPU_ATTRIBUTE_VISIBILITY_DEFAULT;
+
 #pragma GCC visibility pop
 
 #ifdef __cplusplus
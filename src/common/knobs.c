@@ -83,6 +83,10 @@ void _starpu_perf_counter_init(struct _starpu_machine_config *pconfig)
 
 	/* call counter registration routines in each modules */
 	_starpu__task_c__register_counters();
+	_starpu__cache_affinity_policy_c__register_counters();
+#ifdef STARPU_OVERHEAD_BREAKDOWN
+	_starpu__overhead_c__register_counters();
+#endif
 }
 
 void _starpu_perf_counter_exit(void)
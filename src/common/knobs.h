@@ -282,9 +282,12 @@ extern starpu_perf_counter_int64_t _starpu_task__g_peak_submitted__value;
 extern starpu_perf_counter_int64_t _starpu_task__g_current_submitted__value;
 extern starpu_perf_counter_int64_t _starpu_task__g_peak_ready__value;
 extern starpu_perf_counter_int64_t _starpu_task__g_current_ready__value;
+extern starpu_perf_counter_int64_t _starpu_task__g_deadline_met__value;
+extern starpu_perf_counter_int64_t _starpu_task__g_deadline_missed__value;
 
 /* performance counter registration routines per modules */
 void _starpu__task_c__register_counters(void);	/* module: task.c */
+void _starpu__cache_affinity_policy_c__register_counters(void);	/* module: cache_affinity_policy.c */
 
 
 /* -------------------------------------------------------------------- */
@@ -1102,6 +1102,35 @@ void _starpu_pthread_spin_do_unlock(starpu_pthread_spinlock_t *lock)
 
 #endif /* defined(STARPU_SIMGRID) || (defined(STARPU_LINUX_SYS) && defined(STARPU_HAVE_XCHG)) || !defined(STARPU_HAVE_PTHREAD_SPIN_LOCK) */
 
+#ifdef _STARPU_HAVE_FUTEX
+void _starpu_futex_block(unsigned *addr, unsigned val)
+{
+	/* EAGAIN (the value already changed) and EINTR are fine, the caller
+	 * checks the value again anyway */
+	if (syscall(SYS_futex, addr, _starpu_futex_wait, val, NULL, NULL, 0) == -1 && errno == ENOSYS)
+	{
+		_starpu_futex_wait = FUTEX_WAIT;
+		syscall(SYS_futex, addr, _starpu_futex_wait, val, NULL, NULL, 0);
+	}
+}
+
+void _starpu_futex_wakeup(unsigned *addr)
+{
+	if (syscall(SYS_futex, addr, _starpu_futex_wake, 1, NULL, NULL, 0) == -1)
+		switch (errno)
+		{
+			case ENOSYS:
+				_starpu_futex_wake = FUTEX_WAKE;
+				if (syscall(SYS_futex, addr, _starpu_futex_wake, 1, NULL, NULL, 0) == -1)
+					STARPU_ASSERT_MSG(0, "futex(wake) returned %d!", errno);
+				break;
+			default:
+				STARPU_ASSERT_MSG(0, "futex returned %d!", errno);
+				break;
+		}
+}
+#endif
+
 #ifdef STARPU_SIMGRID
 
 int starpu_sem_destroy(starpu_sem_t *sem)
@@ -24,6 +24,15 @@
 
 #pragma GCC visibility push(hidden)
 
+#if !defined(STARPU_SIMGRID) && defined(STARPU_LINUX_SYS) && defined(STARPU_HAVE_XCHG)
+#define _STARPU_HAVE_FUTEX
+/** Block while *addr is equal to val, until _starpu_futex_wakeup is called
+ * on addr. May return spuriously. */
+void _starpu_futex_block(unsigned *addr, unsigned val);
+/** Wake up one thread blocked on addr */
+void _starpu_futex_wakeup(unsigned *addr);
+#endif
+
 #if defined(STARPU_LINUX_SYS) && defined(STARPU_HAVE_XCHG)
 int _starpu_pthread_spin_do_lock(starpu_pthread_spinlock_t *lock) STARPU_ATTRIBUTE_VISIBILITY_DEFAULT;
 #endif
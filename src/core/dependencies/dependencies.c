@@ -48,7 +48,8 @@ struct _starpu_notify_job_start_data
 
 void starpu_task_notify_ready_soon_register(starpu_notify_ready_soon_func f, void *data)
 {
-	STARPU_ASSERT(!notify_ready_soon_func);
+	/* Only one function can be registered at a time, NULL unregisters it */
+	STARPU_ASSERT(!notify_ready_soon_func || !f);
 	notify_ready_soon_func = f;
 	notify_ready_soon_func_data = data;
 }
@@ -33,6 +33,7 @@
 
 static int max_memory_use;
 static int task_progress;
+static int successor_continuation;
 static unsigned long njobs_finished;
 static unsigned long njobs, maxnjobs;
 
@@ -48,6 +49,7 @@ void _starpu_job_init(void)
 {
 	max_memory_use = starpu_getenv_number_default("STARPU_MAX_MEMORY_USE", 0);
 	task_progress = starpu_getenv_number_default("STARPU_TASK_PROGRESS", 0);
+	successor_continuation = starpu_getenv_number_default("STARPU_SUCCESSOR_CONTINUATION", 0);
 #ifdef STARPU_DEBUG
 	_starpu_job_multilist_head_init_all_submitted(&all_jobs_list);
 #endif
@@ -351,6 +353,8 @@ void _starpu_handle_job_termination(struct _starpu_job *j)
 		if (nb != 0) return;
 	}
 
+	_STARPU_OVERHEAD_START(overhead_start);
+
 	if (task_progress)
 	{
 		unsigned long jobs = STARPU_ATOMIC_ADDL(&njobs_finished, 1);
@@ -537,10 +541,20 @@ void _starpu_handle_job_termination(struct _starpu_job *j)
 		 * now. Task/tag dependencies will be notified only when the continued
 		 * task fully completes */
 		/* in case there are dependencies, wake up the proper tasks */
+		struct _starpu_worker *successor_worker = NULL;
+		if (successor_continuation && j->task_size == 1 && !nowhere)
+			/* Let the first successor which gets ready run on this worker */
+			successor_worker = _starpu_get_local_worker_key();
+		if (successor_worker)
+			successor_worker->successor_continuation = 1;
+
 		if (end_rdep)
 			starpu_task_end_dep_release(end_rdep);
 		_starpu_notify_dependencies(j);
 
+		if (successor_worker)
+			successor_worker->successor_continuation = 0;
+
 		/* If this is a continuation, we do not execute the callback
 		 * now. The callback will be executed only when the continued
 		 * task fully completes */
@@ -680,6 +694,8 @@ void _starpu_handle_job_termination(struct _starpu_job *j)
 		}
 		STARPU_PTHREAD_MUTEX_UNLOCK_SCHED(&worker->sched_mutex);
 	}
+
+	_STARPU_OVERHEAD_END_WORKER(worker, _STARPU_OVERHEAD_TERMINATION, overhead_start);
 }
 
 /* This function is called when a new task is submitted to StarPU
@@ -888,11 +904,13 @@ unsigned _starpu_enforce_deps_and_schedule(struct _starpu_job *j)
 {
 	unsigned ret;
 	_STARPU_LOG_IN();
+	_STARPU_OVERHEAD_START(overhead_start);
 
 	/* enforce tag dependencies */
 	if (_starpu_not_all_tag_deps_are_fulfilled(j))
 	{
 		STARPU_PTHREAD_MUTEX_UNLOCK(&j->sync_mutex);
+		_STARPU_OVERHEAD_END(_STARPU_OVERHEAD_ENFORCE_DEPS, overhead_start);
 		_STARPU_LOG_OUT_TAG("not_all_tag_deps_are_fulfilled");
 		return 0;
 	}
@@ -901,6 +919,7 @@ unsigned _starpu_enforce_deps_and_schedule(struct _starpu_job *j)
 	if (_starpu_not_all_task_deps_are_fulfilled(j))
 	{
 		STARPU_PTHREAD_MUTEX_UNLOCK(&j->sync_mutex);
+		_STARPU_OVERHEAD_END(_STARPU_OVERHEAD_ENFORCE_DEPS, overhead_start);
 		_STARPU_LOG_OUT_TAG("not_all_task_deps_are_fulfilled");
 		return 0;
 	}
@@ -933,6 +952,7 @@ unsigned _starpu_enforce_deps_and_schedule(struct _starpu_job *j)
 		/* respect data concurrent access */
 		if (_starpu_concurrent_data_access(j))
 		{
+			_STARPU_OVERHEAD_END(_STARPU_OVERHEAD_ENFORCE_DEPS, overhead_start);
 			_STARPU_LOG_OUT_TAG("concurrent_data_access");
 			return 0;
 		}
@@ -942,6 +962,7 @@ unsigned _starpu_enforce_deps_and_schedule(struct _starpu_job *j)
 	if (j->task->bubble_parent != 0)
 		_STARPU_TRACE_BUBBLE_TASK_DEPS(j->task->bubble_parent, j);
 #endif
+	_STARPU_OVERHEAD_END(_STARPU_OVERHEAD_ENFORCE_DEPS, overhead_start);
 
 	ret = _starpu_push_task(j);
 
@@ -1053,6 +1074,31 @@ void _starpu_enforce_deps_notify_job_ready_soon(struct _starpu_job *j, _starpu_n
 	_starpu_enforce_data_deps_notify_job_ready_soon(j, data);
 }
 
+int _starpu_job_successor_continuation_worker(struct starpu_task *task)
+{
+	struct _starpu_worker *worker = _starpu_get_local_worker_key();
+	struct _starpu_sched_ctx *sched_ctx;
+	unsigned nimpl;
+
+	if (!worker || !worker->successor_continuation)
+		return -1;
+	sched_ctx = _starpu_get_sched_ctx_struct(task->sched_ctx);
+	if (!sched_ctx->sched_policy || !sched_ctx->sched_policy->successor_continuation)
+		/* The policy wants to see all tasks */
+		return -1;
+	STARPU_HG_DISABLE_CHECKING(worker->local_tasks);
+	if (!starpu_task_prio_list_empty(&worker->local_tasks))
+		return -1;
+	if (!task->cl
+		|| !starpu_sched_ctx_contains_worker(worker->workerid, task->sched_ctx)
+		|| !starpu_worker_can_execute_task_first_impl(worker->workerid, task, &nimpl))
+		return -1;
+
+	/* Only one, the others go to the scheduler */
+	worker->successor_continuation = 0;
+	return worker->workerid;
+}
+
 /* Ordered tasks are simply recorded as they arrive in the local_ordered_tasks
  * ring buffer, indexed by order, and pulled from its head. */
 /* TODO: replace with perhaps a heap */
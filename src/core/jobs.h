@@ -157,6 +157,10 @@ struct _starpu_job
 
 	/** Cumulated energy consumption for discontinuous jobs */
 	double cumulated_energy_consumed;
+
+	/** Stack and contexts of a yieldable codelet function which has
+	 * started */
+	struct _starpu_task_yield_ctx *yield_ctx;
 #endif
 
 	/** The value of the footprint that identifies the job may be stored in
@@ -179,6 +183,11 @@ struct _starpu_job
 	 * so we need a flag to differentiate them from "normal" tasks. */
 	unsigned reduction_task:1;
 
+	/** Was the task captured in a task graph? Its data handles are then
+	 * already ordered, and its implicit data dependencies were turned into
+	 * explicit task dependencies, see starpu_task_graph_capture_begin(). */
+	unsigned captured:1;
+
 	/** The implementation associated to the job */
 	unsigned nimpl;
 
@@ -271,6 +280,11 @@ void _starpu_handle_job_termination(struct _starpu_job *j);
 /** Get the sum of the size of the data accessed by the job. */
 size_t _starpu_job_get_data_size(struct starpu_perfmodel *model, struct starpu_perfmodel_arch* arch, unsigned nimpl, struct _starpu_job *j);
 
+/** Return the id of the calling worker if \p task was just made ready by the
+ * termination of its previous task, and should thus rather be run by it right
+ * away, instead of being pushed to the scheduler. Return -1 otherwise. */
+int _starpu_job_successor_continuation_worker(struct starpu_task *task);
+
 /** Get a task from the local pool of tasks that were explicitly attributed to
  * that worker. */
 struct starpu_task *_starpu_pop_local_task(struct _starpu_worker *worker);
@@ -510,6 +510,115 @@ double starpu_task_expected_data_transfer_time_for(struct starpu_task *task, uns
 	return penalty;
 }
 
+static int _starpu_perfmodel_arch_equal(struct starpu_perfmodel_arch *a, struct starpu_perfmodel_arch *b)
+{
+	int dev;
+	if (a == b)
+		return 1;
+	if (a->ndevices != b->ndevices)
+		return 0;
+	for (dev = 0; dev < a->ndevices; dev++)
+		if (a->devices[dev].type != b->devices[dev].type
+		 || a->devices[dev].devid != b->devices[dev].devid
+		 || a->devices[dev].ncores != b->devices[dev].ncores)
+			return 0;
+	return 1;
+}
+
+/* Compute predictions for a whole set of workers. Workers with the same
+ * perfmodel architecture get the same length and energy, unless the models are
+ * per-worker, and workers with the same memory node get the same transfer
+ * time, unless the codelet uses specific nodes, so only compute them once. */
+void _starpu_task_expected_predictions(struct starpu_task *task, unsigned sched_ctx_id,
+				       unsigned nworkers, const unsigned *workerids, const unsigned *impl_masks,
+				       double *lengths, double *energies, double *transfers)
+{
+	struct starpu_perfmodel_arch *archs[nworkers];
+	/* For each distinct architecture, the first worker which has it */
+	unsigned arch_worker[nworkers];
+	unsigned narchs = 0;
+	/* For each memory node, the first worker which uses it, or -1 */
+	int node_worker[STARPU_MAXNODES];
+	int per_worker_length, per_worker_energy, per_worker_transfer;
+	unsigned i, a, nimpl;
+
+	if (!task->cl)
+	{
+		/* Tasks without codelet don't actually take time */
+		for (i = 0; i < nworkers * STARPU_MAXIMPLEMENTATIONS; i++)
+		{
+			lengths[i] = 0.0;
+			if (energies)
+				energies[i] = 0.0;
+		}
+		if (transfers)
+			for (i = 0; i < nworkers; i++)
+				transfers[i] = 0.0;
+		return;
+	}
+
+	per_worker_length = task->cl->model && task->cl->model->type == STARPU_PER_WORKER;
+	per_worker_energy = task->cl->energy_model && task->cl->energy_model->type == STARPU_PER_WORKER;
+	per_worker_transfer = task->cl->specific_nodes;
+	for (i = 0; i < STARPU_MAXNODES; i++)
+		node_worker[i] = -1;
+
+	for (i = 0; i < nworkers; i++)
+	{
+		unsigned workerid = workerids[i];
+		unsigned mask = impl_masks ? impl_masks[i] : ~0U;
+		struct starpu_perfmodel_arch *arch = starpu_worker_get_perf_archtype(workerid, sched_ctx_id);
+		int ref = -1;
+
+		for (a = 0; a < narchs; a++)
+			if (_starpu_perfmodel_arch_equal(archs[a], arch))
+				break;
+		if (a == narchs)
+		{
+			archs[narchs] = arch;
+			arch_worker[narchs] = i;
+			narchs++;
+		}
+		else
+			ref = arch_worker[a];
+
+		for (nimpl = 0; nimpl < STARPU_MAXIMPLEMENTATIONS; nimpl++)
+		{
+			unsigned idx = nimpl * nworkers + i;
+			/* Whether the reference worker has computed this implementation */
+			int ref_ok = ref != -1 && (!impl_masks || (impl_masks[ref] & (1U << nimpl)));
+
+			if (!(mask & (1U << nimpl)))
+				continue;
+
+			if (ref_ok && !per_worker_length)
+				lengths[idx] = lengths[nimpl * nworkers + ref];
+			else
+				lengths[idx] = starpu_model_worker_expected_perf(task, task->cl->model, workerid, sched_ctx_id, nimpl);
+
+			if (energies)
+			{
+				if (ref_ok && !per_worker_energy)
+					energies[idx] = energies[nimpl * nworkers + ref];
+				else
+					energies[idx] = starpu_model_worker_expected_perf(task, task->cl->energy_model, workerid, sched_ctx_id, nimpl);
+			}
+		}
+
+		if (transfers)
+		{
+			unsigned memory_node = starpu_worker_get_memory_node(workerid);
+			if (!per_worker_transfer && node_worker[memory_node] != -1)
+				transfers[i] = transfers[node_worker[memory_node]];
+			else
+			{
+				transfers[i] = starpu_task_expected_data_transfer_time_for(task, workerid);
+				node_worker[memory_node] = i;
+			}
+		}
+	}
+}
+
 /* Return the expected duration of the entire task bundle in µs */
 double starpu_task_bundle_expected_length(starpu_task_bundle_t bundle, struct starpu_perfmodel_arch* arch, unsigned nimpl)
 {
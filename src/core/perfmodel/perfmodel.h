@@ -70,6 +70,8 @@ struct _starpu_job;
 struct starpu_perfmodel_arch;
 
 extern unsigned _starpu_calibration_minimum;
+/** Bumped each time a performance model is updated or unloaded */
+extern unsigned _starpu_perfmodel_generation;
 extern int _starpu_benchmarking_bus;
 
 void _starpu_find_perf_model_codelet(const char *symbol, const char *hostname, char *path, size_t maxlen);
@@ -94,6 +96,17 @@ double _starpu_multiple_regression_based_job_expected_perf(struct starpu_perfmod
 void _starpu_update_perfmodel_history(struct _starpu_job *j, struct starpu_perfmodel *model, struct starpu_perfmodel_arch * arch, unsigned cpuid, double measured, unsigned nimpl, unsigned number);
 int _starpu_perfmodel_create_comb_if_needed(struct starpu_perfmodel_arch* arch);
 
+/** Compute in one go the expected length, energy and data transfer time of
+ * \p task on the \p nworkers workers \p workerids, for the implementations
+ * set in \p impl_masks (all of them if \p impl_masks is NULL). Results are
+ * stored as structures of arrays: \p lengths and \p energies are indexed by
+ * nimpl * nworkers + i, and \p transfers by i. \p energies and \p transfers
+ * may be NULL. Model lookups are only done once per distinct perfmodel
+ * architecture, and transfer estimations once per memory node. */
+void _starpu_task_expected_predictions(struct starpu_task *task, unsigned sched_ctx_id,
+				       unsigned nworkers, const unsigned *workerids, const unsigned *impl_masks,
+				       double *lengths, double *energies, double *transfers);
+
 int _starpu_create_bus_sampling_directory_if_needed(int location);
 void _starpu_create_codelet_sampling_directory_if_needed(int location);
 
@@ -55,6 +55,10 @@ static char ignore_devid[STARPU_NARCH];
  * consider that calibration will provide a value good enough for scheduling */
 unsigned _starpu_calibration_minimum;
 
+/* Bumped each time a model changes, so that schedulers can tell whether
+ * predictions they kept are still valid */
+unsigned _starpu_perfmodel_generation;
+
 struct starpu_perfmodel_history_table
 {
 	UT_hash_handle hh;
@@ -1521,6 +1525,7 @@ int starpu_perfmodel_unload_model(struct starpu_perfmodel *model)
 
 int starpu_perfmodel_deinit(struct starpu_perfmodel *model)
 {
+	(void) STARPU_ATOMIC_ADD(&_starpu_perfmodel_generation, 1);
 	_starpu_deinitialize_performance_model(model);
 	free(model->path);
 	free(model->state);
@@ -2089,6 +2094,7 @@ void _starpu_update_perfmodel_history(struct _starpu_job *j, struct starpu_perfm
 		fclose(f);
 #endif
 		STARPU_PTHREAD_RWLOCK_UNLOCK(&model->state->model_rwlock);
+		(void) STARPU_ATOMIC_ADD(&_starpu_perfmodel_generation, 1);
 	}
 }
 
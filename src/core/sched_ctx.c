@@ -31,6 +31,8 @@ enum _starpu_ctx_change_op
 };
 static starpu_pthread_mutex_t sched_ctx_manag = STARPU_PTHREAD_MUTEX_INITIALIZER;
 static starpu_pthread_mutex_t finished_submit_mutex = STARPU_PTHREAD_MUTEX_INITIALIZER;
+static starpu_pthread_mutex_t fair_share_mutex = STARPU_PTHREAD_MUTEX_INITIALIZER;
+int _starpu_sched_ctx_fair_share;
 static struct starpu_task stop_submission_task = STARPU_TASK_INITIALIZER;
 static starpu_pthread_key_t sched_ctx_key;
 static unsigned with_hypervisor = 0;
@@ -579,8 +581,10 @@ struct _starpu_sched_ctx* _starpu_create_sched_ctx(struct starpu_sched_policy *p
 	else
 		sched_ctx->max_priority = 0;
 
-	_starpu_barrier_counter_init(&sched_ctx->tasks_barrier, 0);
-	_starpu_barrier_counter_init(&sched_ctx->ready_tasks_barrier, 0);
+	/* These are updated on each task submission and termination, let each
+	 * worker update its own shard */
+	_starpu_barrier_counter_init_sharded(&sched_ctx->tasks_barrier, 0, starpu_worker_get_count());
+	_starpu_barrier_counter_init_sharded(&sched_ctx->ready_tasks_barrier, 0, starpu_worker_get_count());
 
 	sched_ctx->ready_flops = 0.0;
 	for (i = 0; i < (int) (sizeof(sched_ctx->iterations)/sizeof(sched_ctx->iterations[0])); i++)
@@ -613,6 +617,10 @@ struct _starpu_sched_ctx* _starpu_create_sched_ctx(struct starpu_sched_policy *p
 	sched_ctx->nsub_ctxs = 0;
 	sched_ctx->parallel_view = 0;
 
+	sched_ctx->fair_share_weight = 0.;
+	sched_ctx->fair_share_consumed = 0.;
+	sched_ctx->fair_share_vtime = 0.;
+
 	/*init the strategy structs and the worker_collection of the resources of the context */
 	if(policy)
 	{
@@ -719,6 +727,7 @@ unsigned starpu_sched_ctx_create(int *workerids, int nworkers, const char *sched
 	unsigned hierarchy_level = 0;
 	unsigned nesting_sched_ctx = STARPU_NMAX_SCHED_CTXS;
 	unsigned awake_workers = 0;
+	double fair_share_weight = 0.;
 	void (*init_sched)(unsigned) = NULL;
 
 	va_start(varg_list, sched_ctx_name);
@@ -777,6 +786,10 @@ unsigned starpu_sched_ctx_create(int *workerids, int nworkers, const char *sched
 		{
 			nsms = va_arg(varg_list, int);
 		}
+		else if (arg_type == STARPU_SCHED_CTX_FAIR_SHARE_WEIGHT)
+		{
+			fair_share_weight = va_arg(varg_list, double);
+		}
 		else
 		{
 			STARPU_ABORT_MSG("Unrecognized argument %d\n", arg_type);
@@ -802,6 +815,8 @@ unsigned starpu_sched_ctx_create(int *workerids, int nworkers, const char *sched
 	sched_ctx = _starpu_create_sched_ctx(sched_policy, workerids, nworkers, 0, sched_ctx_name, min_prio_set, min_prio, max_prio_set, max_prio, awake_workers, init_sched, user_data, nsub_ctxs, sub_ctxs, nsms);
 	sched_ctx->hierarchy_level = hierarchy_level;
 	sched_ctx->nesting_sched_ctx = nesting_sched_ctx;
+	if (fair_share_weight != 0.)
+		starpu_sched_ctx_set_fair_share_weight(sched_ctx->id, fair_share_weight);
 
 	int *added_workerids;
 	unsigned nw_ctx = starpu_sched_ctx_get_workers_list(sched_ctx->id, &added_workerids);
@@ -835,6 +850,7 @@ int fstarpu_sched_ctx_create(int *workerids, int nworkers, const char *sched_ctx
 	unsigned hierarchy_level = 0;
 	unsigned nesting_sched_ctx = STARPU_NMAX_SCHED_CTXS;
 	unsigned awake_workers = 0;
+	double fair_share_weight = 0.;
 	void (*init_sched)(unsigned) = NULL;
 
 	while (arglist[arg_i] != NULL)
@@ -904,6 +920,11 @@ int fstarpu_sched_ctx_create(int *workerids, int nworkers, const char *sched_ctx
 			arg_i++;
 			nsms = *(int*)arglist[arg_i];
 		}
+		else if (arg_type == STARPU_SCHED_CTX_FAIR_SHARE_WEIGHT)
+		{
+			arg_i++;
+			fair_share_weight = *(double*)arglist[arg_i];
+		}
 
 		else
 		{
@@ -932,6 +953,8 @@ int fstarpu_sched_ctx_create(int *workerids, int nworkers, const char *sched_ctx
 	sched_ctx = _starpu_create_sched_ctx(sched_policy, workerids, nworkers, 0, sched_ctx_name, min_prio_set, min_prio, max_prio_set, max_prio, awake_workers, init_sched, user_data, nsub_ctxs, sub_ctxs, nsms);
 	sched_ctx->hierarchy_level = hierarchy_level;
 	sched_ctx->nesting_sched_ctx = nesting_sched_ctx;
+	if (fair_share_weight != 0.)
+		starpu_sched_ctx_set_fair_share_weight(sched_ctx->id, fair_share_weight);
 
 	int *added_workerids;
 	unsigned nw_ctx = starpu_sched_ctx_get_workers_list(sched_ctx->id, &added_workerids);
@@ -1467,6 +1490,7 @@ void _starpu_init_all_sched_ctxs(struct _starpu_machine_config *config)
 		config->sched_ctxs[i].id = STARPU_NMAX_SCHED_CTXS;
 		STARPU_PTHREAD_RWLOCK_INIT0(&config->sched_ctxs[i].rwlock, NULL);
 	}
+	_starpu_sched_ctx_fair_share = 0;
 
 	return;
 }
@@ -2119,6 +2143,80 @@ int starpu_sched_ctx_set_max_priority(unsigned sched_ctx_id, int max_prio)
 	return 0;
 }
 
+void starpu_sched_ctx_set_fair_share_weight(unsigned sched_ctx_id, double weight)
+{
+	struct _starpu_sched_ctx *sched_ctx = _starpu_get_sched_ctx_struct(sched_ctx_id);
+	STARPU_ASSERT_MSG(weight > 0., "the fair share weight of a context has to be positive");
+	STARPU_PTHREAD_MUTEX_LOCK(&fair_share_mutex);
+	sched_ctx->fair_share_weight = weight;
+	STARPU_PTHREAD_MUTEX_UNLOCK(&fair_share_mutex);
+	STARPU_WMB();
+	_starpu_sched_ctx_fair_share = 1;
+}
+
+double starpu_sched_ctx_get_fair_share_weight(unsigned sched_ctx_id)
+{
+	struct _starpu_sched_ctx *sched_ctx = _starpu_get_sched_ctx_struct(sched_ctx_id);
+	return sched_ctx->fair_share_weight != 0. ? sched_ctx->fair_share_weight : 1.;
+}
+
+double starpu_sched_ctx_get_fair_share_consumed(unsigned sched_ctx_id)
+{
+	struct _starpu_sched_ctx *sched_ctx = _starpu_get_sched_ctx_struct(sched_ctx_id);
+	return sched_ctx->fair_share_consumed;
+}
+
+void _starpu_sched_ctx_fair_share_account(unsigned sched_ctx_id, double measured)
+{
+	struct _starpu_sched_ctx *sched_ctx = _starpu_get_sched_ctx_struct(sched_ctx_id);
+	STARPU_PTHREAD_MUTEX_LOCK(&fair_share_mutex);
+	sched_ctx->fair_share_consumed += measured;
+	sched_ctx->fair_share_vtime += measured / starpu_sched_ctx_get_fair_share_weight(sched_ctx_id);
+	STARPU_PTHREAD_MUTEX_UNLOCK(&fair_share_mutex);
+}
+
+struct _starpu_sched_ctx *_starpu_sched_ctx_fair_share_pick(struct _starpu_worker *worker)
+{
+	struct _starpu_sched_ctx_list_iterator list_it;
+	struct _starpu_sched_ctx *best = NULL;
+
+	/* Stride scheduling: serve the ctx which consumed the least time
+	 * relative to its weight */
+	_starpu_sched_ctx_list_iterator_init(worker->sched_ctx_list, &list_it);
+	while (_starpu_sched_ctx_list_iterator_has_next(&list_it))
+	{
+		struct _starpu_sched_ctx_elt *e = _starpu_sched_ctx_list_iterator_get_next(&list_it);
+		if (e->task_number > 0)
+		{
+			struct _starpu_sched_ctx *sched_ctx = _starpu_get_sched_ctx_struct(e->sched_ctx);
+			if (!best || sched_ctx->fair_share_vtime < best->fair_share_vtime)
+				best = sched_ctx;
+		}
+	}
+
+	if (!best)
+		return NULL;
+
+	/* A ctx which had nothing to run must not be able to claim back the
+	 * time it did not use and monopolize the workers when it gets
+	 * tasks again, so bring it up to the ctxs which are running */
+	_starpu_sched_ctx_list_iterator_init(worker->sched_ctx_list, &list_it);
+	while (_starpu_sched_ctx_list_iterator_has_next(&list_it))
+	{
+		struct _starpu_sched_ctx_elt *e = _starpu_sched_ctx_list_iterator_get_next(&list_it);
+		struct _starpu_sched_ctx *sched_ctx = _starpu_get_sched_ctx_struct(e->sched_ctx);
+		if (e->task_number <= 0 && sched_ctx->fair_share_vtime < best->fair_share_vtime)
+		{
+			STARPU_PTHREAD_MUTEX_LOCK(&fair_share_mutex);
+			if (sched_ctx->fair_share_vtime < best->fair_share_vtime)
+				sched_ctx->fair_share_vtime = best->fair_share_vtime;
+			STARPU_PTHREAD_MUTEX_UNLOCK(&fair_share_mutex);
+		}
+	}
+
+	return best;
+}
+
 int starpu_sched_ctx_min_priority_is_set(unsigned sched_ctx_id)
 {
 	struct _starpu_sched_ctx *sched_ctx = _starpu_get_sched_ctx_struct(sched_ctx_id);
@@ -164,6 +164,14 @@ struct _starpu_sched_ctx
 
 	int stream_worker;
 
+	/** weight of the ctx in the fair share of the workers, 0 if not set */
+	double fair_share_weight;
+	/** execution time consumed by the tasks of the ctx, in us */
+	double fair_share_consumed;
+	/** virtual time of the ctx, i.e. the consumed time divided by the
+	 * weight, the ctx with the smallest one is served first */
+	double fair_share_vtime;
+
 	starpu_pthread_rwlock_t rwlock;
 	starpu_pthread_t lock_write_owner;
 };
@@ -189,6 +197,16 @@ struct _starpu_sched_ctx*  _starpu_create_sched_ctx(struct starpu_sched_policy *
 						    int max_prio_set, int max_prio, unsigned awake_workers, void (*sched_policy_callback)(unsigned), void *user_data,
 						    int nsub_ctxs, int *sub_ctxs, int nsms);
 
+/** Whether a fair share weight was set on some ctx */
+extern int _starpu_sched_ctx_fair_share;
+
+/** Among the ctxs of the worker which have ready tasks, return the one which
+ * is the most behind its fair share, or NULL if none has ready tasks */
+struct _starpu_sched_ctx *_starpu_sched_ctx_fair_share_pick(struct _starpu_worker *worker);
+
+/** Charge the execution time measured (in us) of a task to its ctx */
+void _starpu_sched_ctx_fair_share_account(unsigned sched_ctx_id, double measured);
+
 /** delete all sched_ctx */
 void _starpu_delete_all_sched_ctxs();
 
@@ -17,6 +17,7 @@
  * See the GNU Lesser General Public License in COPYING.LGPL for more details.
  */
 
+#include <math.h>
 #include <starpu.h>
 #include <common/config.h>
 #include <common/utils.h>
@@ -33,6 +34,9 @@
 #endif
 
 static int use_prefetch = 0;
+/* Tasks of STARPU_CODELET_INLINE codelets which are expected to last less than
+ * this (in us) are kept by the CPU worker which makes them ready */
+static double inline_threshold;
 static double idle[STARPU_NMAXWORKERS];
 static double idle_start[STARPU_NMAXWORKERS];
 
@@ -74,6 +78,8 @@ static struct starpu_sched_policy *predefined_policies[] =
 	&_starpu_sched_modular_parallel_random_policy,
 	&_starpu_sched_modular_parallel_random_prio_policy,
 	&_starpu_sched_modular_ws_policy,
+	&_starpu_sched_modular_numa_policy,
+	&_starpu_sched_modular_deadline_policy,
 	&_starpu_sched_modular_heft_policy,
 	&_starpu_sched_modular_heft_prio_policy,
 	&_starpu_sched_modular_heft2_policy,
@@ -85,16 +91,19 @@ static struct starpu_sched_policy *predefined_policies[] =
 	&_starpu_sched_random_policy,
 	&_starpu_sched_lws_policy,
 	&_starpu_sched_ws_policy,
+	&_starpu_sched_cws_policy,
 	&_starpu_sched_dm_policy,
 	&_starpu_sched_dmda_policy,
 	&_starpu_sched_dmda_prio_policy,
 	&_starpu_sched_dmda_ready_policy,
+	&_starpu_sched_dmda_lookahead_policy,
 	&_starpu_sched_dmda_sorted_policy,
 	&_starpu_sched_dmda_sorted_decision_policy,
 	&_starpu_sched_parallel_heft_policy,
 	&_starpu_sched_peager_policy,
 	&_starpu_sched_heteroprio_policy,
 	&_starpu_sched_graph_test_policy,
+	&_starpu_sched_cache_affinity_policy,
 #ifdef STARPU_HAVE_HWLOC
 	//&_starpu_sched_tree_heft_hierarchical_policy,
 #endif
@@ -344,6 +353,8 @@ void _starpu_init_sched_policy(struct _starpu_machine_config *config, struct _st
 	if (use_prefetch == -1)
 		use_prefetch = 1;
 
+	inline_threshold = starpu_getenv_float_default("STARPU_INLINE_TASK_THRESHOLD", 10.);
+
 	/* Set calibrate flag */
 	_starpu_set_calibrate_flag(config->conf.calibrate);
 
@@ -581,7 +592,10 @@ int _starpu_push_task(struct _starpu_job *j)
 		_starpu_spin_unlock(&p_trs->lock);
 	}
 
-	return _starpu_repush_task(j);
+	_STARPU_OVERHEAD_START(overhead_start);
+	int ret = _starpu_repush_task(j);
+	_STARPU_OVERHEAD_END(_STARPU_OVERHEAD_PUSH, overhead_start);
+	return ret;
 }
 
 int _starpu_repush_task(struct _starpu_job *j)
@@ -694,6 +708,47 @@ int _starpu_repush_task(struct _starpu_job *j)
 	return ret;
 }
 
+/* Return the CPU worker which is making task ready, if the task is small enough
+ * and its input is already there for the worker to run it next, or -1 */
+static int _starpu_task_inline_worker(struct starpu_task *task, struct _starpu_sched_ctx *sched_ctx)
+{
+	struct _starpu_worker *worker;
+	unsigned nimpl, i, nbuffers;
+	double length;
+
+	if (!task->cl || !(task->cl->flags & STARPU_CODELET_INLINE) || !task->cl->model
+		|| inline_threshold <= 0. || !sched_ctx->sched_policy)
+		return -1;
+
+	worker = _starpu_get_local_worker_key();
+	if (!worker || worker->arch != STARPU_CPU_WORKER)
+		/* Application thread, or accelerator driver */
+		return -1;
+	STARPU_HG_DISABLE_CHECKING(worker->local_tasks);
+	if (!starpu_task_prio_list_empty(&worker->local_tasks))
+		/* It already has something to run next, let the others help */
+		return -1;
+	if (!starpu_sched_ctx_contains_worker(worker->workerid, task->sched_ctx)
+		|| !starpu_worker_can_execute_task_first_impl(worker->workerid, task, &nimpl))
+		return -1;
+
+	length = starpu_task_worker_expected_length(task, worker->workerid, task->sched_ctx, nimpl);
+	if (isnan(length) || length > inline_threshold)
+		/* Not calibrated yet, or too long */
+		return -1;
+
+	nbuffers = STARPU_TASK_GET_NBUFFERS(task);
+	for (i = 0; i < nbuffers; i++)
+	{
+		if (!(STARPU_TASK_GET_MODE(task, i) & STARPU_R))
+			continue;
+		if (!starpu_data_is_on_node_excluding_prefetch(STARPU_TASK_GET_HANDLE(task, i), worker->memory_node))
+			return -1;
+	}
+
+	return worker->workerid;
+}
+
 int _starpu_push_task_to_workers(struct starpu_task *task)
 {
 	struct _starpu_sched_ctx *sched_ctx = _starpu_get_sched_ctx_struct(task->sched_ctx);
@@ -730,10 +785,23 @@ int _starpu_push_task_to_workers(struct starpu_task *task)
 	_starpu_profiling_set_task_push_start_time(task);
 
 	int ret = 0;
+	int inline_workerid;
 	if (STARPU_UNLIKELY(task->execute_on_a_specific_worker))
 	{
 		ret = _starpu_push_task_on_specific_worker(task, task->workerid);
 	}
+	else if ((inline_workerid = _starpu_task_inline_worker(task, sched_ctx)) != -1)
+	{
+		/* Run to completion on this worker, without bothering the
+		 * scheduler and waking up another worker */
+		ret = _starpu_push_task_on_specific_worker(task, inline_workerid);
+	}
+	else if ((inline_workerid = _starpu_job_successor_continuation_worker(task)) != -1)
+	{
+		/* Its predecessor just completed here, run it while its data
+		 * is still hot in the caches */
+		ret = _starpu_push_task_on_specific_worker(task, inline_workerid);
+	}
 	else
 	{
 		struct _starpu_machine_config *config = _starpu_get_machine_config();
@@ -959,12 +1027,21 @@ struct _starpu_sched_ctx* _get_next_sched_ctx_to_pop_into(struct _starpu_worker
 	struct _starpu_sched_ctx_list_iterator list_it;
 	int found = 0;
 
-	_starpu_sched_ctx_list_iterator_init(worker->sched_ctx_list, &list_it);
-	while (_starpu_sched_ctx_list_iterator_has_next(&list_it))
+	if (_starpu_sched_ctx_fair_share)
 	{
-		e = _starpu_sched_ctx_list_iterator_get_next(&list_it);
-		if (e->task_number > 0)
-			return _starpu_get_sched_ctx_struct(e->sched_ctx);
+		struct _starpu_sched_ctx *sched_ctx = _starpu_sched_ctx_fair_share_pick(worker);
+		if (sched_ctx)
+			return sched_ctx;
+	}
+	else
+	{
+		_starpu_sched_ctx_list_iterator_init(worker->sched_ctx_list, &list_it);
+		while (_starpu_sched_ctx_list_iterator_has_next(&list_it))
+		{
+			e = _starpu_sched_ctx_list_iterator_get_next(&list_it);
+			if (e->task_number > 0)
+				return _starpu_get_sched_ctx_struct(e->sched_ctx);
+		}
 	}
 
 	_starpu_sched_ctx_list_iterator_init(worker->sched_ctx_list, &list_it);
@@ -25,11 +25,13 @@
 #include <core/jobs.h>
 #include <core/task.h>
 #include <core/task_bundle.h>
+#include <core/task_capture.h>
 #include <core/dependencies/data_concurrency.h>
 #include <common/config.h>
 #include <common/utils.h>
 #include <common/fxt.h>
 #include <common/knobs.h>
+#include <common/graph.h>
 #include <datawizard/memory_nodes.h>
 #include <profiling/profiling.h>
 #include <profiling/bound.h>
@@ -48,6 +50,8 @@
 static int __g_total_submitted;
 static int __g_peak_submitted;
 static int __g_peak_ready;
+static int __g_deadline_met;
+static int __g_deadline_missed;
 
 /* global counter variables */
 starpu_perf_counter_int64_t _starpu_task__g_total_submitted__value;
@@ -55,10 +59,13 @@ starpu_perf_counter_int64_t _starpu_task__g_peak_submitted__value;
 starpu_perf_counter_int64_t _starpu_task__g_current_submitted__value;
 starpu_perf_counter_int64_t _starpu_task__g_peak_ready__value;
 starpu_perf_counter_int64_t _starpu_task__g_current_ready__value;
+starpu_perf_counter_int64_t _starpu_task__g_deadline_met__value;
+starpu_perf_counter_int64_t _starpu_task__g_deadline_missed__value;
 
 /* per-worker counters */
 static int __w_total_executed;
 static int __w_cumul_execution_time;
+static int __w_deadline_missed;
 
 /* per-codelet counters */
 static int __c_total_submitted;
@@ -89,6 +96,8 @@ static void global_sample_updater(struct starpu_perf_counter_sample *sample, voi
 	_starpu_perf_counter_sample_set_int64_value(sample, __g_total_submitted, _starpu_task__g_total_submitted__value);
 	_starpu_perf_counter_sample_set_int64_value(sample, __g_peak_submitted, _starpu_task__g_peak_submitted__value);
 	_starpu_perf_counter_sample_set_int64_value(sample, __g_peak_ready, _starpu_task__g_peak_ready__value);
+	_starpu_perf_counter_sample_set_int64_value(sample, __g_deadline_met, _starpu_task__g_deadline_met__value);
+	_starpu_perf_counter_sample_set_int64_value(sample, __g_deadline_missed, _starpu_task__g_deadline_missed__value);
 }
 
 static void per_worker_sample_updater(struct starpu_perf_counter_sample *sample, void *context)
@@ -98,6 +107,7 @@ static void per_worker_sample_updater(struct starpu_perf_counter_sample *sample,
 
 	_starpu_perf_counter_sample_set_int64_value(sample, __w_total_executed, worker->__w_total_executed__value);
 	_starpu_perf_counter_sample_set_double_value(sample, __w_cumul_execution_time, worker->__w_cumul_execution_time__value);
+	_starpu_perf_counter_sample_set_int64_value(sample, __w_deadline_missed, worker->__w_deadline_missed__value);
 }
 
 static void per_codelet_sample_updater(struct starpu_perf_counter_sample *sample, void *context)
@@ -122,6 +132,8 @@ void _starpu__task_c__register_counters(void)
 		__STARPU_PERF_COUNTER_REG("starpu.task", scope, g_total_submitted, int64, "number of tasks submitted globally (since StarPU initialization)");
 		__STARPU_PERF_COUNTER_REG("starpu.task", scope, g_peak_submitted, int64, "maximum simultaneous number of tasks submitted and not yet ready, globally (since StarPU initialization)");
 		__STARPU_PERF_COUNTER_REG("starpu.task", scope, g_peak_ready, int64, "maximum simultaneous number of tasks ready and not yet executing, globally (since StarPU initialization)");
+		__STARPU_PERF_COUNTER_REG("starpu.task", scope, g_deadline_met, int64, "number of tasks with a deadline which completed in time, globally (since StarPU initialization)");
+		__STARPU_PERF_COUNTER_REG("starpu.task", scope, g_deadline_missed, int64, "number of tasks with a deadline which completed after it, globally (since StarPU initialization)");
 
 		_starpu_perf_counter_register_updater(scope, global_sample_updater);
 	}
@@ -130,6 +142,7 @@ void _starpu__task_c__register_counters(void)
 		const enum starpu_perf_counter_scope scope = starpu_perf_counter_scope_per_worker;
 		__STARPU_PERF_COUNTER_REG("starpu.task", scope, w_total_executed, int64, "number of tasks executed on this worker (since StarPU initialization)");
 		__STARPU_PERF_COUNTER_REG("starpu.task", scope, w_cumul_execution_time, double, "cumulated execution time of tasks executed on this worker (microseconds, since StarPU initialization)");
+		__STARPU_PERF_COUNTER_REG("starpu.task", scope, w_deadline_missed, int64, "number of tasks executed on this worker which completed after their deadline (since StarPU initialization)");
 
 		_starpu_perf_counter_register_updater(scope, per_worker_sample_updater);
 	}
@@ -260,6 +273,9 @@ void _starpu_task_init(void)
 	limit_max_submitted_tasks = starpu_getenv_number("STARPU_LIMIT_MAX_SUBMITTED_TASKS");
 	watchdog_crash = starpu_getenv_number_default("STARPU_WATCHDOG_CRASH", 0);
 	watchdog_delay = starpu_getenv_number_default("STARPU_WATCHDOG_DELAY", 0);
+#ifdef STARPU_OPENMP
+	_starpu_task_yield_init();
+#endif
 }
 
 void _starpu_task_deinit(void)
@@ -310,6 +326,7 @@ void starpu_task_init(struct starpu_task *task)
 	task->sched_ctx = STARPU_NMAX_SCHED_CTXS;
 
 	task->flops = 0.0;
+	task->deadline = 0.0;
 }
 
 /* Free all the resources allocated for a task, without deallocating the task
@@ -558,6 +575,9 @@ int _starpu_submit_job(struct _starpu_job *j, int nodeps)
 	_STARPU_LOG_IN();
 	/* notify bound computation of a new task */
 	_starpu_bound_record(j);
+	/* and critical path and lookahead computation */
+	if ((_starpu_graph_critical_path || _starpu_graph_lookahead) && !continuation)
+		_starpu_graph_submit_job(j);
 
 	_starpu_increment_nsubmitted_tasks_of_sched_ctx(j->task->sched_ctx);
 	_starpu_sched_task_submit(task);
@@ -964,6 +984,24 @@ int _starpu_task_submit(struct starpu_task *task, int nodeps)
 			task->priority = __s_min_priority_cap__value;
 	}
 
+	/* internally, StarPU manipulates a struct _starpu_job * which is a wrapper around a
+	* task structure, it is possible that this job structure was already
+	* allocated. */
+	struct _starpu_job *j = _starpu_get_job_associated_to_task(task);
+	const unsigned continuation =
+#ifdef STARPU_OPENMP
+		j->continuation
+#else
+		0
+#endif
+		;
+	STARPU_ASSERT_MSG(!(nodeps && continuation), "not supported\n");
+
+	if (STARPU_UNLIKELY(_starpu_task_capturing) && !nodeps && !j->internal && !continuation
+	    && _starpu_task_capture_is_current())
+		/* Only record it, it will be submitted by starpu_task_graph_launch() */
+		return _starpu_task_capture_record(task);
+
 	if (task->transaction != NULL)
 	{
 		/* If task is part of a transaction, add its handle to the task
@@ -981,17 +1019,7 @@ int _starpu_task_submit(struct starpu_task *task, int nodeps)
 	unsigned is_sync = task->synchronous;
 	starpu_task_bundle_t bundle = task->bundle;
 	STARPU_ASSERT_MSG(!(nodeps && bundle), "not supported\n");
-	/* internally, StarPU manipulates a struct _starpu_job * which is a wrapper around a
-	* task structure, it is possible that this job structure was already
-	* allocated. */
-	struct _starpu_job *j = _starpu_get_job_associated_to_task(task);
-	const unsigned continuation =
-#ifdef STARPU_OPENMP
-		j->continuation
-#else
-		0
-#endif
-		;
+
 	if (!_starpu_perf_counter_paused() && !j->internal && !continuation)
 	{
 		(void) STARPU_PERF_COUNTER_ADD64(&_starpu_task__g_total_submitted__value, 1);
@@ -1009,7 +1037,6 @@ int _starpu_task_submit(struct starpu_task *task, int nodeps)
 			_starpu_perf_counter_update_per_codelet_sample(task->cl);
 		}
 	}
-	STARPU_ASSERT_MSG(!(nodeps && continuation), "not supported\n");
 
 	if (!j->internal && limit_max_submitted_tasks >= 0 && limit_min_submitted_tasks >= 0)
 	{
@@ -1025,8 +1052,9 @@ int _starpu_task_submit(struct starpu_task *task, int nodeps)
 	}
 
 	_STARPU_TRACE_TASK_SUBMIT_START();
+	_STARPU_OVERHEAD_START(overhead_start);
 
-	if (task->cl && !continuation)
+	if (task->cl && !continuation && !j->captured)
 	{
 		_starpu_job_set_ordered_buffers(j);
 	}
@@ -1037,6 +1065,7 @@ int _starpu_task_submit(struct starpu_task *task, int nodeps)
 		_STARPU_TRACE_TASK_SUBMIT_END();
 		return ret;
 	}
+	_STARPU_OVERHEAD_END(_STARPU_OVERHEAD_SUBMIT, overhead_start);
 
 	if (!continuation)
 	{
@@ -1053,13 +1082,15 @@ int _starpu_task_submit(struct starpu_task *task, int nodeps)
 	}
 
 	/* If this is a continuation, we don't modify the implicit data dependencies detected earlier. */
-	if (task->cl && !continuation && !nodeps
+	if (task->cl && !continuation && !nodeps && !j->captured
 #ifdef STARPU_BUBBLE
 	    && !j->is_bubble
 #endif
 		)
 	{
-	    _starpu_detect_implicit_data_deps(task);
+		_STARPU_OVERHEAD_START(overhead_deps_start);
+		_starpu_detect_implicit_data_deps(task);
+		_STARPU_OVERHEAD_END(_STARPU_OVERHEAD_IMPLICIT_DEPS, overhead_deps_start);
 	}
 
 	if (STARPU_UNLIKELY(bundle))
@@ -89,6 +89,11 @@ void _starpu_task_prepare_for_continuation(void);
 
 void _starpu_task_set_omp_cleanup_callback(struct starpu_task *task, void (*omp_cleanup_callback)(void *arg),
 		void *omp_cleanup_callback_arg);
+
+void _starpu_task_yield_init(void);
+/** Run the CPU function of a STARPU_CODELET_YIELDABLE codelet on its own
+ * stack, or resume it if it had yielded. */
+void _starpu_task_yieldable_exec(struct _starpu_job *j, _starpu_cl_func_t func);
 #endif
 
 int _starpu_task_uses_multiformat_handles(struct starpu_task *task);
@@ -0,0 +1,344 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+/*
+ * Task graph capture: the tasks submitted between
+ * starpu_task_graph_capture_begin() and starpu_task_graph_capture_end() are
+ * not submitted but only recorded. Their implicit data dependencies are
+ * computed once at capture time, and turned into explicit task dependencies,
+ * which persist across submissions. Launching the graph then merely
+ * resubmits the same tasks, without detecting implicit dependencies, sorting
+ * the data handles or creating jobs again.
+ */
+
+#include <starpu.h>
+#include <common/config.h>
+#include <common/utils.h>
+#include <common/uthash.h>
+#include <core/jobs.h>
+#include <core/task.h>
+#include <core/task_capture.h>
+#include <core/workers.h>
+#include <core/dependencies/data_concurrency.h>
+#include <datawizard/coherency.h>
+
+/* Sequential consistency state of a data during capture */
+struct _starpu_task_graph_handle
+{
+	UT_hash_handle hh;
+	starpu_data_handle_t handle;
+	/* Index of the last task which wrote to the data, or -1 */
+	int last_writer;
+	/* Indexes of the tasks which read the data since then */
+	unsigned *readers;
+	unsigned nreaders;
+	unsigned alloc_readers;
+};
+
+int _starpu_task_capturing;
+static struct _starpu_task_graph *capture_graph;
+static starpu_pthread_t capture_thread;
+
+int _starpu_task_capture_is_current(void)
+{
+	return capture_graph && starpu_pthread_equal(capture_thread, starpu_pthread_self());
+}
+
+void starpu_task_graph_capture_begin(void)
+{
+	STARPU_ASSERT_MSG(!capture_graph, "only one task graph can be captured at a time");
+
+	_STARPU_CALLOC(capture_graph, 1, sizeof(*capture_graph));
+	capture_thread = starpu_pthread_self();
+	_starpu_task_capturing = 1;
+}
+
+/* Make task n depend on task pred */
+static void capture_add_dep(struct _starpu_task_graph *graph, unsigned n, unsigned pred)
+{
+	unsigned i;
+
+	if (pred == n)
+		/* The task accesses the data several times */
+		return;
+
+	for (i = 0; i < graph->ndeps[n]; i++)
+		if (graph->deps[n][i] == pred)
+			return;
+
+	if (graph->ndeps[n] == graph->alloc_deps[n])
+	{
+		graph->alloc_deps[n] = graph->alloc_deps[n] ? 2 * graph->alloc_deps[n] : 4;
+		_STARPU_REALLOC(graph->deps[n], graph->alloc_deps[n] * sizeof(graph->deps[n][0]));
+	}
+	graph->deps[n][graph->ndeps[n]++] = pred;
+	graph->has_succ[pred] = 1;
+}
+
+/* Same rules as _starpu_detect_implicit_data_deps_with_handle: writers depend
+ * on the previous readers if any, otherwise on the previous writer, and
+ * readers depend on the previous writer */
+static void capture_access(struct _starpu_task_graph *graph, unsigned n, starpu_data_handle_t handle, enum starpu_data_access_mode mode)
+{
+	struct _starpu_task_graph_handle *h;
+	unsigned i;
+
+	HASH_FIND_PTR(graph->handles, &handle, h);
+	if (!h)
+	{
+		_STARPU_CALLOC(h, 1, sizeof(*h));
+		h->handle = handle;
+		h->last_writer = -1;
+		HASH_ADD_PTR(graph->handles, handle, h);
+	}
+
+	if (mode & STARPU_W)
+	{
+		if (h->nreaders)
+			for (i = 0; i < h->nreaders; i++)
+				capture_add_dep(graph, n, h->readers[i]);
+		else if (h->last_writer != -1)
+			capture_add_dep(graph, n, h->last_writer);
+		h->last_writer = n;
+		h->nreaders = 0;
+	}
+	else
+	{
+		if (h->last_writer != -1)
+			capture_add_dep(graph, n, h->last_writer);
+		if (h->nreaders == h->alloc_readers)
+		{
+			h->alloc_readers = h->alloc_readers ? 2 * h->alloc_readers : 4;
+			_STARPU_REALLOC(h->readers, h->alloc_readers * sizeof(h->readers[0]));
+		}
+		h->readers[h->nreaders++] = n;
+	}
+}
+
+int _starpu_task_capture_record(struct starpu_task *task)
+{
+	struct _starpu_task_graph *graph = capture_graph;
+	struct _starpu_job *j = _starpu_get_job_associated_to_task(task);
+	unsigned n = graph->ntasks;
+
+	STARPU_ASSERT_MSG(!task->synchronous, "synchronous tasks can not be captured in a task graph");
+	STARPU_ASSERT_MSG(!task->regenerate, "regenerated tasks can not be captured in a task graph");
+	STARPU_ASSERT_MSG(!task->use_tag, "tasks with tags can not be captured in a task graph");
+	STARPU_ASSERT_MSG(!task->bundle, "tasks in a bundle can not be captured in a task graph");
+	STARPU_ASSERT_MSG(!task->transaction, "tasks of a transaction can not be captured in a task graph");
+	STARPU_ASSERT_MSG(!j->captured, "a task can not be captured twice");
+
+	if (task->cl)
+	{
+		_starpu_codelet_check_deprecated_fields(task->cl);
+		if (task->where == -1)
+			task->where = task->cl->where;
+		if (STARPU_UNLIKELY(!_starpu_worker_exists(task)))
+			return -ENODEV;
+
+		/* Done once for all launches */
+		_starpu_job_set_ordered_buffers(j);
+	}
+
+	if (n == graph->alloc_tasks)
+	{
+		graph->alloc_tasks = graph->alloc_tasks ? 2 * graph->alloc_tasks : 16;
+		_STARPU_REALLOC(graph->tasks, graph->alloc_tasks * sizeof(graph->tasks[0]));
+		_STARPU_REALLOC(graph->deps, graph->alloc_tasks * sizeof(graph->deps[0]));
+		_STARPU_REALLOC(graph->ndeps, graph->alloc_tasks * sizeof(graph->ndeps[0]));
+		_STARPU_REALLOC(graph->alloc_deps, graph->alloc_tasks * sizeof(graph->alloc_deps[0]));
+		_STARPU_REALLOC(graph->has_succ, graph->alloc_tasks * sizeof(graph->has_succ[0]));
+		_STARPU_REALLOC(graph->destroy, graph->alloc_tasks * sizeof(graph->destroy[0]));
+	}
+	graph->tasks[n] = task;
+	graph->deps[n] = NULL;
+	graph->ndeps[n] = 0;
+	graph->alloc_deps[n] = 0;
+	graph->has_succ[n] = 0;
+	/* The task has to survive its executions */
+	graph->destroy[n] = task->destroy;
+	task->destroy = 0;
+	graph->ntasks++;
+
+	if (task->cl && task->sequential_consistency)
+	{
+		unsigned nbuffers = STARPU_TASK_GET_NBUFFERS(task);
+		unsigned i;
+
+		for (i = 0; i < nbuffers; i++)
+		{
+			starpu_data_handle_t handle = _STARPU_JOB_GET_ORDERED_BUFFER_HANDLE(j, i);
+			enum starpu_data_access_mode mode = _STARPU_JOB_GET_ORDERED_BUFFER_MODE(j, i);
+			unsigned index = _STARPU_JOB_GET_ORDERED_BUFFER_INDEX(j, i);
+			unsigned sequential_consistency = task->handles_sequential_consistency ? task->handles_sequential_consistency[index] : handle->sequential_consistency;
+
+			/* Scratch memory does not introduce any deps */
+			if (mode & STARPU_SCRATCH)
+				continue;
+			STARPU_ASSERT_MSG(!(mode & STARPU_REDUX), "reductions are not supported in captured task graphs");
+			STARPU_ASSERT_MSG(!((handle->nplans && !handle->nchildren) || handle->siblings), "asynchronous partitioning is not supported in captured task graphs");
+			if (!sequential_consistency)
+				continue;
+
+			capture_access(graph, n, handle, mode);
+		}
+	}
+
+	return 0;
+}
+
+starpu_task_graph_t starpu_task_graph_capture_end(void)
+{
+	struct _starpu_task_graph *graph = capture_graph;
+	struct _starpu_task_graph_handle *h, *htmp;
+	struct starpu_task **sinks;
+	unsigned i, j, nsinks = 0;
+
+	STARPU_ASSERT_MSG(_starpu_task_capture_is_current(), "starpu_task_graph_capture_end must be called by the thread which called starpu_task_graph_capture_begin");
+	capture_graph = NULL;
+	_starpu_task_capturing = 0;
+
+	HASH_ITER(hh, graph->handles, h, htmp)
+	{
+		HASH_DEL(graph->handles, h);
+		free(h->readers);
+		free(h);
+	}
+
+	/* Turn data dependencies into explicit task dependencies */
+	for (i = 0; i < graph->ntasks; i++)
+	{
+		struct starpu_task *task = graph->tasks[i];
+
+		if (graph->ndeps[i])
+		{
+			struct starpu_task *deps[graph->ndeps[i]];
+			for (j = 0; j < graph->ndeps[i]; j++)
+				deps[j] = graph->tasks[graph->deps[i][j]];
+			_starpu_task_declare_deps_array(task, graph->ndeps[i], deps, 1);
+		}
+		free(graph->deps[i]);
+		_starpu_get_job_associated_to_task(task)->captured = 1;
+	}
+	free(graph->deps);
+	free(graph->ndeps);
+	free(graph->alloc_deps);
+	graph->deps = NULL;
+	graph->ndeps = NULL;
+	graph->alloc_deps = NULL;
+
+	/* And let the end task depend on all sinks */
+	graph->end_task = starpu_task_create();
+	graph->end_task->name = "task_graph_end";
+	graph->end_task->detach = 0;
+	graph->end_task->destroy = 0;
+	_starpu_exclude_task_from_dag(graph->end_task);
+
+	_STARPU_MALLOC(sinks, (graph->ntasks ? graph->ntasks : 1) * sizeof(*sinks));
+	for (i = 0; i < graph->ntasks; i++)
+		if (!graph->has_succ[i])
+			sinks[nsinks++] = graph->tasks[i];
+	_starpu_task_declare_deps_array(graph->end_task, nsinks, sinks, 1);
+	free(sinks);
+	free(graph->has_succ);
+	graph->has_succ = NULL;
+
+	return graph;
+}
+
+int starpu_task_graph_launch(starpu_task_graph_t graph)
+{
+	unsigned i;
+	int ret;
+
+	STARPU_ASSERT_MSG(!_starpu_task_capture_is_current(), "a task graph can not be launched while capturing");
+
+	/* The tasks can not be submitted again before being terminated */
+	if (graph->launched)
+		starpu_task_graph_wait(graph);
+
+	for (i = 0; i < graph->ntasks; i++)
+	{
+		ret = starpu_task_submit(graph->tasks[i]);
+		if (STARPU_UNLIKELY(ret))
+			return ret;
+	}
+
+	ret = starpu_task_submit(graph->end_task);
+	STARPU_ASSERT(!ret);
+	graph->launched = 1;
+
+	return 0;
+}
+
+int starpu_task_graph_wait(starpu_task_graph_t graph)
+{
+	unsigned i;
+	int ret;
+
+	if (!graph->launched)
+		return 0;
+
+	ret = starpu_task_wait(graph->end_task);
+
+	/* The end task may have been terminated while the drivers are still
+	 * notifying dependencies of the sinks, wait for them to be completely
+	 * done with the tasks before they can be resubmitted or destroyed */
+	for (i = 0; i < graph->ntasks; i++)
+	{
+		struct _starpu_job *j = _starpu_get_job_associated_to_task(graph->tasks[i]);
+
+		STARPU_PTHREAD_MUTEX_LOCK(&j->sync_mutex);
+		while (j->terminated != 2)
+			STARPU_PTHREAD_COND_WAIT(&j->sync_cond, &j->sync_mutex);
+		STARPU_PTHREAD_MUTEX_UNLOCK(&j->sync_mutex);
+	}
+
+	graph->launched = 0;
+	return ret;
+}
+
+unsigned starpu_task_graph_get_ntasks(starpu_task_graph_t graph)
+{
+	return graph->ntasks;
+}
+
+struct starpu_task *starpu_task_graph_get_task(starpu_task_graph_t graph, unsigned i)
+{
+	STARPU_ASSERT(i < graph->ntasks);
+	return graph->tasks[i];
+}
+
+void starpu_task_graph_destroy(starpu_task_graph_t graph)
+{
+	unsigned i;
+
+	starpu_task_graph_wait(graph);
+
+	for (i = 0; i < graph->ntasks; i++)
+	{
+		struct starpu_task *task = graph->tasks[i];
+
+		_starpu_get_job_associated_to_task(task)->captured = 0;
+		if (graph->destroy[i])
+			_starpu_task_destroy(task);
+	}
+	_starpu_task_destroy(graph->end_task);
+
+	free(graph->tasks);
+	free(graph->destroy);
+	free(graph);
+}
@@ -0,0 +1,75 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#ifndef __CORE_TASK_CAPTURE_H__
+#define __CORE_TASK_CAPTURE_H__
+
+/** @file */
+
+#include <starpu.h>
+#include <common/config.h>
+
+#pragma GCC visibility push(hidden)
+
+struct _starpu_task_graph_handle;
+
+/** A task graph captured between starpu_task_graph_capture_begin() and
+ * starpu_task_graph_capture_end(), which can then be launched several times
+ * without going through dependency detection again. */
+struct _starpu_task_graph
+{
+	/** Captured tasks, in submission order */
+	struct starpu_task **tasks;
+	unsigned ntasks;
+	unsigned alloc_tasks;
+
+	/** For each task, the indexes of the tasks it depends on through data
+	 * accesses, only used during capture */
+	unsigned **deps;
+	unsigned *ndeps;
+	unsigned *alloc_deps;
+
+	/** For each task, whether some captured task depends on it */
+	char *has_succ;
+
+	/** For each task, whether it was to be destroyed automatically, in
+	 * which case it will be destroyed along the graph */
+	char *destroy;
+
+	/** Sequential consistency state of each data accessed during capture */
+	struct _starpu_task_graph_handle *handles;
+
+	/** Empty task which depends on all the sinks of the graph, to wait
+	 * for the termination of a launch */
+	struct starpu_task *end_task;
+
+	/** Whether a launch is in progress */
+	unsigned launched;
+};
+
+/** Number of captures in progress, to quickly skip the capture test */
+extern int _starpu_task_capturing;
+
+/** Whether tasks submitted by the current thread should be captured instead
+ * of being submitted */
+int _starpu_task_capture_is_current(void);
+
+/** Record the submission of \p task in the current capture */
+int _starpu_task_capture_record(struct starpu_task *task);
+
+#pragma GCC visibility pop
+
+#endif // __CORE_TASK_CAPTURE_H__
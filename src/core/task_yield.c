@@ -0,0 +1,223 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+/*
+ * Cooperative task yielding: the CPU functions of codelets with the
+ * STARPU_CODELET_YIELDABLE flag run on their own stack, so that they can give
+ * their worker back to StarPU while they wait for something. The task then
+ * becomes a continuation, like the OpenMP tasks do when they block: it keeps
+ * its data, gets new dependencies, and is pushed to the scheduler again once
+ * they are fulfilled, to resume where it stopped, on any CPU worker.
+ */
+
+#include <starpu.h>
+#include <common/config.h>
+#include <common/utils.h>
+#include <core/jobs.h>
+#include <core/task.h>
+
+#ifdef STARPU_OPENMP
+#include <ucontext.h>
+
+struct _starpu_task_yield_ctx
+{
+	/** Context of the codelet function, running on its own stack */
+	ucontext_t ctx;
+	/** Context of the worker which (re)started the codelet function */
+	ucontext_t worker_ctx;
+	void *stack;
+	int stack_vg_id;
+	_starpu_cl_func_t func;
+	/** Where the task could run before it yielded */
+	int32_t where;
+	/** Whether the codelet function gave the hand back before terminating */
+	unsigned yielded;
+};
+
+static size_t stacksize;
+
+/* Dummy codelet for waiting for a piece of data */
+static struct starpu_codelet yield_data_cl =
+{
+	.where = STARPU_NOWHERE,
+	.nbuffers = STARPU_VARIABLE_NBUFFERS,
+	.flags = STARPU_CODELET_NOPLANS,
+	.name = "yield_until_data",
+};
+
+void _starpu_task_yield_init(void)
+{
+	stacksize = starpu_getenv_size_default("STARPU_TASK_YIELD_STACKSIZE", 2*1024*1024);
+}
+
+static void yieldable_entry(struct _starpu_job *j)
+{
+	struct _starpu_task_yield_ctx *yield_ctx = j->yield_ctx;
+
+	yield_ctx->func(_STARPU_TASK_GET_INTERFACES(j->task), j->task->cl_arg);
+
+	/* Terminated, go back to the worker which resumed us last */
+	setcontext(&yield_ctx->worker_ctx);
+	STARPU_ASSERT(0); /* unreachable code */
+}
+
+/* Kept apart from _starpu_task_yieldable_exec, so that getcontext does not
+ * make the compiler fear for its variables */
+static void __attribute__ ((noinline)) yield_ctx_create(struct _starpu_job *j, _starpu_cl_func_t func)
+{
+	struct _starpu_task_yield_ctx *yield_ctx;
+
+	_STARPU_CALLOC(yield_ctx, 1, sizeof(*yield_ctx));
+	_STARPU_MALLOC(yield_ctx->stack, stacksize);
+	getcontext(&yield_ctx->ctx);
+	yield_ctx->ctx.uc_link = NULL;
+	yield_ctx->ctx.uc_stack.ss_sp = yield_ctx->stack;
+	yield_ctx->ctx.uc_stack.ss_size = stacksize;
+	yield_ctx->stack_vg_id = VALGRIND_STACK_REGISTER(yield_ctx->stack, (char *) yield_ctx->stack + stacksize);
+	yield_ctx->func = func;
+	j->yield_ctx = yield_ctx;
+	makecontext(&yield_ctx->ctx, (void (*) ()) yieldable_entry, 1, j);
+}
+
+void _starpu_task_yieldable_exec(struct _starpu_job *j, _starpu_cl_func_t func)
+{
+	struct _starpu_task_yield_ctx *yield_ctx;
+
+	if (!j->yield_ctx)
+		yield_ctx_create(j, func);
+	yield_ctx = j->yield_ctx;
+
+	/* Start the codelet function, or resume it where it yielded */
+	swapcontext(&yield_ctx->worker_ctx, &yield_ctx->ctx);
+	/* Back on the worker stack */
+
+	if (!yield_ctx->yielded)
+	{
+		VALGRIND_STACK_DEREGISTER(yield_ctx->stack_vg_id);
+		free(yield_ctx->stack);
+		free(yield_ctx);
+		j->yield_ctx = NULL;
+	}
+}
+
+/* Get the job of the calling yieldable codelet */
+static int yield_get_job(struct _starpu_job **pj)
+{
+	struct starpu_task *task = starpu_task_get_current();
+	struct _starpu_job *j;
+
+	if (!task)
+		return -EINVAL;
+	j = _starpu_get_job_associated_to_task(task);
+	if (!j->yield_ctx || j->task_size > 1)
+		return -EINVAL;
+	*pj = j;
+	return 0;
+}
+
+/* The task was prepared for continuation, give the worker back */
+static void yield_to_worker(struct _starpu_job *j)
+{
+	struct _starpu_task_yield_ctx *yield_ctx = j->yield_ctx;
+	struct starpu_task *task = j->task;
+
+	/* Only CPU workers can resume us */
+	yield_ctx->where = task->where;
+	task->where &= STARPU_CPU;
+
+	yield_ctx->yielded = 1;
+	swapcontext(&yield_ctx->ctx, &yield_ctx->worker_ctx);
+	/* Resumed, possibly by another worker */
+	yield_ctx->yielded = 0;
+
+	task->where = yield_ctx->where;
+}
+
+int starpu_task_yield(void)
+{
+	struct _starpu_job *j;
+	int ret = yield_get_job(&j);
+	if (ret)
+		return ret;
+
+	/* Get pushed to the scheduler again right away */
+	_starpu_job_prepare_for_continuation(j);
+	yield_to_worker(j);
+	return 0;
+}
+
+int starpu_task_yield_until(unsigned ndeps, struct starpu_task *task_array[])
+{
+	struct _starpu_job *j;
+	int ret = yield_get_job(&j);
+	if (ret)
+		return ret;
+
+	_starpu_job_prepare_for_continuation(j);
+	starpu_task_declare_deps_array(j->task, ndeps, task_array);
+	yield_to_worker(j);
+	return 0;
+}
+
+int starpu_task_yield_until_data(starpu_data_handle_t handle, enum starpu_data_access_mode mode)
+{
+	struct _starpu_job *j;
+	struct starpu_task *sync_task;
+	int ret = yield_get_job(&j);
+	if (ret)
+		return ret;
+
+	/* This empty task will get the implicit data dependencies */
+	sync_task = starpu_task_create();
+	sync_task->cl = &yield_data_cl;
+	sync_task->nbuffers = 1;
+	sync_task->handles[0] = handle;
+	sync_task->modes[0] = mode;
+
+	_starpu_job_prepare_for_continuation(j);
+	/* Declare the dependency before submitting, sync_task may be
+	 * destroyed as soon as it is submitted */
+	starpu_task_declare_deps_array(j->task, 1, &sync_task);
+	ret = _starpu_task_submit_internally(sync_task);
+	STARPU_ASSERT(!ret);
+	yield_to_worker(j);
+	return 0;
+}
+
+#else /* STARPU_OPENMP */
+
+/* No user-level contexts available */
+
+int starpu_task_yield(void)
+{
+	return -ENOSYS;
+}
+
+int starpu_task_yield_until(unsigned ndeps, struct starpu_task *task_array[])
+{
+	(void) ndeps;
+	(void) task_array;
+	return -ENOSYS;
+}
+
+int starpu_task_yield_until_data(starpu_data_handle_t handle, enum starpu_data_access_mode mode)
+{
+	(void) handle;
+	(void) mode;
+	return -ENOSYS;
+}
+
+#endif /* STARPU_OPENMP */
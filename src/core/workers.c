@@ -820,6 +820,12 @@ void _starpu_worker_init(struct _starpu_worker *workerarg, struct _starpu_machin
 	/* memory_node initialized by topology.c */
 	STARPU_PTHREAD_COND_INIT(&workerarg->sched_cond, NULL);
 	STARPU_PTHREAD_MUTEX_INIT(&workerarg->sched_mutex, NULL);
+	workerarg->park_token = 0;
+	workerarg->state_parked = 0;
+	workerarg->park_latency = 0.;
+	workerarg->idle_start = 0.;
+	workerarg->idle_expected = 0.;
+	memset(workerarg->idle_time, 0, sizeof(workerarg->idle_time));
 	starpu_task_prio_list_init(&workerarg->local_tasks);
 	_starpu_ctx_change_list_init(&workerarg->ctx_change_list);
 	workerarg->local_ordered_tasks = NULL;
@@ -841,6 +847,12 @@ void _starpu_worker_init(struct _starpu_worker *workerarg, struct _starpu_machin
 	/* set initialized by topology.c */
 	workerarg->pipeline_length = 0;
 	workerarg->pipeline_stuck = 0;
+	starpu_task_list_init(&workerarg->lookahead_tasks);
+	workerarg->nlookahead = 0;
+	/* set by the CPU driver */
+	workerarg->lookahead_length = 0;
+	workerarg->successor_continuation = 0;
+	workerarg->quiescent_epoch = 0;
 	workerarg->worker_is_running = 0;
 	workerarg->worker_is_initialized = 0;
 	workerarg->wait_for_worker_initialization = 0;
@@ -894,6 +906,10 @@ void _starpu_worker_init(struct _starpu_worker *workerarg, struct _starpu_machin
 	workerarg->state_unblock_in_parallel_ack = 0;
 	workerarg->block_in_parallel_ref_count = 0;
 	_starpu_perf_counter_sample_init(&workerarg->perf_counter_sample, starpu_perf_counter_scope_per_worker);
+#ifdef STARPU_OVERHEAD_BREAKDOWN
+	memset(workerarg->overhead_stats, 0, sizeof(workerarg->overhead_stats));
+	workerarg->overhead_fetch_ticks = 0;
+#endif
 	workerarg->enable_knob = 1;
 	workerarg->bindid_requested = -1;
 
@@ -1868,6 +1884,9 @@ int starpu_initialize(struct starpu_conf *user_conf, int *argc, char ***argv)
 	check_entire_platform = 1;//starpu_getenv_number("STARPU_CHECK_ENTIRE_PLATFORM");
 
 	_starpu_config.disable_kernels = starpu_getenv_number("STARPU_DISABLE_KERNELS");
+	_starpu_config.worker_parking = starpu_getenv_number_default("STARPU_WORKER_PARKING", 1);
+	_starpu_config.worker_park_spin_max = starpu_getenv_number_default("STARPU_WORKER_PARK_SPIN_MAX", 100);
+	_starpu_config.worker_idle_latency = starpu_getenv_float_default("STARPU_WORKER_IDLE_LATENCY", 0.5);
 	STARPU_PTHREAD_KEY_CREATE(&_starpu_worker_key, NULL);
 	STARPU_PTHREAD_KEY_CREATE(&_starpu_worker_set_key, NULL);
 	_starpu_keys_initialized = 1;
@@ -1882,6 +1901,9 @@ int starpu_initialize(struct starpu_conf *user_conf, int *argc, char ***argv)
 	}
 
 	_starpu_initialize_registered_performance_models();
+#ifdef STARPU_OVERHEAD_BREAKDOWN
+	_starpu_overhead_init();
+#endif
 	_starpu_perf_counter_init(&_starpu_config);
 	_starpu_perf_knob_init();
 
@@ -2003,6 +2025,7 @@ static void _starpu_terminate_workers(struct _starpu_machine_config *pconfig)
 
 out:
 		STARPU_ASSERT(starpu_task_prio_list_empty(&worker->local_tasks));
+		STARPU_ASSERT(starpu_task_list_empty(&worker->lookahead_tasks));
 		for (n = 0; n < worker->local_ordered_tasks_size; n++)
 			STARPU_ASSERT(worker->local_ordered_tasks[n] == NULL);
 		_starpu_sched_ctx_list_delete(&worker->sched_ctx_list);
@@ -2177,6 +2200,7 @@ void starpu_shutdown(void)
 
 	starpu_profiling_bus_helper_display_summary();
 	starpu_profiling_worker_helper_display_summary();
+	_starpu_graph_critical_path_display_stats();
 	starpu_bound_clear();
 
 	_starpu_deinitialize_registered_performance_models();
@@ -2186,6 +2210,10 @@ void starpu_shutdown(void)
 	/* wait for their termination */
 	_starpu_terminate_workers(&_starpu_config);
 
+#ifdef STARPU_OVERHEAD_BREAKDOWN
+	_starpu_overhead_display_stats(stderr);
+#endif
+
 	{
 	     int stats = starpu_getenv_number("STARPU_MEMORY_STATS");
 	     if (stats != 0)
@@ -2761,6 +2789,7 @@ static int starpu_wakeup_worker_locked(int workerid, starpu_pthread_cond_t *sche
 		/* cond_broadcast is required over cond_signal since
 		 * the condition is share for multiple purpose */
 		STARPU_PTHREAD_COND_BROADCAST(sched_cond);
+		_starpu_worker_unpark(&_starpu_config.workers[workerid]);
 		return ret;
 	}
 	else if (_starpu_config.workers[workerid].status & STATUS_SCHEDULING)
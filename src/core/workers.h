@@ -42,6 +42,7 @@
 #include <hwloc.h>
 #endif
 #include <common/knobs.h>
+#include <profiling/overhead.h>
 
 #include <core/drivers.h>
 #include <drivers/cuda/driver_cuda.h>
@@ -150,6 +151,15 @@ struct _starpu_node
 	char padding[STARPU_CACHELINE_SIZE];
 };
 
+/** What an idle worker does while waiting for a task */
+enum _starpu_worker_idle_phase
+{
+	IDLE_PHASE_SPINNING = 0,
+	IDLE_PHASE_YIELDING,
+	IDLE_PHASE_PARKED,
+	IDLE_PHASE_NR,
+};
+
 struct _starpu_ctx_change_list;
 /** This is initialized by _starpu_worker_init() */
 LIST_TYPE(_starpu_worker,
@@ -171,12 +181,22 @@ LIST_TYPE(_starpu_worker,
 	starpu_pthread_cond_t ready_cond; /**< indicate when the worker is ready */
 	unsigned memory_node; /**< which memory node is the worker associated with ? */
 	unsigned numa_memory_node; /**< which numa memory node is the worker associated with? (logical index) */
+
+	/** Separate the fields above, which are mostly read, by other threads
+	 * too, from the scheduling state below, which is often modified by
+	 * other threads. */
+	char padding_ro[STARPU_CACHELINE_SIZE];
+
 	  /**
 	   * condition variable used for passive waiting operations on worker
 	   * STARPU_PTHREAD_COND_BROADCAST must be used instead of STARPU_PTHREAD_COND_SIGNAL,
 	   * since the condition is shared for multiple purpose */
 	starpu_pthread_cond_t sched_cond;
 	starpu_pthread_mutex_t sched_mutex; /**< mutex protecting sched_cond */
+	unsigned state_keep_awake; /**< !0 if a task has been pushed to the worker and the task has not yet been seen by the worker, the worker should no go to sleep before processing this task*/
+	unsigned park_token; /**< futex word the worker sleeps on when parked, incremented to wake it up */
+	unsigned state_parked; /**< 1 if the worker is parked and spinning on park_token, 2 if it is blocked on it */
+	double park_wake_date; /**< date at which the parked worker was last woken up */
 	unsigned state_relax_refcnt; /**< mark scheduling sections where other workers can safely access the worker state */
 #ifdef STARPU_SPINLOCK_CHECK
 	const char *relax_on_file;
@@ -223,6 +243,10 @@ LIST_TYPE(_starpu_worker,
 	starpu_pthread_wait_t wait;
 #endif
 
+	/** Separate the scheduling state above from the fields below, which
+	 * are mostly used by the worker itself. */
+	char padding_sched[STARPU_CACHELINE_SIZE];
+
 	struct timespec cl_start; /**< Codelet start time of the task currently running */
 	struct timespec cl_expend; /**< Codelet expected end time of the task currently running */
 	struct timespec cl_end; /**< Codelet end time of the last task running */
@@ -230,13 +254,23 @@ LIST_TYPE(_starpu_worker,
 	unsigned char ntasks; /**< number of tasks in the pipeline */
 	unsigned char pipeline_length; /**< number of tasks to be put in the pipeline */
 	unsigned char pipeline_stuck; /**< whether a task prevents us from pipelining */
+	struct starpu_task_list lookahead_tasks; /**< tasks already popped by a CPU worker, whose input is being prefetched while it runs the current task */
+	unsigned nlookahead; /**< number of tasks in lookahead_tasks */
+	unsigned lookahead_length; /**< maximum number of tasks to keep in lookahead_tasks */
+	unsigned successor_continuation; /**< whether the next task made ready by the termination of the current task can be kept by this worker */
+	unsigned long quiescent_epoch; /**< incremented by 2 each time the worker goes through its scheduling loop, odd while it sleeps, see _starpu_worker_quiescent */
 	struct _starpu_worker_set *set; /**< in case this worker belongs to a worker set */
 	struct _starpu_worker_set *driver_worker_set; /**< in case this worker belongs to a driver worker set */
 	unsigned worker_is_running;
 	unsigned worker_is_initialized;
 	unsigned wait_for_worker_initialization;
 	enum _starpu_worker_status status; /**< what is the worker doing now ? (eg. CALLBACK) */
-	unsigned state_keep_awake; /**< !0 if a task has been pushed to the worker and the task has not yet been seen by the worker, the worker should no go to sleep before processing this task*/
+	double park_latency; /**< average time between waking up the parked worker and it actually running, in us */
+	double idle_start; /**< date at which the worker found no task to run, 0 if it is not idle */
+	double idle_expected; /**< average duration of the recent idle periods of the worker, in us */
+	double idle_date; /**< date at which the worker entered its current idle phase */
+	enum _starpu_worker_idle_phase idle_phase; /**< what the worker is currently doing while idle */
+	double idle_time[IDLE_PHASE_NR]; /**< time spent in each idle phase since the last profiling update, in us */
 	char name[128];
 	char short_name[32];
 	unsigned run_by_starpu; /**< Is this run by StarPU or directly by the application ? */
@@ -298,6 +332,16 @@ LIST_TYPE(_starpu_worker,
 	struct starpu_perf_counter_sample perf_counter_sample;
 	int64_t __w_total_executed__value;
 	double __w_cumul_execution_time__value;
+	int64_t __w_deadline_missed__value;
+
+#ifdef STARPU_OVERHEAD_BREAKDOWN
+	/** Runtime overhead measured on this worker, see profiling/overhead.c */
+	struct _starpu_overhead_stats overhead_stats[_STARPU_OVERHEAD_NPHASES];
+	/** Cycle counter when the current codelet was started */
+	uint64_t overhead_exec_start;
+	/** Cycles spent in asynchronous input fetches whose tail was not done yet */
+	uint64_t overhead_fetch_ticks;
+#endif
 
 	int enable_knob;
 	int bindid_requested;
@@ -500,6 +544,14 @@ struct _starpu_machine_config
 
 	int disable_kernels;
 
+	/** Whether idle workers park on a futex rather than on their sched_cond */
+	int worker_parking;
+	/** Maximum time idle workers wait actively before parking, in us */
+	unsigned worker_park_spin_max;
+	/** How much idle workers favor latency over power, from 0 (park right
+	 * away) to 1 (wait actively for twice the expected idle time) */
+	double worker_idle_latency;
+
 	/** Number of calls to starpu_pause() - calls to starpu_resume(). When >0,
 	 * StarPU should pause. */
 	int pause_depth;
@@ -793,6 +845,28 @@ void _starpu_worker_set_stream_ctx(unsigned workerid, struct _starpu_sched_ctx *
 
 struct _starpu_sched_ctx* _starpu_worker_get_ctx_stream(unsigned stream_workerid);
 
+/** Wake the worker up if it is parked waiting for work. This has to be called
+ * along the broadcast of sched_cond whenever something that a sleeping worker
+ * checks changes, since a parked worker does not wait on sched_cond.
+ *
+ * Must be called with worker's sched_mutex held.
+ */
+static inline void _starpu_worker_unpark(struct _starpu_worker * const worker)
+{
+#ifdef _STARPU_HAVE_FUTEX
+	if (!worker->state_parked)
+		return;
+	worker->park_wake_date = starpu_timing_now();
+	/* Full barrier, paired with the one in _starpu_worker_wait_for_work */
+	(void) STARPU_ATOMIC_ADD(&worker->park_token, 1);
+	if (worker->state_parked == 2)
+		/* Really blocked, it needs a syscall */
+		_starpu_futex_wakeup(&worker->park_token);
+#else
+	(void) worker;
+#endif
+}
+
 /** Send a request to the worker to block, before a parallel task is about to
  * begin.
  *
@@ -822,6 +896,7 @@ static inline void _starpu_worker_request_blocking_in_parallel(struct _starpu_wo
 		/* trigger the block_in_parallel_req */
 		worker->state_block_in_parallel_req = 1;
 		STARPU_PTHREAD_COND_BROADCAST(&worker->sched_cond);
+		_starpu_worker_unpark(worker);
 #ifdef STARPU_SIMGRID
 		starpu_pthread_queue_broadcast(&_starpu_simgrid_task_queue[worker->workerid]);
 #endif
@@ -869,6 +944,7 @@ static inline void _starpu_worker_request_unblocking_in_parallel(struct _starpu_
 			/* trigger the unblock_in_parallel_req */
 			worker->state_unblock_in_parallel_req = 1;
 			STARPU_PTHREAD_COND_BROADCAST(&worker->sched_cond);
+			_starpu_worker_unpark(worker);
 
 			/* wait for the unblock_in_parallel_req to be processed */
 			while (!worker->state_unblock_in_parallel_ack)
@@ -932,6 +1008,33 @@ static inline void _starpu_worker_process_block_in_parallel_requests(struct _sta
 	}
 }
 
+/** Mark that the worker does not hold any reference on scheduling data
+ * anymore, such as the copies of the worker lists, which can then be freed
+ * once all workers which might have been using them went through this. Must
+ * be called by the worker itself. */
+static inline void _starpu_worker_quiescent(struct _starpu_worker * const worker)
+{
+	/* Make sure our previous reads are over before telling so */
+	STARPU_SYNCHRONIZE();
+	worker->quiescent_epoch += 2;
+	/* And that we read newer data only after telling so */
+	STARPU_SYNCHRONIZE();
+}
+
+/** Mark that the worker is going to sleep, and will not be getting
+ * references on scheduling data until _starpu_worker_quiescent_end is called */
+static inline void _starpu_worker_quiescent_begin(struct _starpu_worker * const worker)
+{
+	STARPU_SYNCHRONIZE();
+	worker->quiescent_epoch++;
+}
+
+static inline void _starpu_worker_quiescent_end(struct _starpu_worker * const worker)
+{
+	worker->quiescent_epoch++;
+	STARPU_SYNCHRONIZE();
+}
+
 #ifdef STARPU_SPINLOCK_CHECK
 #define _starpu_worker_enter_sched_op(worker) __starpu_worker_enter_sched_op((worker), __FILE__, __LINE__, __starpu_func__)
 static inline void __starpu_worker_enter_sched_op(struct _starpu_worker * const worker, const char*file, int line, const char* func)
@@ -1063,6 +1166,7 @@ static inline void _starpu_worker_enter_changing_ctx_op(struct _starpu_worker *
 
 		/* wait for sched_op completion */
 		STARPU_PTHREAD_COND_BROADCAST(&worker->sched_cond);
+		_starpu_worker_unpark(worker);
 #ifdef STARPU_SIMGRID
 		starpu_pthread_queue_broadcast(&_starpu_simgrid_task_queue[worker->workerid]);
 #endif
@@ -1086,6 +1190,7 @@ static inline void _starpu_worker_leave_changing_ctx_op(struct _starpu_worker *
 	worker->thread_changing_ctx = (starpu_pthread_t)0;
 	worker->state_changing_ctx_notice = 0;
 	STARPU_PTHREAD_COND_BROADCAST(&worker->sched_cond);
+	_starpu_worker_unpark(worker);
 }
 
 #ifdef STARPU_SPINLOCK_CHECK
@@ -1034,6 +1034,43 @@ int _starpu_prefetch_task_input_prio(struct starpu_task *task, int target_node,
 	return 0;
 }
 
+void _starpu_idle_prefetch_task_ready_soon_input_for(struct starpu_task *task, unsigned worker, int prio)
+{
+	unsigned nbuffers = STARPU_TASK_GET_NBUFFERS(task);
+	unsigned index;
+
+	for (index = 0; index < nbuffers; index++)
+	{
+		starpu_data_handle_t handle = STARPU_TASK_GET_HANDLE(task, index);
+		enum starpu_data_access_mode mode = STARPU_TASK_GET_MODE(task, index) & ~STARPU_COMMUTE;
+		int busy;
+
+		if (mode != STARPU_R)
+			/* The task will modify it, do not bother */
+			continue;
+		if (handle->nplans || handle->siblings || handle->nchildren)
+			/* Partitioning may still change */
+			continue;
+
+		_starpu_spin_lock(&handle->header_lock);
+		/* The dependencies of the task are all completed but one which
+		 * has just started, which may be writing this piece of data */
+		busy = !handle->initialized || handle->reduction_refcnt
+			|| (handle->refcnt && (handle->current_mode & STARPU_W));
+		_starpu_spin_unlock(&handle->header_lock);
+		if (busy)
+			continue;
+
+		int node = _starpu_task_data_get_node_on_worker(task, index, worker);
+		if (node < 0)
+			continue;
+
+		/* The task may eventually be scheduled elsewhere, so do not
+		 * account this prefetch to it */
+		idle_prefetch_data_on_node(handle, node, &handle->per_node[node], STARPU_R, NULL, prio);
+	}
+}
+
 int starpu_prefetch_task_input_prio(struct starpu_task *task, int target_node, int worker, int prio)
 {
 	return _starpu_prefetch_task_input_prio(task, target_node, worker, prio, STARPU_PREFETCH);
@@ -1137,12 +1174,15 @@ static void _starpu_fetch_task_input_cb(void *arg)
  * executing the task. __starpu_push_task_output but be called after the
  * execution of the task. */
 
+static void fetch_task_input_tail(struct starpu_task *task, struct _starpu_job *j, struct _starpu_worker *worker);
+
 /* The driver can either just call _starpu_fetch_task_input with async==0,
  * or to improve overlapping, it can call _starpu_fetch_task_input with
  * async==1, then wait for transfers to complete, then call
  * _starpu_fetch_task_input_tail to complete the fetch.	 */
 int _starpu_fetch_task_input(struct starpu_task *task, struct _starpu_job *j, int async)
 {
+	_STARPU_OVERHEAD_START(overhead_start);
 	struct _starpu_worker *worker = _starpu_get_local_worker_key();
 	int workerid = worker->workerid;
 	if (async)
@@ -1213,6 +1253,10 @@ int _starpu_fetch_task_input(struct starpu_task *task, struct _starpu_job *j, in
 				/* Ooops, not enough memory, make worker wait for these for now, and the synchronous call will finish by forcing eviction*/
 				worker->nb_buffers_totransfer = nacquires;
 				_starpu_add_worker_status(worker, STATUS_INDEX_WAITING, NULL);
+#ifdef STARPU_OVERHEAD_BREAKDOWN
+				/* Accounted along the tail */
+				worker->overhead_fetch_ticks += _starpu_overhead_ticks() - overhead_start;
+#endif
 				return 0;
 			}
 		}
@@ -1235,10 +1279,16 @@ int _starpu_fetch_task_input(struct starpu_task *task, struct _starpu_job *j, in
 	if (async)
 	{
 		worker->nb_buffers_totransfer = nacquires;
+#ifdef STARPU_OVERHEAD_BREAKDOWN
+		/* Accounted along the tail */
+		worker->overhead_fetch_ticks += _starpu_overhead_ticks() - overhead_start;
+#endif
 		return 0;
 	}
 
-	_starpu_fetch_task_input_tail(task, j, worker);
+	/* Account head and tail as one fetch */
+	fetch_task_input_tail(task, j, worker);
+	_STARPU_OVERHEAD_END_WORKER(worker, _STARPU_OVERHEAD_FETCH_INPUT, overhead_start);
 
 	return 0;
 
@@ -1280,7 +1330,7 @@ enomem:
 }
 
 /* Now that we have taken the data locks in locking order, fill the codelet interfaces in function order.  */
-void _starpu_fetch_task_input_tail(struct starpu_task *task, struct _starpu_job *j, struct _starpu_worker *worker)
+static void fetch_task_input_tail(struct starpu_task *task, struct _starpu_job *j, struct _starpu_worker *worker)
 {
 	int workerid = worker->workerid;
 
@@ -1356,6 +1406,18 @@ void _starpu_fetch_task_input_tail(struct starpu_task *task, struct _starpu_job
 	_starpu_clear_worker_status(worker, STATUS_INDEX_WAITING, NULL);
 }
 
+/* Tail of an asynchronous fetch, account it along its head as one fetch */
+void _starpu_fetch_task_input_tail(struct starpu_task *task, struct _starpu_job *j, struct _starpu_worker *worker)
+{
+	_STARPU_OVERHEAD_START(overhead_start);
+	fetch_task_input_tail(task, j, worker);
+#ifdef STARPU_OVERHEAD_BREAKDOWN
+	overhead_start -= worker->overhead_fetch_ticks;
+	worker->overhead_fetch_ticks = 0;
+#endif
+	_STARPU_OVERHEAD_END_WORKER(worker, _STARPU_OVERHEAD_FETCH_INPUT, overhead_start);
+}
+
 /* Release task data dependencies */
 void __starpu_push_task_output(struct _starpu_job *j)
 {
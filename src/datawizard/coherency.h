@@ -389,6 +389,11 @@ int _starpu_fetch_task_input(struct starpu_task *task, struct _starpu_job *j, in
 void _starpu_fetch_task_input_tail(struct starpu_task *task, struct _starpu_job *j, struct _starpu_worker *worker);
 void _starpu_fetch_nowhere_task_input(struct _starpu_job *j);
 
+/** Idle-prefetch for worker \p worker the input data of task \p task, whose
+ * last dependency has just started. Only the data which the task only reads
+ * and which are not currently being written are prefetched. */
+void _starpu_idle_prefetch_task_ready_soon_input_for(struct starpu_task *task, unsigned worker, int prio);
+
 int _starpu_select_src_node(struct _starpu_data_state *state, unsigned destination);
 int _starpu_determine_request_path(starpu_data_handle_t handle,
 				  int src_node, int dst_node,
@@ -71,6 +71,7 @@ void _starpu_wake_all_blocked_workers_on_node(unsigned nodeid)
 		if (condition->cond == &condition->worker->sched_cond)
 		{
 			condition->worker->state_keep_awake = 1;
+			_starpu_worker_unpark(condition->worker);
 		}
 		STARPU_PTHREAD_COND_BROADCAST(condition->cond);
 		STARPU_PTHREAD_MUTEX_UNLOCK_SCHED(&condition->worker->sched_mutex);
@@ -117,6 +118,7 @@ void starpu_wake_all_blocked_workers(void)
 		if (condition->cond == &condition->worker->sched_cond)
 		{
 			condition->worker->state_keep_awake = 1;
+			_starpu_worker_unpark(condition->worker);
 		}
 		STARPU_PTHREAD_COND_BROADCAST(condition->cond);
 		STARPU_PTHREAD_MUTEX_UNLOCK_SCHED(&condition->worker->sched_mutex);
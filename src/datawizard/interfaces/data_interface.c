@@ -38,6 +38,7 @@ static int32_t nregistered, maxnregistered;
 static int _data_interface_number = STARPU_MAX_INTERFACE_ID;
 starpu_arbiter_t _starpu_global_arbiter;
 static int max_memory_use;
+static int data_numa_home;
 
 static void _starpu_data_unregister(starpu_data_handle_t handle, unsigned coherent, unsigned nowait);
 
@@ -46,6 +47,7 @@ void _starpu_data_interface_fini(void);
 void _starpu_data_interface_init(void)
 {
 	max_memory_use = starpu_getenv_number_default("STARPU_MAX_MEMORY_USE", 0);
+	data_numa_home = starpu_getenv_number_default("STARPU_DATA_NUMA_HOME", 0);
 
 	/* Just for testing purpose */
 	if (starpu_getenv_number_default("STARPU_GLOBAL_ARBITER", 0) > 0)
@@ -437,6 +439,43 @@ void starpu_data_register_ops(struct starpu_data_interface_ops *ops)
 	_starpu_data_register_ops(ops);
 }
 
+/* Return the NUMA memory node where the pages of the data described by
+ * data_interface, to be registered on the CPU memory node home_node, actually
+ * are, or home_node if they are not all on the same NUMA node, or not touched
+ * yet. This is called before registering the interface in the handle. */
+static int _starpu_data_get_numa_home_node(starpu_data_handle_t handle, int home_node, void *data_interface)
+{
+	struct _starpu_data_replicate *replicate = &handle->per_node[STARPU_MAIN_RAM];
+	void *saved_interface;
+	size_t size;
+	void *ptr;
+	long bitmap;
+	int logid;
+	int node;
+
+	if (!handle->ops->to_pointer)
+		return home_node;
+	ptr = handle->ops->to_pointer(data_interface, home_node);
+
+	/* The size methods look at the main RAM interface of the handle, let
+	 * them see the interface of the caller for now */
+	saved_interface = replicate->data_interface;
+	replicate->data_interface = data_interface;
+	size = starpu_data_get_alloc_size(handle);
+	replicate->data_interface = saved_interface;
+
+	bitmap = starpu_get_memory_location_bitmap(ptr, size);
+	if (bitmap <= 0 || (bitmap & (bitmap - 1)))
+		return home_node;
+
+	for (logid = 0; !(bitmap & (1L << logid)); logid++)
+		;
+	node = starpu_memory_nodes_numa_hwloclogid_to_id(logid);
+	if (node < 0)
+		return home_node;
+	return node;
+}
+
 void starpu_data_register(starpu_data_handle_t *handleptr, int home_node, void *data_interface, struct starpu_data_interface_ops *ops)
 {
 	STARPU_ASSERT_MSG(home_node >= -1 && home_node < (int)starpu_memory_nodes_get_count(), "Invalid memory node number");
@@ -450,6 +489,15 @@ void starpu_data_register(starpu_data_handle_t *handleptr, int home_node, void *
 		ops->interfaceid = starpu_data_interface_get_next_id();
 	}
 
+	if (data_numa_home > 0 && home_node >= 0
+		&& starpu_node_get_kind(home_node) == STARPU_CPU_RAM
+		&& starpu_memory_nodes_get_numa_count() > 1)
+	{
+		/* Make the NUMA node where the pages are the home node */
+		home_node = _starpu_data_get_numa_home_node(handle, home_node, data_interface);
+		handle->mf_node = home_node;
+	}
+
 	/* fill the interface fields with the appropriate method */
 	STARPU_ASSERT(ops->register_data_handle);
 	ops->register_data_handle(handle, home_node, data_interface);
@@ -36,6 +36,10 @@
 #include <smpi/smpi.h>
 #endif
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
 #ifdef STARPU_HAVE_HWLOC
 #include <hwloc.h>
 #ifndef HWLOC_API_VERSION
@@ -150,6 +154,145 @@ static struct starpu_codelet malloc_pinned_cl =
 };
 #endif
 
+#if defined(HAVE_MMAP) && defined(MADV_HUGEPAGE) && !defined(STARPU_SIMGRID)
+#define STARPU_MALLOC_HAVE_HUGEPAGES
+#endif
+
+#ifdef STARPU_MALLOC_HAVE_HUGEPAGES
+/* Size of the huge pages used for STARPU_MALLOC_HUGEPAGES, 0 until the first
+ * call to _starpu_malloc_get_hugepage_size */
+static size_t hugepage_size;
+/* Whether hugepage_size was explicitly requested, i.e. we have to use
+ * reserved huge pages rather than transparent huge pages */
+static int hugepage_explicit;
+
+/* Get the huge page size, computing it on first use. This does not depend on
+ * starpu_init, since starpu_malloc_flags may be called before it, and
+ * starpu_free_flags has to take the same decision as the allocation */
+static size_t _starpu_malloc_get_hugepage_size(void)
+{
+	size_t size;
+
+	STARPU_HG_DISABLE_CHECKING(hugepage_size);
+	size = hugepage_size;
+	if (STARPU_LIKELY(size))
+	{
+		STARPU_RMB();
+		return size;
+	}
+
+	/* Concurrent first calls all compute the same values */
+	size = starpu_getenv_size_default("STARPU_HUGEPAGE_SIZE", 0);
+	hugepage_explicit = size != 0;
+	if (!size)
+	{
+		/* Size of transparent huge pages */
+		FILE *f = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+		unsigned long thp_size;
+		if (f)
+		{
+			if (fscanf(f, "%lu", &thp_size) == 1)
+				size = thp_size;
+			fclose(f);
+		}
+		if (!size)
+			size = 2*1024*1024;
+	}
+	STARPU_ASSERT_MSG(!(size & (size - 1)), "STARPU_HUGEPAGE_SIZE (%lu) must be a power of two", (unsigned long) size);
+
+	/* Publish hugepage_explicit along */
+	STARPU_WMB();
+	hugepage_size = size;
+	return size;
+}
+
+/* Return whether we should back this allocation with huge pages */
+static int _starpu_malloc_should_hugepages(size_t dim, int flags)
+{
+	return (flags & STARPU_MALLOC_HUGEPAGES) && dim >= _starpu_malloc_get_hugepage_size();
+}
+
+static size_t _starpu_hugepages_length(size_t dim)
+{
+	return (dim + hugepage_size - 1) & ~(hugepage_size - 1);
+}
+
+static int _starpu_malloc_hugepages(unsigned dst_node, void **A, size_t dim)
+{
+	size_t len = _starpu_hugepages_length(dim);
+	void *buf = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+	if (hugepage_explicit)
+	{
+		int mapflags = MAP_ANONYMOUS|MAP_PRIVATE|MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+		/* Select the huge page size, e.g. 2MiB or 1GiB */
+		int shift = 0;
+		while (((size_t) 1 << shift) < hugepage_size)
+			shift++;
+		mapflags |= shift << MAP_HUGE_SHIFT;
+#endif
+		buf = mmap(NULL, len, PROT_READ|PROT_WRITE, mapflags, -1, 0);
+		if (buf == MAP_FAILED)
+		{
+			static int warned;
+			if (!warned)
+			{
+				warned = 1;
+				_STARPU_DISP("Warning: could not allocate %luMiB of huge pages of %luKiB (%s), falling back to transparent huge pages. You may need to reserve more huge pages, see /proc/sys/vm/nr_hugepages\n", (unsigned long) (len >> 20), (unsigned long) (hugepage_size >> 10), strerror(errno));
+			}
+		}
+	}
+#endif
+
+	if (buf == MAP_FAILED)
+	{
+		/* Transparent huge pages need the area to be aligned on huge
+		 * pages, allocate a bit more and trim the mapping */
+		char *raw = mmap(NULL, len + hugepage_size, PROT_READ|PROT_WRITE, MAP_ANONYMOUS|MAP_PRIVATE, -1, 0);
+		char *aligned;
+		if (raw == MAP_FAILED)
+		{
+			*A = NULL;
+			return -ENOMEM;
+		}
+		aligned = (char *) (((uintptr_t) raw + hugepage_size - 1) & ~(hugepage_size - 1));
+		if (aligned != raw)
+			munmap(raw, aligned - raw);
+		munmap(aligned + len, hugepage_size - (aligned - raw));
+		buf = aligned;
+		/* This may fail if transparent huge pages are disabled, we then
+		 * just get normal pages */
+		madvise(buf, len, MADV_HUGEPAGE);
+	}
+
+#ifdef STARPU_HAVE_HWLOC
+	/* Nothing was touched yet, we can still bind the pages */
+	if (starpu_memory_nodes_get_numa_count() > 1)
+	{
+		struct _starpu_machine_config *config = _starpu_get_machine_config();
+		hwloc_topology_t hwtopology = config->topology.hwtopology;
+		hwloc_obj_t numa_node_obj = hwloc_get_obj_by_type(hwtopology, HWLOC_OBJ_NUMANODE, starpu_memory_nodes_numa_id_to_hwloclogid(dst_node));
+		if (numa_node_obj)
+		{
+			hwloc_bitmap_t nodeset = numa_node_obj->nodeset;
+#if HWLOC_API_VERSION >= 0x00020000
+			hwloc_set_area_membind(hwtopology, buf, len, nodeset, HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_BYNODESET | HWLOC_MEMBIND_NOCPUBIND);
+#else
+			hwloc_set_area_membind_nodeset(hwtopology, buf, len, nodeset, HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_NOCPUBIND);
+#endif
+		}
+	}
+#else
+	(void) dst_node;
+#endif
+
+	*A = buf;
+	return 0;
+}
+#endif /* STARPU_MALLOC_HAVE_HUGEPAGES */
+
 /* Allocation in CPU RAM */
 int starpu_malloc_flags(void **A, size_t dim, int flags)
 {
@@ -447,6 +590,14 @@ int _starpu_malloc_flags_on_node(unsigned dst_node, void **A, size_t dim, int fl
 	}
 #endif
 
+#ifdef STARPU_MALLOC_HAVE_HUGEPAGES
+	if (_starpu_malloc_should_hugepages(dim, flags))
+	{
+		ret = _starpu_malloc_hugepages(dst_node, A, dim);
+		goto end;
+	}
+#endif
+
 #ifdef HAVE_MMAP
 #ifdef STARPU_USE_MP
 	if(_starpu_can_submit_ms_task())
@@ -715,6 +866,12 @@ int _starpu_free_flags_on_node(unsigned dst_node, void *A, size_t dim, int flags
 			munmap(A, dim);
 	}
 #endif
+#ifdef STARPU_MALLOC_HAVE_HUGEPAGES
+	else if (_starpu_malloc_should_hugepages(dim, flags))
+	{
+		munmap(A, _starpu_hugepages_length(dim));
+	}
+#endif
 #ifdef HAVE_MMAP
 #ifdef STARPU_USE_MP
 	else if(_starpu_can_submit_ms_task())
@@ -853,6 +1010,9 @@ _starpu_malloc_init(unsigned dst_node)
 	disable_pinning = starpu_getenv_number("STARPU_DISABLE_PINNING");
 	enable_suballocator = starpu_getenv_number_default("STARPU_SUBALLOCATOR", 1);
 	node_struct->malloc_on_node_default_flags = STARPU_MALLOC_PINNED | STARPU_MALLOC_COUNT;
+
+	if (starpu_getenv_number_default("STARPU_HUGEPAGES", 0) > 0 && starpu_node_get_kind(dst_node) == STARPU_CPU_RAM)
+		node_struct->malloc_on_node_default_flags |= STARPU_MALLOC_HUGEPAGES;
 #ifdef STARPU_SIMGRID
 	/* Reasonably "costless" */
 	_starpu_malloc_simulation_fold = starpu_getenv_number_default("STARPU_MALLOC_SIMULATION_FOLD", 1) << 20;
@@ -25,6 +25,13 @@
 #include <core/sched_policy.h>
 #include <datawizard/memory_nodes.h>
 
+#ifdef STARPU_HAVE_HWLOC
+#include <hwloc.h>
+#if HWLOC_API_VERSION < 0x00010b00
+#define HWLOC_OBJ_NUMANODE HWLOC_OBJ_NODE
+#endif
+#endif
+
 static void _starpu_data_check_initialized(starpu_data_handle_t handle, enum starpu_data_access_mode mode)
 {
 	if (((handle->nplans && !handle->nchildren) || handle->siblings)
@@ -849,3 +856,94 @@ void starpu_data_query_status(starpu_data_handle_t handle, int memory_node, int
 {
 	return starpu_data_query_status2(handle, memory_node, is_allocated, is_valid, NULL, is_requested);
 }
+
+int starpu_data_migrate_home_node(starpu_data_handle_t handle, unsigned node)
+{
+	int home_node = handle->home_node;
+
+	STARPU_ASSERT_MSG(node < starpu_memory_nodes_get_count(), "Invalid memory node number");
+	if (home_node < 0
+		|| starpu_node_get_kind(home_node) != STARPU_CPU_RAM
+		|| starpu_node_get_kind(node) != STARPU_CPU_RAM
+		|| handle->root_handle != handle)
+		return -EINVAL;
+	if ((int) node == home_node)
+		return 0;
+	if (!handle->ops->to_pointer)
+		return -ENOSYS;
+
+#ifdef STARPU_HAVE_HWLOC
+	struct _starpu_machine_config *config = _starpu_get_machine_config();
+	hwloc_topology_t hwtopology = config->topology.hwtopology;
+	hwloc_obj_t numa_node_obj = hwloc_get_obj_by_type(hwtopology, HWLOC_OBJ_NUMANODE, starpu_memory_nodes_numa_id_to_hwloclogid(node));
+	struct _starpu_data_replicate *home_replicate = &handle->per_node[home_node];
+	struct _starpu_data_replicate *replicate = &handle->per_node[node];
+	void *data_interface;
+	void *ptr;
+	int ret;
+
+	if (!numa_node_obj)
+		return -EINVAL;
+
+	/* Get the data back home and make sure nobody uses it */
+	ret = starpu_data_acquire_on_node(handle, home_node, STARPU_RW);
+	if (ret)
+		return ret;
+
+	/* Now that the home copy is the only valid one, drop the replica
+	 * which may already be there, the home copy will replace it */
+	starpu_data_evict_from_node(handle, node);
+
+	if (handle->nchildren || replicate->allocated || replicate->mc)
+	{
+		ret = -EBUSY;
+		goto out;
+	}
+
+	/* Move the pages themselves */
+	ptr = handle->ops->to_pointer(home_replicate->data_interface, home_node);
+#if HWLOC_API_VERSION >= 0x00020000
+	ret = hwloc_set_area_membind(hwtopology, ptr, starpu_data_get_alloc_size(handle), numa_node_obj->nodeset, HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_BYNODESET | HWLOC_MEMBIND_MIGRATE | HWLOC_MEMBIND_NOCPUBIND);
+#else
+	ret = hwloc_set_area_membind_nodeset(hwtopology, ptr, starpu_data_get_alloc_size(handle), numa_node_obj->nodeset, HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_MIGRATE | HWLOC_MEMBIND_NOCPUBIND);
+#endif
+	if (ret)
+	{
+		ret = -errno;
+		goto out;
+	}
+
+	/* And make the copy belong to the new node */
+	_starpu_spin_lock(&handle->header_lock);
+	if (replicate->allocated || replicate->mc)
+	{
+		/* Somebody allocated it meanwhile */
+		_starpu_spin_unlock(&handle->header_lock);
+		ret = -EBUSY;
+		goto out;
+	}
+	data_interface = replicate->data_interface;
+	replicate->data_interface = home_replicate->data_interface;
+	home_replicate->data_interface = data_interface;
+
+	replicate->state = home_replicate->state;
+	replicate->allocated = 1;
+	replicate->automatically_allocated = 0;
+	replicate->initialized = home_replicate->initialized;
+	home_replicate->state = STARPU_INVALID;
+	home_replicate->allocated = 0;
+	home_replicate->initialized = 0;
+
+	handle->home_node = node;
+	if (handle->mf_node == (unsigned) home_node)
+		handle->mf_node = node;
+	_starpu_spin_unlock(&handle->header_lock);
+
+out:
+	/* We acquired it on the former home node */
+	starpu_data_release_on_node(handle, home_node);
+	return ret;
+#else
+	return -ENOSYS;
+#endif
+}
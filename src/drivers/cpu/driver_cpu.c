@@ -181,6 +181,8 @@ int _starpu_cpu_driver_init(struct _starpu_worker *cpu_worker)
 
 	_STARPU_TRACE_WORKER_INIT_END(cpu_worker->workerid);
 
+	cpu_worker->lookahead_length = starpu_getenv_number_default("STARPU_CPU_LOOKAHEAD", 0);
+
 	STARPU_PTHREAD_MUTEX_LOCK_SCHED(&cpu_worker->sched_mutex);
 	cpu_worker->status = STATUS_UNKNOWN;
 	STARPU_PTHREAD_MUTEX_UNLOCK_SCHED(&cpu_worker->sched_mutex);
@@ -390,6 +392,11 @@ static int execute_job_on_cpu(struct _starpu_job *j, struct starpu_task *worker_
 #ifdef STARPU_PAPI
 			if (rank == 0)
 				_starpu_profiling_papi_task_start_counters(task);
+#endif
+#ifdef STARPU_OPENMP
+			if ((cl->flags & STARPU_CODELET_YIELDABLE) && !is_parallel_task)
+				_starpu_task_yieldable_exec(j, func);
+			else
 #endif
 			func(_STARPU_TASK_GET_INTERFACES(task), task->cl_arg);
 #ifdef STARPU_PAPI
@@ -593,6 +600,11 @@ int _starpu_cpu_driver_run_once(struct _starpu_worker *cpu_worker)
 		/* Reset it */
 		cpu_worker->task_transferring = NULL;
 
+		if (cpu_worker->lookahead_length)
+			/* Let the input of the next tasks get fetched while we
+			 * run this one */
+			_starpu_worker_lookahead(cpu_worker);
+
 		ret = _starpu_cpu_driver_execute_task(cpu_worker, pending_task, j);
 		_STARPU_TRACE_START_PROGRESS(memnode);
 #ifdef STARPU_PROF_TOOL
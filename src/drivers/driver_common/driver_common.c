@@ -69,7 +69,7 @@ void _starpu_driver_start_job(struct _starpu_worker *worker, struct _starpu_job
 	struct timespec start;
 
 	struct starpu_profiling_task_info *profiling_info = task->profiling_info;
-	if ((profiling && profiling_info) || (rank == 0 && (calibrate_model || !_starpu_perf_counter_paused())))
+	if ((profiling && profiling_info) || (rank == 0 && (calibrate_model || _starpu_sched_ctx_fair_share || !_starpu_perf_counter_paused())))
 		_starpu_clock_gettime(&start);
 	_starpu_add_worker_status(worker, STATUS_INDEX_EXECUTING, &start);
 
@@ -91,7 +91,7 @@ void _starpu_driver_start_job(struct _starpu_worker *worker, struct _starpu_job
 		if (_starpu_codelet_profiling)
 			cl->per_worker_stats[workerid]++;
 
-		if ((profiling && profiling_info) || calibrate_model || !_starpu_perf_counter_paused())
+		if ((profiling && profiling_info) || calibrate_model || _starpu_sched_ctx_fair_share || !_starpu_perf_counter_paused())
 		{
 			worker->cl_start = start;
 			if (profiling && profiling_info)
@@ -157,6 +157,10 @@ void _starpu_driver_start_job(struct _starpu_worker *worker, struct _starpu_job
 		_STARPU_TRACE_START_CODELET_BODY(j, j->nimpl, perf_arch, workerid);
 	}
 	_starpu_sched_ctx_unlock_read(sched_ctx->id);
+#ifdef STARPU_OVERHEAD_BREAKDOWN
+	if (rank == 0)
+		worker->overhead_exec_start = _starpu_overhead_ticks();
+#endif
 	_STARPU_TASK_BREAK_ON(task, exec);
 }
 
@@ -167,6 +171,11 @@ void _starpu_driver_end_job(struct _starpu_worker *worker, struct _starpu_job *j
 	int workerid = worker->workerid;
 	unsigned calibrate_model = 0;
 
+#ifdef STARPU_OVERHEAD_BREAKDOWN
+	if (rank == 0)
+		_STARPU_OVERHEAD_END_WORKER(worker, _STARPU_OVERHEAD_EXECUTE, worker->overhead_exec_start);
+#endif
+
 	// Find out if the worker is the master of a parallel context
 	struct _starpu_sched_ctx *sched_ctx = _starpu_sched_ctx_get_sched_ctx_for_worker_and_job(worker, j);
 	if(!sched_ctx)
@@ -188,13 +197,13 @@ void _starpu_driver_end_job(struct _starpu_worker *worker, struct _starpu_job *j
 
 	struct timespec end;
 	struct starpu_profiling_task_info *profiling_info = task->profiling_info;
-	if ((profiling && profiling_info) || (rank == 0 && (calibrate_model || !_starpu_perf_counter_paused())))
+	if ((profiling && profiling_info) || (rank == 0 && (calibrate_model || _starpu_sched_ctx_fair_share || !_starpu_perf_counter_paused())))
 		_starpu_clock_gettime(&end);
 	_starpu_clear_worker_status(worker, STATUS_INDEX_EXECUTING, &end);
 
 	if (rank == 0)
 	{
-		if ((profiling && profiling_info) || calibrate_model || !_starpu_perf_counter_paused())
+		if ((profiling && profiling_info) || calibrate_model || _starpu_sched_ctx_fair_share || !_starpu_perf_counter_paused())
 			worker->cl_end = end;
 		STARPU_AYU_POSTRUNTASK(j->job_id);
 	}
@@ -239,17 +248,31 @@ void _starpu_driver_update_job_feedback(struct _starpu_job *j, struct _starpu_wo
 		calibrate_model = 1;
 #endif
 
-	if ((profiling && profiling_info) || calibrate_model || !_starpu_perf_counter_paused())
+	if ((profiling && profiling_info) || calibrate_model || _starpu_sched_ctx_fair_share || !_starpu_perf_counter_paused())
 	{
 		starpu_timespec_sub(&worker->cl_end, &worker->cl_start, &measured_ts);
 		double measured = starpu_timing_timespec_to_us(&measured_ts);
 
 		STARPU_ASSERT_MSG(measured >= 0, "measured=%lf\n", measured);
 
+		if (_starpu_sched_ctx_fair_share)
+			_starpu_sched_ctx_fair_share_account(j->task->sched_ctx, measured);
+
 		if (!_starpu_perf_counter_paused())
 		{
 			worker->__w_total_executed__value++;
 			worker->__w_cumul_execution_time__value += measured;
+			if (j->task->deadline != 0.)
+			{
+				if (starpu_timing_timespec_to_us(&worker->cl_end) > j->task->deadline)
+				{
+					worker->__w_deadline_missed__value++;
+					(void)STARPU_PERF_COUNTER_ADD64(&_starpu_task__g_deadline_missed__value, 1);
+				}
+				else
+					(void)STARPU_PERF_COUNTER_ADD64(&_starpu_task__g_deadline_met__value, 1);
+				_starpu_perf_counter_update_global_sample();
+			}
 			_starpu_perf_counter_update_per_worker_sample(worker->workerid);
 			if (cl->perf_counter_values)
 			{
@@ -396,9 +419,197 @@ static void _starpu_exponential_backoff(struct _starpu_worker *worker)
 	while(delay--)
 		STARPU_UYIELD();
 }
+
+/* Account the time spent in the current idle phase, and switch to the given one */
+static void _starpu_worker_idle_phase(struct _starpu_worker *worker, enum _starpu_worker_idle_phase phase, double now)
+{
+	worker->idle_time[worker->idle_phase] += now - worker->idle_date;
+	worker->idle_phase = phase;
+	worker->idle_date = now;
+}
+
+/* The worker did not find any task to run */
+static void _starpu_worker_idle_begin(struct _starpu_worker *worker)
+{
+	if (worker->idle_start != 0.)
+		/* Already idle */
+		return;
+	worker->idle_start = worker->idle_date = starpu_timing_now();
+	worker->idle_phase = IDLE_PHASE_SPINNING;
+}
+
+/* The worker got a task to run again */
+static void _starpu_worker_idle_end(struct _starpu_worker *worker)
+{
+	if (worker->idle_start == 0.)
+		return;
+
+	double now = starpu_timing_now();
+	_starpu_worker_idle_phase(worker, worker->idle_phase, now);
+	worker->idle_expected = (7. * worker->idle_expected + (now - worker->idle_start)) / 8.;
+
+	_starpu_worker_update_profiling_info_idle(worker->workerid, worker->idle_start,
+		worker->idle_time[IDLE_PHASE_SPINNING],
+		worker->idle_time[IDLE_PHASE_YIELDING],
+		worker->idle_time[IDLE_PHASE_PARKED]);
+	memset(worker->idle_time, 0, sizeof(worker->idle_time));
+	worker->idle_start = 0.;
+}
+
+/* How long the idle worker should wait actively, spinning for the first half
+ * and yielding the CPU for the second half, before blocking. If the recent
+ * idle periods were short, tasks will probably come back soon, so wait about
+ * that long. Otherwise, only wait for about the time a wakeup would take
+ * anyway, so that a long idle period wastes at most that time. Workers which
+ * never block (non-blocking drivers, or before any wakeup was measured) have
+ * no such latency to compare with, and use the maximum instead. The
+ * STARPU_WORKER_IDLE_LATENCY knob scales this between 0 (save power) and
+ * twice as long (favor latency). */
+static double _starpu_worker_idle_budget(struct _starpu_worker *worker)
+{
+	double spin_max = _starpu_config.worker_park_spin_max;
+	double expected = worker->idle_expected;
+	if (expected > spin_max)
+		expected = worker->park_latency != 0. ? worker->park_latency : spin_max;
+	double budget = 2. * _starpu_config.worker_idle_latency * expected;
+	return budget < spin_max ? budget : spin_max;
+}
+
+/* Idle wait of a worker which can not block: spin with exponential backoff
+ * during the first half of the budget, then yield the CPU */
+static void _starpu_worker_idle_poll(struct _starpu_worker *worker)
+{
+	_starpu_worker_idle_begin(worker);
+
+	double now = starpu_timing_now();
+	if (now - worker->idle_start < _starpu_worker_idle_budget(worker) / 2.)
+	{
+		_starpu_worker_idle_phase(worker, IDLE_PHASE_SPINNING, now);
+		_starpu_exponential_backoff(worker);
+	}
+	else
+	{
+		_starpu_worker_idle_phase(worker, IDLE_PHASE_YIELDING, now);
+		sched_yield();
+	}
+}
+
+#ifndef STARPU_NON_BLOCKING_DRIVERS
+/* Wait for something to happen to the sleeping worker, with its sched_mutex
+ * held. With futexes, the worker parks on its own futex word instead of
+ * sched_cond, so that it is not woken up by all the broadcasts meant for the
+ * threads waiting for its state to change, and it is woken up with a single
+ * targeted syscall by _starpu_worker_unpark. Before blocking, it waits
+ * actively according to _starpu_worker_idle_budget, so that short idle
+ * periods do not pay for the syscalls. */
+static void _starpu_worker_wait_for_work(struct _starpu_worker *worker)
+{
+	_starpu_worker_idle_begin(worker);
+	_starpu_worker_quiescent_begin(worker);
+
+#ifdef _STARPU_HAVE_FUTEX
+	if (_starpu_config.worker_parking)
+	{
+		unsigned token = worker->park_token;
+		double budget = _starpu_worker_idle_budget(worker);
+		double now;
+
+		worker->state_parked = 1;
+		STARPU_PTHREAD_MUTEX_UNLOCK_SCHED(&worker->sched_mutex);
+
+		STARPU_HG_DISABLE_CHECKING(worker->park_token);
+		now = starpu_timing_now();
+		/* The budget counts from the beginning of the idle period, we
+		 * may have been woken up for something else meanwhile */
+		while (worker->park_token == token && now - worker->idle_start < budget)
+		{
+			if (now - worker->idle_start < budget / 2.)
+			{
+				_starpu_worker_idle_phase(worker, IDLE_PHASE_SPINNING, now);
+				STARPU_UYIELD();
+				STARPU_SYNCHRONIZE();
+			}
+			else
+			{
+				_starpu_worker_idle_phase(worker, IDLE_PHASE_YIELDING, now);
+				sched_yield();
+			}
+			now = starpu_timing_now();
+		}
+
+		if (worker->park_token == token)
+		{
+			/* Nothing came while waiting actively, really block. The
+			 * barrier pairs with the one in _starpu_worker_unpark, so
+			 * that either it sees that we block, or we see the new
+			 * token */
+			_starpu_worker_idle_phase(worker, IDLE_PHASE_PARKED, now);
+			worker->state_parked = 2;
+			STARPU_SYNCHRONIZE();
+			while (worker->park_token == token)
+				_starpu_futex_block(&worker->park_token, token);
+
+			double latency = starpu_timing_now() - worker->park_wake_date;
+			if (latency >= 0.)
+				worker->park_latency = (7. * worker->park_latency + latency) / 8.;
+		}
+
+		STARPU_PTHREAD_MUTEX_LOCK_SCHED(&worker->sched_mutex);
+		worker->state_parked = 0;
+		_starpu_worker_quiescent_end(worker);
+		return;
+	}
 #endif
+	_starpu_worker_idle_phase(worker, IDLE_PHASE_PARKED, starpu_timing_now());
+	STARPU_PTHREAD_COND_WAIT(&worker->sched_cond, &worker->sched_mutex);
+	_starpu_worker_quiescent_end(worker);
+}
+#endif
+#endif
+
+
 
+/* Pop the next tasks ahead of time, so their input gets prefetched while the
+ * current task runs */
+void _starpu_worker_lookahead(struct _starpu_worker *worker)
+{
+	int workerid = worker->workerid;
 
+	while (worker->nlookahead < worker->lookahead_length && _starpu_machine_is_running())
+	{
+		struct starpu_task *task;
+		struct _starpu_job *j;
+
+		STARPU_PTHREAD_MUTEX_LOCK_SCHED(&worker->sched_mutex);
+		_starpu_worker_enter_sched_op(worker);
+		_starpu_worker_set_status_scheduling(workerid);
+		STARPU_PTHREAD_MUTEX_UNLOCK_SCHED(&worker->sched_mutex);
+		_STARPU_OVERHEAD_START(overhead_start);
+		task = _starpu_pop_task(worker);
+		if (task)
+			_STARPU_OVERHEAD_END_WORKER(worker, _STARPU_OVERHEAD_POP, overhead_start);
+		STARPU_PTHREAD_MUTEX_LOCK_SCHED(&worker->sched_mutex);
+		_starpu_worker_set_status_scheduling_done(workerid);
+		_starpu_worker_leave_sched_op(worker);
+		STARPU_PTHREAD_COND_BROADCAST(&worker->sched_cond);
+		STARPU_PTHREAD_MUTEX_UNLOCK_SCHED(&worker->sched_mutex);
+
+		if (!task)
+			break;
+
+		starpu_task_list_push_back(&worker->lookahead_tasks, task);
+		worker->nlookahead++;
+
+		j = _starpu_get_job_associated_to_task(task);
+		if (j->task_size > 1)
+			/* Parallel tasks get fetched by their rank 0 only,
+			 * and we should not keep the other workers waiting
+			 * for a long time */
+			break;
+		if (starpu_get_prefetch_flag() && !task->prefetched)
+			starpu_prefetch_task_input_for(task, workerid);
+	}
+}
 
 /* Workers may block when there is no work to do at all. */
 struct starpu_task *_starpu_get_worker_task(struct _starpu_worker *worker, int workerid, unsigned memnode STARPU_ATTRIBUTE_UNUSED)
@@ -408,6 +619,9 @@ struct starpu_task *_starpu_get_worker_task(struct _starpu_worker *worker, int w
 	unsigned keep_awake = 0;
 #endif
 
+	/* We are not in the middle of any scheduling operation */
+	_starpu_worker_quiescent(worker);
+
 	STARPU_PTHREAD_MUTEX_LOCK_SCHED(&worker->sched_mutex);
 	_starpu_worker_enter_sched_op(worker);
 	_starpu_worker_set_status_scheduling(workerid);
@@ -424,11 +638,20 @@ struct starpu_task *_starpu_get_worker_task(struct _starpu_worker *worker, int w
 	/* don't push a task if we are already transferring one */
 	else if (worker->task_transferring != NULL)
 		task = NULL;
+	/* we have already popped some, and are prefetching their input */
+	else if (worker->nlookahead)
+	{
+		task = starpu_task_list_pop_front(&worker->lookahead_tasks);
+		worker->nlookahead--;
+	}
 	/*else try to pop a task*/
 	else
 	{
 		STARPU_PTHREAD_MUTEX_UNLOCK_SCHED(&worker->sched_mutex);
+		_STARPU_OVERHEAD_START(overhead_start);
 		task = _starpu_pop_task(worker);
+		if (task)
+			_STARPU_OVERHEAD_END_WORKER(worker, _STARPU_OVERHEAD_POP, overhead_start);
 		STARPU_PTHREAD_MUTEX_LOCK_SCHED(&worker->sched_mutex);
 #if !defined(STARPU_SIMGRID)
 		if (worker->state_keep_awake)
@@ -467,7 +690,7 @@ struct starpu_task *_starpu_get_worker_task(struct _starpu_worker *worker, int w
 #endif
 			do
 			{
-				STARPU_PTHREAD_COND_WAIT(&worker->sched_cond, &worker->sched_mutex);
+				_starpu_worker_wait_for_work(worker);
 				if (!worker->state_keep_awake
 					&& _starpu_worker_can_block(memnode, worker)
 					&& !worker->state_block_in_parallel_req
@@ -504,7 +727,7 @@ struct starpu_task *_starpu_get_worker_task(struct _starpu_worker *worker, int w
 			_starpu_worker_set_status_scheduling_done(workerid);
 			STARPU_PTHREAD_MUTEX_UNLOCK_SCHED(&worker->sched_mutex);
 			if (_starpu_machine_is_running())
-				_starpu_exponential_backoff(worker);
+				_starpu_worker_idle_poll(worker);
 		}
 
 		return NULL;
@@ -513,6 +736,9 @@ struct starpu_task *_starpu_get_worker_task(struct _starpu_worker *worker, int w
 
 	if (task)
 	{
+#ifndef STARPU_SIMGRID
+		_starpu_worker_idle_end(worker);
+#endif
 		_starpu_worker_set_status_scheduling_done(workerid);
 		_starpu_worker_set_status_wakeup(workerid);
 	}
@@ -542,6 +768,9 @@ int _starpu_get_multi_worker_task(struct _starpu_worker *workers, struct starpu_
 #if !defined(STARPU_NON_BLOCKING_DRIVERS) && !defined(STARPU_SIMGRID)
 	int executing = 0;
 #endif
+	/* We are not in the middle of any scheduling operation */
+	for (i = 0; i < nworkers; i++)
+		_starpu_worker_quiescent(&workers[i]);
 	/*for each worker*/
 #ifndef STARPU_NON_BLOCKING_DRIVERS
 	/* This assumes only 1 worker */
@@ -582,7 +811,10 @@ int _starpu_get_multi_worker_task(struct _starpu_worker *workers, struct starpu_
 #endif
 			_starpu_worker_set_status_scheduling(workers[i].workerid);
 			STARPU_PTHREAD_MUTEX_UNLOCK_SCHED(&workers[i].sched_mutex);
+			_STARPU_OVERHEAD_START(overhead_start);
 			tasks[i] = _starpu_pop_task(&workers[i]);
+			if (tasks[i])
+				_STARPU_OVERHEAD_END_WORKER(&workers[i], _STARPU_OVERHEAD_POP, overhead_start);
 			STARPU_PTHREAD_MUTEX_LOCK_SCHED(&workers[i].sched_mutex);
 			if (workers[i].state_keep_awake)
 			{
@@ -677,7 +909,7 @@ int _starpu_get_multi_worker_task(struct _starpu_worker *workers, struct starpu_
 #endif
 			do
 			{
-				STARPU_PTHREAD_COND_WAIT(&worker->sched_cond, &worker->sched_mutex);
+				_starpu_worker_wait_for_work(worker);
 				if (!worker->state_keep_awake
 					&& _starpu_worker_can_block(memnode, worker)
 					&& !worker->state_block_in_parallel_req
@@ -713,11 +945,12 @@ int _starpu_get_multi_worker_task(struct _starpu_worker *workers, struct starpu_
 			_starpu_worker_set_status_scheduling_done(workerid);
 			STARPU_PTHREAD_MUTEX_UNLOCK_SCHED(&worker->sched_mutex);
 			if (_starpu_machine_is_running())
-				_starpu_exponential_backoff(worker);
+				_starpu_worker_idle_poll(worker);
 		}
 		return 0;
 	}
 
+	_starpu_worker_idle_end(worker);
 	_starpu_worker_set_status_wakeup(workerid);
 	worker->spinning_backoff = worker->config->conf.driver_spinning_backoff_min;
 #endif /* !STARPU_SIMGRID */
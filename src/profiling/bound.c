@@ -26,6 +26,7 @@
 #include <profiling/bound.h>
 #include <core/jobs.h>
 #include <core/workers.h>
+#include <common/uthash.h>
 #include <datawizard/memory_nodes.h>
 
 #ifdef STARPU_HAVE_GLPK_H
@@ -34,7 +35,7 @@
 
 /* TODO: output duration between starpu_bound_start and starpu_bound_stop */
 
-/* TODO: compute critical path and introduce it in the LP */
+/* TODO: introduce the critical path in the per-task LP */
 
 /*
  * Record without dependencies: just count each kind of task
@@ -106,6 +107,13 @@ struct bound_task
 	/* Estimated duration */
 	double** duration[STARPU_NARCH];
 
+	/* Used by starpu_bound_compute_fast: minimum duration over all workers,
+	 * earliest completion time, DFS state and next dependency to visit */
+	double fast_duration;
+	double fast_finish;
+	int fast_state;
+	int fast_next;
+
 	/* Other tasks */
 	struct bound_task *next;
 };
@@ -458,6 +466,21 @@ void starpu_bound_stop(void)
 	STARPU_PTHREAD_MUTEX_UNLOCK(&mutex);
 }
 
+/* Estimated duration (in ms) of a task of kind (cl, footprint) on arch, NAN if unknown */
+static double _starpu_get_task_time(struct starpu_codelet *cl, uint32_t footprint, struct starpu_perfmodel_arch *arch)
+{
+	struct _starpu_job j =
+	{
+		.footprint = footprint,
+		.footprint_is_computed = 1,
+	};
+	double length = _starpu_history_based_job_expected_perf(cl->model, arch, &j, j.nimpl)
+	              - _starpu_history_based_job_expected_deviation(cl->model, arch, &j, j.nimpl);
+	if (isnan(length))
+		return NAN;
+	return length / 1000.;
+}
+
 /* Compute all tasks times on all workers */
 static void _starpu_get_tasks_times(int nw, int nt, double *times)
 {
@@ -467,18 +490,8 @@ static void _starpu_get_tasks_times(int nw, int nt, double *times)
 	{
 		for (t = 0, tp = task_pools; tp; t++, tp = tp->next)
 		{
-			struct _starpu_job j =
-			{
-				.footprint = tp->footprint,
-				.footprint_is_computed = 1,
-			};
 			struct starpu_perfmodel_arch* arch = starpu_worker_get_perf_archtype(w, STARPU_NMAX_SCHED_CTXS);
-			double length = _starpu_history_based_job_expected_perf(tp->cl->model, arch, &j, j.nimpl)
-			              - _starpu_history_based_job_expected_deviation(tp->cl->model, arch, &j, j.nimpl);
-			if (isnan(length))
-				times[w*nt+t] = NAN;
-			else
-				times[w*nt+t] = length / 1000.;
+			times[w*nt+t] = _starpu_get_task_time(tp->cl, tp->footprint, arch);
 		}
 	}
 }
@@ -555,24 +568,11 @@ void starpu_bound_print_lp(FILE *output)
 				/* TODO: */
 				_STARPU_MSG("Warning: task %s uses a perf model which is neither history nor non-linear regression-based, support for such model is not implemented yet, system will not be solvable.\n", _starpu_codelet_get_model_name(t1->cl));
 
-			struct _starpu_job j =
-			{
-				.footprint = t1->footprint,
-				.footprint_is_computed = 1,
-			};
 			for (w = 0; w < nw; w++)
 			{
 				struct starpu_perfmodel_arch* arch = starpu_worker_get_perf_archtype(w, STARPU_NMAX_SCHED_CTXS);
 				if (_STARPU_IS_ZERO(t1->duration[arch->devices[0].type][arch->devices[0].devid][arch->devices[0].ncores]))
-				{
-					double length = _starpu_history_based_job_expected_perf(t1->cl->model, arch, &j,j.nimpl)
-					              - _starpu_history_based_job_expected_deviation(t1->cl->model, arch, &j,j.nimpl);
-					if (isnan(length))
-						/* Avoid problems with binary coding of doubles */
-						t1->duration[arch->devices[0].type][arch->devices[0].devid][arch->devices[0].ncores] = NAN;
-					else
-						t1->duration[arch->devices[0].type][arch->devices[0].devid][arch->devices[0].ncores] = length / 1000.;
-				}
+					t1->duration[arch->devices[0].type][arch->devices[0].devid][arch->devices[0].ncores] = _starpu_get_task_time(t1->cl, t1->footprint, arch);
 			}
 			nt++;
 		}
@@ -1207,3 +1207,341 @@ void starpu_bound_compute(double *res, double *integer_res, int integer)
 	*res = 0.;
 #endif /* STARPU_HAVE_GLPK_H */
 }
+
+/*
+ * Fast bounds, which do not need to solve a per-task problem.
+ *
+ * - The area bound is the sum over all tasks of their duration on the fastest
+ *   worker, divided by the number of workers.
+ * - The critical path bound is the longest path in the task graph, each task
+ *   taking its duration on the fastest worker. Only task dependencies are
+ *   considered, tag dependencies are ignored, which still gives a lower bound.
+ * - The task kinds bound is the solution of the LP of starpu_bound_compute()
+ *   written over kinds of workers rather than over workers, with the makespan
+ *   additionally bounded by the critical path.
+ *
+ * The first two are linear in the number of tasks and dependencies, the LP
+ * size only depends on the number of task kinds and worker kinds.
+ */
+
+struct bound_fast_key
+{
+	struct starpu_codelet *cl;
+	uint32_t footprint;
+};
+
+struct bound_fast_kind
+{
+	struct bound_fast_key key;
+	unsigned long n;
+	/* Index in the kind arrays */
+	int index;
+	UT_hash_handle hh;
+};
+
+static struct bound_fast_kind *_starpu_bound_fast_get_kind(struct bound_fast_kind **kinds, int *nt, struct starpu_codelet *cl, uint32_t footprint)
+{
+	struct bound_fast_key key;
+	struct bound_fast_kind *kind;
+
+	/* Avoid hashing garbage in the padding */
+	memset(&key, 0, sizeof(key));
+	key.cl = cl;
+	key.footprint = footprint;
+
+	HASH_FIND(hh, *kinds, &key, sizeof(key), kind);
+	if (!kind)
+	{
+		_STARPU_CALLOC(kind, 1, sizeof(*kind));
+		kind->key = key;
+		kind->index = (*nt)++;
+		HASH_ADD(hh, *kinds, key, sizeof(key), kind);
+	}
+	return kind;
+}
+
+/* Longest path in the task graph, using the fast_duration of tasks */
+static double _starpu_bound_fast_critical_path(unsigned long ntasks)
+{
+	struct bound_task **stack;
+	struct bound_task *t;
+	unsigned long nstack;
+	double cp = 0.;
+
+	if (!ntasks)
+		return 0.;
+
+	_STARPU_MALLOC(stack, ntasks * sizeof(*stack));
+
+	for (t = tasks; t; t = t->next)
+	{
+		t->fast_state = 0;
+		t->fast_next = 0;
+		t->fast_finish = 0.;
+	}
+
+	for (t = tasks; t; t = t->next)
+	{
+		if (t->fast_state)
+			continue;
+
+		/* Iterative depth-first traversal, to avoid overflowing the
+		 * stack on long chains of tasks */
+		t->fast_state = 1;
+		stack[0] = t;
+		nstack = 1;
+		while (nstack)
+		{
+			struct bound_task *cur = stack[nstack-1];
+			if (cur->fast_next < cur->depsn)
+			{
+				struct bound_task *dep = cur->deps[cur->fast_next++].dep;
+				if (!dep->fast_state)
+				{
+					dep->fast_state = 1;
+					STARPU_ASSERT(nstack < ntasks);
+					stack[nstack++] = dep;
+				}
+			}
+			else
+			{
+				double start = 0.;
+				int i;
+				for (i = 0; i < cur->depsn; i++)
+					if (cur->deps[i].dep->fast_finish > start)
+						start = cur->deps[i].dep->fast_finish;
+				cur->fast_finish = start + cur->fast_duration;
+				cur->fast_state = 2;
+				if (cur->fast_finish > cp)
+					cp = cur->fast_finish;
+				nstack--;
+			}
+		}
+	}
+
+	free(stack);
+	return cp;
+}
+
+#ifdef STARPU_HAVE_GLPK_H
+/* Solve the LP over task kinds and worker kinds, returns NAN on failure */
+static double _starpu_bound_fast_glp_resolve(int nt, int nc, const double *times, const unsigned long *n, const int *ncworkers, double cp)
+{
+	glp_prob *lp;
+	int ne, i, t, c;
+	int *ia, *ja;
+	double *ar;
+	double res = NAN;
+
+	lp = glp_create_prob();
+	glp_set_prob_name(lp, "StarPU theoretical bound over task kinds");
+	glp_set_obj_dir(lp, GLP_MIN);
+	glp_set_obj_name(lp, "total execution time");
+
+	/* Variables: number of tasks of kind t assigned to worker kind c, and tmax */
+	glp_add_cols(lp, nt*nc+1);
+#define fast_colnum(c, t) ((t)*nc+(c)+1)
+	glp_set_obj_coef(lp, nt*nc+1, 1.);
+	for (t = 0; t < nt; t++)
+		for (c = 0; c < nc; c++)
+		{
+			if (isnan(times[t*nc+c]))
+				glp_set_col_bnds(lp, fast_colnum(c, t), GLP_FX, 0., 0.);
+			else
+				glp_set_col_bnds(lp, fast_colnum(c, t), GLP_LO, 0., 0.);
+		}
+	/* The makespan can not be shorter than the critical path */
+	glp_set_col_bnds(lp, nt*nc+1, GLP_LO, cp, 0.);
+
+	ne = nc * (nt+1) + nt * nc + 1;
+	_STARPU_MALLOC(ia, ne * sizeof(*ia));
+	_STARPU_MALLOC(ja, ne * sizeof(*ja));
+	_STARPU_MALLOC(ar, ne * sizeof(*ar));
+	i = 1;
+
+	/* Total execution time of each worker kind, shared by its workers */
+	glp_add_rows(lp, nc);
+	for (c = 0; c < nc; c++)
+	{
+		for (t = 0; t < nt; t++)
+			if (!isnan(times[t*nc+c]))
+			{
+				ia[i] = c+1;
+				ja[i] = fast_colnum(c, t);
+				ar[i] = times[t*nc+c];
+				i++;
+			}
+		ia[i] = c+1;
+		ja[i] = nt*nc+1;
+		ar[i] = -ncworkers[c];
+		i++;
+		glp_set_row_bnds(lp, c+1, GLP_UP, 0., 0.);
+	}
+
+	/* Total task completion */
+	glp_add_rows(lp, nt);
+	for (t = 0; t < nt; t++)
+	{
+		int someone = 0;
+		for (c = 0; c < nc; c++)
+			if (!isnan(times[t*nc+c]))
+			{
+				ia[i] = nc+t+1;
+				ja[i] = fast_colnum(c, t);
+				ar[i] = 1.;
+				i++;
+				someone = 1;
+			}
+		if (someone)
+			glp_set_row_bnds(lp, nc+t+1, GLP_FX, n[t], n[t]);
+		else
+			/* No performance model at all, ignore these tasks */
+			glp_set_row_bnds(lp, nc+t+1, GLP_FR, 0., 0.);
+	}
+#undef fast_colnum
+
+	STARPU_ASSERT(i <= ne);
+	glp_load_matrix(lp, i-1, ia, ja, ar);
+
+	glp_smcp parm;
+	glp_init_smcp(&parm);
+	parm.msg_lev = GLP_MSG_OFF;
+	if (!glp_simplex(lp, &parm) && glp_get_status(lp) == GLP_OPT)
+		res = glp_get_obj_val(lp);
+
+	glp_delete_prob(lp);
+	free(ia);
+	free(ja);
+	free(ar);
+	return res;
+}
+#endif /* STARPU_HAVE_GLPK_H */
+
+/* Compute and return the fast bounds */
+void starpu_bound_compute_fast(double *area, double *critical_path, double *kinds)
+{
+	struct bound_fast_kind *kind_table = NULL, *kind, *tmp;
+	struct bound_task_pool *tp;
+	struct bound_task *t1;
+	unsigned long ntasks = 0;
+	int nw, nt = 0, nc = 0;
+	int t, c, w;
+	struct starpu_perfmodel_arch **carchs;
+	int *ccombs, *ncworkers;
+	unsigned long *n;
+	double *times, *mins;
+	double work = 0., cp = 0., res;
+
+	STARPU_PTHREAD_MUTEX_LOCK(&mutex);
+
+	nw = starpu_worker_get_count();
+
+	/* Group tasks by kind */
+	if (recorddeps)
+		for (t1 = tasks; t1; t1 = t1->next)
+		{
+			_starpu_bound_fast_get_kind(&kind_table, &nt, t1->cl, t1->footprint)->n++;
+			ntasks++;
+		}
+	else
+		for (tp = task_pools; tp; tp = tp->next)
+			_starpu_bound_fast_get_kind(&kind_table, &nt, tp->cl, tp->footprint)->n += tp->n;
+
+	if (!nw || !nt)
+	{
+		HASH_ITER(hh, kind_table, kind, tmp)
+		{
+			HASH_DEL(kind_table, kind);
+			free(kind);
+		}
+		STARPU_PTHREAD_MUTEX_UNLOCK(&mutex);
+		if (area)
+			*area = 0.;
+		if (critical_path)
+			*critical_path = 0.;
+		if (kinds)
+			*kinds = 0.;
+		return;
+	}
+
+	/* Group workers by kind */
+	_STARPU_MALLOC(carchs, nw * sizeof(*carchs));
+	_STARPU_MALLOC(ccombs, nw * sizeof(*ccombs));
+	_STARPU_CALLOC(ncworkers, nw, sizeof(*ncworkers));
+	for (w = 0; w < nw; w++)
+	{
+		struct starpu_perfmodel_arch *arch = starpu_worker_get_perf_archtype(w, STARPU_NMAX_SCHED_CTXS);
+		int comb = starpu_perfmodel_arch_comb_get(arch->ndevices, arch->devices);
+		for (c = 0; c < nc; c++)
+			if (ccombs[c] == comb)
+				break;
+		if (c == nc)
+		{
+			ccombs[c] = comb;
+			carchs[c] = arch;
+			nc++;
+		}
+		ncworkers[c]++;
+	}
+
+	/* Durations of each task kind on each worker kind */
+	_STARPU_MALLOC(times, nt * nc * sizeof(*times));
+	_STARPU_MALLOC(mins, nt * sizeof(*mins));
+	_STARPU_MALLOC(n, nt * sizeof(*n));
+	HASH_ITER(hh, kind_table, kind, tmp)
+	{
+		t = kind->index;
+		n[t] = kind->n;
+		mins[t] = NAN;
+		for (c = 0; c < nc; c++)
+		{
+			times[t*nc+c] = _starpu_get_task_time(kind->key.cl, kind->key.footprint, carchs[c]);
+			if (!isnan(times[t*nc+c]) && (isnan(mins[t]) || times[t*nc+c] < mins[t]))
+				mins[t] = times[t*nc+c];
+		}
+		/* Tasks without any performance model are ignored */
+		if (!isnan(mins[t]))
+			work += n[t] * mins[t];
+	}
+
+	if (recorddeps)
+	{
+		for (t1 = tasks; t1; t1 = t1->next)
+		{
+			t1->fast_duration = mins[_starpu_bound_fast_get_kind(&kind_table, &nt, t1->cl, t1->footprint)->index];
+			if (isnan(t1->fast_duration))
+				t1->fast_duration = 0.;
+		}
+		cp = _starpu_bound_fast_critical_path(ntasks);
+	}
+
+	res = STARPU_MAX(work / nw, cp);
+#ifdef STARPU_HAVE_GLPK_H
+	{
+		double lp_res = _starpu_bound_fast_glp_resolve(nt, nc, times, n, ncworkers, cp);
+		if (!isnan(lp_res) && lp_res > res)
+			res = lp_res;
+	}
+#endif /* STARPU_HAVE_GLPK_H */
+
+	HASH_ITER(hh, kind_table, kind, tmp)
+	{
+		HASH_DEL(kind_table, kind);
+		free(kind);
+	}
+	STARPU_PTHREAD_MUTEX_UNLOCK(&mutex);
+
+	free(carchs);
+	free(ccombs);
+	free(ncworkers);
+	free(times);
+	free(mins);
+	free(n);
+
+	if (area)
+		*area = work / nw;
+	if (critical_path)
+		*critical_path = cp;
+	if (kinds)
+		*kinds = res;
+}
@@ -0,0 +1,207 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+/*
+ * Breakdown of the runtime overhead: the main phases of the life of tasks are
+ * timestamped, and the measures are aggregated into per-worker log2
+ * histograms, which are displayed at shutdown and exposed as performance
+ * counters.
+ */
+
+#include <starpu.h>
+#include <common/config.h>
+#include <common/starpu_spinlock.h>
+#include <core/workers.h>
+#include <common/knobs.h>
+#include <profiling/overhead.h>
+
+#ifdef STARPU_OVERHEAD_BREAKDOWN
+
+#define PHASE_NAMES(prefix, suffix) \
+{ \
+	prefix "submit" suffix, \
+	prefix "implicit_deps" suffix, \
+	prefix "enforce_deps" suffix, \
+	prefix "push" suffix, \
+	prefix "pop" suffix, \
+	prefix "fetch_input" suffix, \
+	prefix "execute" suffix, \
+	prefix "termination" suffix, \
+}
+
+static const char * const phase_names[_STARPU_OVERHEAD_NPHASES] = PHASE_NAMES("", "");
+
+/* Application threads do not have a worker structure, they share these */
+static struct _starpu_overhead_stats app_stats[_STARPU_OVERHEAD_NPHASES];
+static struct _starpu_spinlock app_lock;
+
+static inline unsigned ticks_bucket(uint64_t ticks)
+{
+	unsigned bucket;
+#ifdef __GNUC__
+	bucket = ticks ? 64 - __builtin_clzll(ticks) : 0;
+#else
+	for (bucket = 0; bucket < 64 && (ticks >> bucket); bucket++)
+		;
+#endif
+	if (bucket >= _STARPU_OVERHEAD_NBUCKETS)
+		bucket = _STARPU_OVERHEAD_NBUCKETS - 1;
+	return bucket;
+}
+
+static inline void stats_add(struct _starpu_overhead_stats *stats, uint64_t ticks)
+{
+	if (!stats->count || ticks < stats->min)
+		stats->min = ticks;
+	if (ticks > stats->max)
+		stats->max = ticks;
+	stats->count++;
+	stats->cycles += ticks;
+	stats->histogram[ticks_bucket(ticks)]++;
+}
+
+void _starpu_overhead_account(struct _starpu_worker *worker, enum _starpu_overhead_phase phase, uint64_t ticks)
+{
+	if (worker)
+	{
+		/* Only the worker thread itself updates these */
+		stats_add(&worker->overhead_stats[phase], ticks);
+	}
+	else
+	{
+		_starpu_spin_lock(&app_lock);
+		stats_add(&app_stats[phase], ticks);
+		_starpu_spin_unlock(&app_lock);
+	}
+}
+
+void _starpu_overhead_init(void)
+{
+	_starpu_spin_init(&app_lock);
+	memset(app_stats, 0, sizeof(app_stats));
+}
+
+static void display_thread_stats(FILE *stream, const char *name, struct _starpu_overhead_stats *stats)
+{
+	unsigned phase, bucket;
+
+	for (phase = 0; phase < _STARPU_OVERHEAD_NPHASES; phase++)
+	{
+		if (!stats[phase].count)
+			continue;
+
+		fprintf(stream, "%-24s %-14s %10llu %12.1f %10llu %12llu\n",
+			name, phase_names[phase],
+			(unsigned long long) stats[phase].count,
+			(double) stats[phase].cycles / stats[phase].count,
+			(unsigned long long) stats[phase].min,
+			(unsigned long long) stats[phase].max);
+
+		fprintf(stream, "\thistogram:");
+		for (bucket = 0; bucket < _STARPU_OVERHEAD_NBUCKETS; bucket++)
+			if (stats[phase].histogram[bucket])
+				fprintf(stream, " <2^%u:%llu", bucket, (unsigned long long) stats[phase].histogram[bucket]);
+		fprintf(stream, "\n");
+	}
+}
+
+void _starpu_overhead_display_stats(FILE *stream)
+{
+	unsigned workerid;
+
+	if (!starpu_getenv_number_default("STARPU_OVERHEAD_STATS", 1))
+		return;
+
+	fprintf(stream, "\n#---------------------\n");
+	fprintf(stream, "Runtime overhead breakdown (in cycles):\n");
+	fprintf(stream, "%-24s %-14s %10s %12s %10s %12s\n", "thread", "phase", "count", "avg", "min", "max");
+
+	display_thread_stats(stream, "application", app_stats);
+	for (workerid = 0; workerid < starpu_worker_get_count(); workerid++)
+	{
+		char name[32];
+		starpu_worker_get_name(workerid, name, sizeof(name));
+		display_thread_stats(stream, name, _starpu_get_worker_struct(workerid)->overhead_stats);
+	}
+	fprintf(stream, "#---------------------\n");
+}
+
+/* Performance counters */
+
+static const char * const g_count_names[_STARPU_OVERHEAD_NPHASES] = PHASE_NAMES("starpu.overhead.g_", "_count");
+static const char * const g_cycles_names[_STARPU_OVERHEAD_NPHASES] = PHASE_NAMES("starpu.overhead.g_", "_cycles");
+static const char * const w_count_names[_STARPU_OVERHEAD_NPHASES] = PHASE_NAMES("starpu.overhead.w_", "_count");
+static const char * const w_cycles_names[_STARPU_OVERHEAD_NPHASES] = PHASE_NAMES("starpu.overhead.w_", "_cycles");
+
+static int g_count_ids[_STARPU_OVERHEAD_NPHASES];
+static int g_cycles_ids[_STARPU_OVERHEAD_NPHASES];
+static int w_count_ids[_STARPU_OVERHEAD_NPHASES];
+static int w_cycles_ids[_STARPU_OVERHEAD_NPHASES];
+
+static void global_sample_updater(struct starpu_perf_counter_sample *sample, void *context)
+{
+	unsigned phase;
+	STARPU_ASSERT(context == NULL); /* no context for the global updater */
+	(void)context;
+
+	for (phase = 0; phase < _STARPU_OVERHEAD_NPHASES; phase++)
+	{
+		_starpu_perf_counter_sample_set_int64_value(sample, g_count_ids[phase], app_stats[phase].count);
+		_starpu_perf_counter_sample_set_int64_value(sample, g_cycles_ids[phase], app_stats[phase].cycles);
+	}
+}
+
+static void per_worker_sample_updater(struct starpu_perf_counter_sample *sample, void *context)
+{
+	unsigned phase;
+	STARPU_ASSERT(context != NULL);
+	struct _starpu_worker *worker = context;
+
+	for (phase = 0; phase < _STARPU_OVERHEAD_NPHASES; phase++)
+	{
+		_starpu_perf_counter_sample_set_int64_value(sample, w_count_ids[phase], worker->overhead_stats[phase].count);
+		_starpu_perf_counter_sample_set_int64_value(sample, w_cycles_ids[phase], worker->overhead_stats[phase].cycles);
+	}
+}
+
+void _starpu__overhead_c__register_counters(void)
+{
+	unsigned phase;
+
+	{
+		const enum starpu_perf_counter_scope scope = starpu_perf_counter_scope_global;
+		for (phase = 0; phase < _STARPU_OVERHEAD_NPHASES; phase++)
+		{
+			g_count_ids[phase] = _starpu_perf_counter_register(scope, g_count_names[phase], starpu_perf_counter_type_int64, "number of times application threads went through this phase (since StarPU initialization)");
+			g_cycles_ids[phase] = _starpu_perf_counter_register(scope, g_cycles_names[phase], starpu_perf_counter_type_int64, "cumulated cycles spent by application threads in this phase (since StarPU initialization)");
+		}
+
+		_starpu_perf_counter_register_updater(scope, global_sample_updater);
+	}
+
+	{
+		const enum starpu_perf_counter_scope scope = starpu_perf_counter_scope_per_worker;
+		for (phase = 0; phase < _STARPU_OVERHEAD_NPHASES; phase++)
+		{
+			w_count_ids[phase] = _starpu_perf_counter_register(scope, w_count_names[phase], starpu_perf_counter_type_int64, "number of times this worker went through this phase (since StarPU initialization)");
+			w_cycles_ids[phase] = _starpu_perf_counter_register(scope, w_cycles_names[phase], starpu_perf_counter_type_int64, "cumulated cycles spent by this worker in this phase (since StarPU initialization)");
+		}
+
+		_starpu_perf_counter_register_updater(scope, per_worker_sample_updater);
+	}
+}
+
+#endif /* STARPU_OVERHEAD_BREAKDOWN */
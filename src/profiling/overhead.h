@@ -0,0 +1,108 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#ifndef __PROFILING_OVERHEAD_H__
+#define __PROFILING_OVERHEAD_H__
+
+/** @file */
+
+/* Breakdown of the runtime overhead along the life of tasks, enabled with
+ * --enable-overhead-breakdown */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <common/config.h>
+#include <time.h>
+
+#pragma GCC visibility push(hidden)
+
+struct _starpu_worker;
+
+/** Phases of the life of a task whose cost is measured */
+enum _starpu_overhead_phase
+{
+	/** Task submission, up to the implicit dependencies */
+	_STARPU_OVERHEAD_SUBMIT,
+	/** Detection of implicit data dependencies */
+	_STARPU_OVERHEAD_IMPLICIT_DEPS,
+	/** Tag, task and data dependency checks before pushing */
+	_STARPU_OVERHEAD_ENFORCE_DEPS,
+	/** Pushing the task to the scheduler */
+	_STARPU_OVERHEAD_PUSH,
+	/** Popping a task from the scheduler (only successful pops) */
+	_STARPU_OVERHEAD_POP,
+	/** Fetching the task input data on the worker */
+	_STARPU_OVERHEAD_FETCH_INPUT,
+	/** Codelet execution itself */
+	_STARPU_OVERHEAD_EXECUTE,
+	/** Task termination, including releasing dependencies and callback */
+	_STARPU_OVERHEAD_TERMINATION,
+	_STARPU_OVERHEAD_NPHASES
+};
+
+/** Number of log2 histogram buckets, the last one gathers all bigger values */
+#define _STARPU_OVERHEAD_NBUCKETS 32
+
+/** Statistics of a phase for a given thread */
+struct _starpu_overhead_stats
+{
+	uint64_t count;
+	uint64_t cycles;
+	uint64_t min;
+	uint64_t max;
+	/** bucket i counts the measures between 2^(i-1) (included) and 2^i (excluded) */
+	uint64_t histogram[_STARPU_OVERHEAD_NBUCKETS];
+};
+
+#ifdef STARPU_OVERHEAD_BREAKDOWN
+/** Read the cycle counter. This is the TSC on x86, and nanoseconds elsewhere */
+static inline uint64_t _starpu_overhead_ticks(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+	uint32_t low, high;
+	__asm__ volatile("rdtsc" : "=a" (low), "=d" (high));
+	return ((uint64_t) high << 32) | low;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/** Account \p ticks to \p phase for \p worker, or for application threads
+ * if \p worker is NULL */
+void _starpu_overhead_account(struct _starpu_worker *worker, enum _starpu_overhead_phase phase, uint64_t ticks);
+
+void _starpu_overhead_init(void);
+void _starpu_overhead_display_stats(FILE *stream);
+
+/** Register the overhead.* performance counters */
+void _starpu__overhead_c__register_counters(void);
+
+#define _STARPU_OVERHEAD_START(start) uint64_t start = _starpu_overhead_ticks()
+#define _STARPU_OVERHEAD_END_WORKER(worker, phase, start) \
+	_starpu_overhead_account((worker), (phase), _starpu_overhead_ticks() - (start))
+#define _STARPU_OVERHEAD_END(phase, start) \
+	_STARPU_OVERHEAD_END_WORKER(_starpu_get_local_worker_key(), phase, start)
+#else
+#define _STARPU_OVERHEAD_START(start) do { } while (0)
+#define _STARPU_OVERHEAD_END_WORKER(worker, phase, start) do { } while (0)
+#define _STARPU_OVERHEAD_END(phase, start) do { } while (0)
+#endif
+
+#pragma GCC visibility pop
+
+#endif // __PROFILING_OVERHEAD_H__
@@ -307,6 +307,9 @@ static void _starpu_worker_reset_profiling_info_with_lock(int workerid)
 
 	starpu_timespec_clear(&worker_info->executing_time);
 	starpu_timespec_clear(&worker_info->sleeping_time);
+	starpu_timespec_clear(&worker_info->spinning_time);
+	starpu_timespec_clear(&worker_info->yielding_time);
+	starpu_timespec_clear(&worker_info->parked_time);
 
 	worker_info->executed_tasks = 0;
 
@@ -492,6 +495,47 @@ void _starpu_worker_update_profiling_info_executing(int workerid, int executed_t
 		worker_info->executed_tasks += executed_tasks;
 }
 
+static void _starpu_timespec_accumulate_us(struct timespec *result, double us)
+{
+	struct timespec delta;
+	delta.tv_sec = (time_t) (us / 1000000.);
+	delta.tv_nsec = (long) ((us - delta.tv_sec * 1000000.) * 1000.);
+	starpu_timespec_accumulate(result, &delta);
+}
+
+void _starpu_worker_update_profiling_info_idle(int workerid, double idle_start, double spinning, double yielding, double parked)
+{
+	if (starpu_profiling_status_get())
+	{
+		struct _starpu_worker *worker = _starpu_get_worker_struct(workerid);
+		struct starpu_profiling_worker_info *worker_info = &worker->profiling_info;
+		double before;
+
+		STARPU_PTHREAD_MUTEX_LOCK(&worker->profiling_info_mutex);
+
+		/* Do not account what happened before the measurement interval,
+		 * the phases go from spinning to parked */
+		before = starpu_timing_timespec_to_us(&worker_info->start_time) - idle_start;
+		if (before > 0.)
+		{
+			double *phases[] = { &spinning, &yielding, &parked };
+			unsigned i;
+			for (i = 0; i < sizeof(phases)/sizeof(phases[0]) && before > 0.; i++)
+			{
+				double cut = *phases[i] < before ? *phases[i] : before;
+				*phases[i] -= cut;
+				before -= cut;
+			}
+		}
+
+		_starpu_timespec_accumulate_us(&worker_info->spinning_time, spinning);
+		_starpu_timespec_accumulate_us(&worker_info->yielding_time, yielding);
+		_starpu_timespec_accumulate_us(&worker_info->parked_time, parked);
+
+		STARPU_PTHREAD_MUTEX_UNLOCK(&worker->profiling_info_mutex);
+	}
+}
+
 int starpu_profiling_worker_get_info(int workerid, struct starpu_profiling_worker_info *info)
 {
 	struct _starpu_worker *worker = _starpu_get_worker_struct(workerid);
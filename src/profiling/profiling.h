@@ -39,6 +39,11 @@ struct starpu_profiling_task_info *_starpu_allocate_profiling_info_if_needed(str
  * This tells StarPU how much time was spent doing computation. */
 void _starpu_worker_update_profiling_info_executing(int workerid, int executed_tasks, uint64_t used_cycles, uint64_t stall_cycles, double consumed_energy, double flops);
 
+/** Update the per-worker profiling info after the worker was idle since
+ * idle_start. This tells StarPU how much time was spent spinning, yielding and
+ * parked, in us. */
+void _starpu_worker_update_profiling_info_idle(int workerid, double idle_start, double spinning, double yielding, double parked);
+
 /** Record the date when the worker entered this state. This permits to measure
  * how much time was spent in this state.
  * start_time is optional, if unspecified, _starpu_worker_start_state will just
@@ -156,6 +156,12 @@ void _starpu_profiling_worker_helper_display_summary(FILE *stream)
 					"scheduling: %.2lf ms\n",
 				total_time, executing_time, callback_time, waiting_time, sleeping_time, scheduling_time, overhead_time,
 				all_executing_time, all_callback_time, all_waiting_time, all_sleeping_time, all_scheduling_time);
+			double spinning_time = starpu_timing_timespec_to_us(&info.spinning_time) / 1000.;
+			double yielding_time = starpu_timing_timespec_to_us(&info.yielding_time) / 1000.;
+			double parked_time = starpu_timing_timespec_to_us(&info.parked_time) / 1000.;
+			if (spinning_time || yielding_time || parked_time)
+				fprintf(stream, "\tidle split: spinning: %.2lf ms yielding: %.2lf ms parked: %.2lf ms\n",
+					spinning_time, yielding_time, parked_time);
 			if (info.used_cycles || info.stall_cycles)
 				fprintf(stream, "\t%llu Mcy %llu Mcy stall\n", (unsigned long long)info.used_cycles/1000000, (unsigned long long)info.stall_cycles/1000000);
 			if (info.energy_consumed)
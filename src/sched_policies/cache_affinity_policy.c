@@ -0,0 +1,720 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+/*
+ * Cache affinity policy: CPU workers are grouped by the cache they share
+ * (the last level data cache by default), and each group gets its own queue.
+ * Ready tasks are pushed to the group whose cache most probably already holds
+ * their input data, i.e. data recently used by the group or used by the tasks
+ * queued there. Workers pick in their queue the task which reuses most of
+ * what their cache holds, and steal from the most loaded group when theirs is
+ * empty. The content of the caches is estimated with an LRU model of the data
+ * accessed by the tasks, the resulting hits and misses are exposed as
+ * performance counters.
+ */
+
+#include <starpu.h>
+#include <starpu_scheduler.h>
+#include <starpu_bitmap.h>
+#include <common/uthash.h>
+#include <core/workers.h>
+#include <core/sched_policy.h>
+#include <common/knobs.h>
+
+#ifdef STARPU_HAVE_HWLOC
+#include <hwloc.h>
+#endif
+
+/* Number of data remembered in the cache model of a group */
+#define CACHE_MODEL_ENTRIES 128
+
+/* Number of queued tasks considered when a worker picks a task */
+#define POP_WINDOW 16
+
+struct cache_entry
+{
+	starpu_data_handle_t handle;
+	size_t size;
+	unsigned long stamp;
+};
+
+/* Data accessed by the tasks queued in a group */
+struct queued_data
+{
+	starpu_data_handle_t handle;
+	unsigned refs;
+	UT_hash_handle hh;
+};
+
+/* A group of workers sharing a cache */
+struct cache_domain
+{
+	/* The shared cache, NULL when it is not known */
+	void *obj;
+	/* Its size, 0 when it is not known */
+	size_t cache_size;
+	unsigned nworkers;
+
+	struct starpu_task_list tasks;
+	unsigned ntasks;
+	struct queued_data *queued;
+
+	/* LRU model of the cache content */
+	struct cache_entry entries[CACHE_MODEL_ENTRIES];
+	unsigned nentries;
+	size_t cached_bytes;
+	unsigned long clock;
+};
+
+struct _starpu_cache_affinity_data
+{
+	starpu_pthread_mutex_t policy_mutex;
+	struct starpu_bitmap waiters;
+	struct cache_domain *domains;
+	unsigned ndomains;
+	int domain_of_worker[STARPU_NMAXWORKERS];
+	/* Cache level on which workers are grouped, 0 for the last level */
+	unsigned level;
+};
+
+/* Estimated cache reuse, per worker */
+static starpu_perf_counter_int64_t cache_hits[STARPU_NMAXWORKERS];
+static starpu_perf_counter_int64_t cache_misses[STARPU_NMAXWORKERS];
+static starpu_perf_counter_int64_t cache_hit_bytes[STARPU_NMAXWORKERS];
+static starpu_perf_counter_int64_t cache_miss_bytes[STARPU_NMAXWORKERS];
+
+static struct cache_entry *cache_lookup(struct cache_domain *domain, starpu_data_handle_t handle)
+{
+	unsigned i;
+	for (i = 0; i < domain->nentries; i++)
+		if (domain->entries[i].handle == handle)
+			return &domain->entries[i];
+	return NULL;
+}
+
+static void cache_evict(struct cache_domain *domain, unsigned i)
+{
+	domain->cached_bytes -= domain->entries[i].size;
+	domain->entries[i] = domain->entries[--domain->nentries];
+}
+
+/* Record that handle was just accessed by a worker of the group */
+static void cache_touch(struct cache_domain *domain, starpu_data_handle_t handle, size_t size)
+{
+	struct cache_entry *entry = cache_lookup(domain, handle);
+	if (entry)
+	{
+		entry->stamp = ++domain->clock;
+		return;
+	}
+
+	/* Evict the least recently used data until it fits */
+	while (domain->nentries && (domain->nentries == CACHE_MODEL_ENTRIES || domain->cached_bytes + size > domain->cache_size))
+	{
+		unsigned i, oldest = 0;
+		for (i = 1; i < domain->nentries; i++)
+			if (domain->entries[i].stamp < domain->entries[oldest].stamp)
+				oldest = i;
+		cache_evict(domain, oldest);
+	}
+
+	entry = &domain->entries[domain->nentries++];
+	entry->handle = handle;
+	entry->size = size;
+	entry->stamp = ++domain->clock;
+	domain->cached_bytes += size;
+}
+
+/* Only data which fit in the cache can be reused from it */
+static int fits_in_cache(struct cache_domain *domain, size_t size)
+{
+	return domain->cache_size && size <= domain->cache_size;
+}
+
+/* Bytes of the input of task which are probably in the cache of the group */
+static size_t cached_input_bytes(struct cache_domain *domain, struct starpu_task *task)
+{
+	unsigned nbuffers = STARPU_TASK_GET_NBUFFERS(task);
+	unsigned i;
+	size_t bytes = 0;
+
+	for (i = 0; i < nbuffers; i++)
+	{
+		starpu_data_handle_t handle = STARPU_TASK_GET_HANDLE(task, i);
+		struct cache_entry *entry = cache_lookup(domain, handle);
+		if (entry)
+			bytes += entry->size;
+	}
+	return bytes;
+}
+
+/* Bytes of the input of task which the group probably has or will soon have
+ * in its cache */
+static size_t affinity_bytes(struct cache_domain *domain, struct starpu_task *task)
+{
+	unsigned nbuffers = STARPU_TASK_GET_NBUFFERS(task);
+	unsigned i;
+	size_t bytes = 0;
+
+	if (!domain->cache_size)
+		return 0;
+
+	for (i = 0; i < nbuffers; i++)
+	{
+		starpu_data_handle_t handle = STARPU_TASK_GET_HANDLE(task, i);
+		size_t size = starpu_data_get_size(handle);
+		struct queued_data *queued;
+
+		if (!fits_in_cache(domain, size))
+			continue;
+
+		HASH_FIND_PTR(domain->queued, &handle, queued);
+		if (queued || cache_lookup(domain, handle))
+			bytes += size;
+	}
+	return bytes;
+}
+
+static void domain_enqueue(struct cache_domain *domain, struct starpu_task *task)
+{
+	unsigned nbuffers = task->cl ? STARPU_TASK_GET_NBUFFERS(task) : 0;
+	unsigned i;
+
+	starpu_task_list_push_back(&domain->tasks, task);
+	domain->ntasks++;
+
+	for (i = 0; i < nbuffers; i++)
+	{
+		starpu_data_handle_t handle = STARPU_TASK_GET_HANDLE(task, i);
+		struct queued_data *queued;
+
+		HASH_FIND_PTR(domain->queued, &handle, queued);
+		if (!queued)
+		{
+			_STARPU_MALLOC(queued, sizeof(*queued));
+			queued->handle = handle;
+			queued->refs = 0;
+			HASH_ADD_PTR(domain->queued, handle, queued);
+		}
+		queued->refs++;
+	}
+}
+
+static void domain_dequeue(struct cache_domain *domain, struct starpu_task *task)
+{
+	unsigned nbuffers = task->cl ? STARPU_TASK_GET_NBUFFERS(task) : 0;
+	unsigned i;
+
+	starpu_task_list_erase(&domain->tasks, task);
+	domain->ntasks--;
+
+	for (i = 0; i < nbuffers; i++)
+	{
+		starpu_data_handle_t handle = STARPU_TASK_GET_HANDLE(task, i);
+		struct queued_data *queued;
+
+		HASH_FIND_PTR(domain->queued, &handle, queued);
+		STARPU_ASSERT(queued);
+		if (!--queued->refs)
+		{
+			HASH_DEL(domain->queued, queued);
+			free(queued);
+		}
+	}
+}
+
+/* Whether some worker of the group can execute task */
+static int domain_can_execute(struct _starpu_cache_affinity_data *data, unsigned sched_ctx_id, int d, struct starpu_task *task)
+{
+	struct starpu_worker_collection *workers = starpu_sched_ctx_get_worker_collection(sched_ctx_id);
+	struct starpu_sched_ctx_iterator it;
+
+	workers->init_iterator(workers, &it);
+	while(workers->has_next(workers, &it))
+	{
+		unsigned worker = workers->get_next(workers, &it);
+		if (data->domain_of_worker[worker] == d && starpu_worker_can_execute_task_first_impl(worker, task, NULL))
+			return 1;
+	}
+	return 0;
+}
+
+static int push_task_cache_affinity_policy(struct starpu_task *task)
+{
+	unsigned sched_ctx_id = task->sched_ctx;
+	struct _starpu_cache_affinity_data *data = (struct _starpu_cache_affinity_data*)starpu_sched_ctx_get_policy_data(sched_ctx_id);
+	struct starpu_worker_collection *workers = starpu_sched_ctx_get_worker_collection(sched_ctx_id);
+	struct starpu_sched_ctx_iterator it;
+	int best = -1, d;
+	size_t best_bytes = 0;
+	double best_load = 0.;
+	double min_load = -1.;
+
+	starpu_worker_relax_on();
+	STARPU_PTHREAD_MUTEX_LOCK(&data->policy_mutex);
+	starpu_worker_relax_off();
+
+	/* Load of the least loaded group, to avoid piling tasks on a group only
+	 * for the sake of affinity */
+	for (d = 0; d < (int) data->ndomains; d++)
+	{
+		struct cache_domain *domain = &data->domains[d];
+		double load;
+		if (!domain->nworkers || !domain_can_execute(data, sched_ctx_id, d, task))
+			continue;
+		load = (double) domain->ntasks / domain->nworkers;
+		if (min_load < 0. || load < min_load)
+			min_load = load;
+	}
+
+	for (d = 0; d < (int) data->ndomains; d++)
+	{
+		struct cache_domain *domain = &data->domains[d];
+		double load;
+		size_t bytes;
+
+		if (!domain->nworkers)
+			continue;
+		load = (double) domain->ntasks / domain->nworkers;
+		if (load > min_load + POP_WINDOW)
+			/* Too loaded already, the data would be out of the cache
+			 * by the time the task gets executed */
+			continue;
+		if (!domain_can_execute(data, sched_ctx_id, d, task))
+			continue;
+
+		bytes = task->cl ? affinity_bytes(domain, task) : 0;
+		if (best == -1 || bytes > best_bytes || (bytes == best_bytes && load < best_load))
+		{
+			best = d;
+			best_bytes = bytes;
+			best_load = load;
+		}
+	}
+
+	if (best == -1)
+	{
+		/* Nobody can run it yet, just queue it somewhere, it will be
+		 * stolen */
+		for (d = 0; d < (int) data->ndomains; d++)
+			if (data->domains[d].nworkers)
+			{
+				best = d;
+				break;
+			}
+		if (best == -1)
+			best = 0;
+	}
+	STARPU_ASSERT(data->ndomains);
+
+	domain_enqueue(&data->domains[best], task);
+
+	if (_starpu_get_nsched_ctxs() > 1)
+	{
+		starpu_worker_relax_on();
+		_starpu_sched_ctx_lock_write(sched_ctx_id);
+		starpu_worker_relax_off();
+		starpu_sched_ctx_list_task_counters_increment_all_ctx_locked(task, sched_ctx_id);
+		_starpu_sched_ctx_unlock_write(sched_ctx_id);
+	}
+
+	starpu_push_task_end(task);
+
+	/* Wake a worker of the chosen group first, then any other */
+#ifndef STARPU_NON_BLOCKING_DRIVERS
+	char dowake[STARPU_NMAXWORKERS] = { 0 };
+#endif
+	int pass;
+	for (pass = 0; pass < 2; pass++)
+	{
+		int found = 0;
+		workers->init_iterator(workers, &it);
+		while(workers->has_next(workers, &it))
+		{
+			unsigned worker = workers->get_next(workers, &it);
+
+			if ((data->domain_of_worker[worker] == best) != (pass == 0))
+				continue;
+
+#ifdef STARPU_NON_BLOCKING_DRIVERS
+			if (!starpu_bitmap_get(&data->waiters, worker))
+				/* This worker is not waiting for a task */
+				continue;
+#endif
+
+			if (starpu_worker_can_execute_task_first_impl(worker, task, NULL))
+			{
+#ifdef STARPU_NON_BLOCKING_DRIVERS
+				starpu_bitmap_unset(&data->waiters, worker);
+				found = 1;
+				break;
+#else
+				dowake[worker] = 1 + pass;
+#endif
+			}
+		}
+		if (found)
+			break;
+	}
+	STARPU_PTHREAD_MUTEX_UNLOCK(&data->policy_mutex);
+
+#if !defined(STARPU_NON_BLOCKING_DRIVERS) || defined(STARPU_SIMGRID)
+	for (pass = 0; pass < 2; pass++)
+	{
+		workers->init_iterator(workers, &it);
+		while(workers->has_next(workers, &it))
+		{
+			unsigned worker = workers->get_next(workers, &it);
+			if (dowake[worker] == 1 + pass)
+				if (starpu_wake_worker_relax_light(worker))
+					return 0; // wake up a single worker
+		}
+	}
+#endif
+
+	return 0;
+}
+
+/* Pick in the queue of domain the task which workerid can run and which best
+ * reuses the cache of cache_domain */
+static struct starpu_task *pick_task(struct cache_domain *domain, struct cache_domain *cache_domain, unsigned workerid, int from_tail)
+{
+	struct starpu_task *task, *best_task = NULL;
+	unsigned best_impl = 0;
+	size_t best_bytes = 0;
+	unsigned n = 0;
+
+	for (task = from_tail ? starpu_task_list_back(&domain->tasks) : starpu_task_list_begin(&domain->tasks);
+	     task && n < POP_WINDOW;
+	     task = from_tail ? task->prev : starpu_task_list_next(task))
+	{
+		unsigned nimpl;
+		size_t bytes;
+
+		if (!starpu_worker_can_execute_task_first_impl(workerid, task, &nimpl))
+			continue;
+		n++;
+
+		bytes = (cache_domain && task->cl) ? cached_input_bytes(cache_domain, task) : 0;
+		if (!best_task || bytes > best_bytes)
+		{
+			best_task = task;
+			best_impl = nimpl;
+			best_bytes = bytes;
+		}
+		if (!cache_domain || !cache_domain->cache_size)
+			/* No cache information, keep the FIFO order */
+			break;
+	}
+
+	if (best_task)
+	{
+		domain_dequeue(domain, best_task);
+		starpu_task_set_implementation(best_task, best_impl);
+	}
+	return best_task;
+}
+
+/* Account the cache hits and misses of task on workerid, and update the
+ * cache model */
+static void account_task(struct cache_domain *domain, struct starpu_task *task, unsigned workerid)
+{
+	unsigned nbuffers = STARPU_TASK_GET_NBUFFERS(task);
+	unsigned i;
+
+	if (!domain->cache_size)
+		return;
+
+	for (i = 0; i < nbuffers; i++)
+	{
+		starpu_data_handle_t handle = STARPU_TASK_GET_HANDLE(task, i);
+		size_t size = starpu_data_get_size(handle);
+
+		if (cache_lookup(domain, handle))
+		{
+			cache_hits[workerid]++;
+			cache_hit_bytes[workerid] += size;
+		}
+		else
+		{
+			cache_misses[workerid]++;
+			cache_miss_bytes[workerid] += size;
+		}
+
+		if (fits_in_cache(domain, size))
+			cache_touch(domain, handle, size);
+	}
+}
+
+static struct starpu_task *pop_task_cache_affinity_policy(unsigned sched_ctx_id)
+{
+	struct starpu_task *chosen_task = NULL;
+	unsigned workerid = starpu_worker_get_id_check();
+	struct _starpu_cache_affinity_data *data = (struct _starpu_cache_affinity_data*)starpu_sched_ctx_get_policy_data(sched_ctx_id);
+	struct cache_domain *domain = NULL;
+	int d = data->domain_of_worker[workerid];
+
+#ifdef STARPU_NON_BLOCKING_DRIVERS
+	if (!STARPU_RUNNING_ON_VALGRIND && starpu_bitmap_get(&data->waiters, workerid))
+		/* Nobody woke us, avoid bothering the mutex */
+		return NULL;
+#endif
+
+	starpu_worker_relax_on();
+	STARPU_PTHREAD_MUTEX_LOCK(&data->policy_mutex);
+	starpu_worker_relax_off();
+
+	if (d >= 0)
+	{
+		domain = &data->domains[d];
+		chosen_task = pick_task(domain, domain, workerid, 0);
+	}
+
+	if (!chosen_task)
+	{
+		/* Steal from the most loaded group */
+		unsigned *tried;
+		unsigned ntried = 0;
+		_STARPU_CALLOC(tried, data->ndomains, sizeof(*tried));
+		while (!chosen_task && ntried < data->ndomains)
+		{
+			int victim = -1;
+			unsigned v;
+			for (v = 0; v < data->ndomains; v++)
+			{
+				if ((int) v == d || tried[v] || !data->domains[v].ntasks)
+					continue;
+				if (victim == -1 || data->domains[v].ntasks > data->domains[victim].ntasks)
+					victim = v;
+			}
+			if (victim == -1)
+				break;
+			tried[victim] = 1;
+			ntried++;
+			/* Take the tasks which the victim would run last */
+			chosen_task = pick_task(&data->domains[victim], domain, workerid, 1);
+		}
+		free(tried);
+	}
+
+	if (chosen_task && domain && chosen_task->cl)
+		account_task(domain, chosen_task, workerid);
+
+	if (!chosen_task)
+		/* Tell pushers that we are waiting for tasks for us */
+		starpu_bitmap_set(&data->waiters, workerid);
+
+	STARPU_PTHREAD_MUTEX_UNLOCK(&data->policy_mutex);
+
+	if (chosen_task && _starpu_get_nsched_ctxs() > 1)
+	{
+		starpu_worker_relax_on();
+		_starpu_sched_ctx_lock_write(sched_ctx_id);
+		starpu_worker_relax_off();
+		starpu_sched_ctx_list_task_counters_decrement_all_ctx_locked(chosen_task, sched_ctx_id);
+
+		if (_starpu_sched_ctx_worker_is_master_for_child_ctx(sched_ctx_id, workerid, chosen_task))
+			chosen_task = NULL;
+		_starpu_sched_ctx_unlock_write(sched_ctx_id);
+	}
+
+	return chosen_task;
+}
+
+#ifdef STARPU_HAVE_HWLOC
+/* Whether obj is a data cache of the requested level (0 for any) */
+static int is_data_cache(hwloc_obj_t obj, unsigned level)
+{
+#if HWLOC_API_VERSION >= 0x00020000
+	if (!hwloc_obj_type_is_dcache(obj->type))
+		return 0;
+#else
+	if (obj->type != HWLOC_OBJ_CACHE || obj->attr->cache.type == HWLOC_OBJ_CACHE_INSTRUCTION)
+		return 0;
+#endif
+	return !level || obj->attr->cache.depth == level;
+}
+
+/* The cache shared by the group of workerid, NULL if not known */
+static hwloc_obj_t worker_cache(unsigned workerid, unsigned level)
+{
+	struct _starpu_worker *worker = _starpu_get_worker_struct(workerid);
+	hwloc_obj_t obj, cache = NULL;
+
+	if (worker->arch != STARPU_CPU_WORKER || !worker->hwloc_obj)
+		return NULL;
+
+	for (obj = worker->hwloc_obj; obj; obj = obj->parent)
+		if (is_data_cache(obj, level))
+		{
+			cache = obj;
+			if (level)
+				break;
+			/* Keep the last level by default */
+		}
+	return cache;
+}
+#endif
+
+static void cache_affinity_add_workers(unsigned sched_ctx_id, int *workerids, unsigned nworkers)
+{
+	struct _starpu_cache_affinity_data *data = (struct _starpu_cache_affinity_data*)starpu_sched_ctx_get_policy_data(sched_ctx_id);
+	unsigned i;
+
+	STARPU_PTHREAD_MUTEX_LOCK(&data->policy_mutex);
+	for (i = 0; i < nworkers; i++)
+	{
+		int workerid = workerids[i];
+		void *obj = NULL;
+		size_t cache_size = 0;
+		unsigned d;
+
+#ifdef STARPU_HAVE_HWLOC
+		hwloc_obj_t cache = worker_cache(workerid, data->level);
+		if (cache)
+		{
+			obj = cache;
+			cache_size = cache->attr->cache.size;
+		}
+#endif
+
+		/* Workers without a known cache get a group of their own */
+		for (d = 0; d < data->ndomains; d++)
+			if (obj && data->domains[d].obj == obj)
+				break;
+		if (d == data->ndomains)
+		{
+			_STARPU_REALLOC(data->domains, (data->ndomains + 1) * sizeof(*data->domains));
+			memset(&data->domains[d], 0, sizeof(data->domains[d]));
+			data->domains[d].obj = obj;
+			data->domains[d].cache_size = cache_size;
+			starpu_task_list_init(&data->domains[d].tasks);
+			data->ndomains++;
+		}
+		data->domains[d].nworkers++;
+		data->domain_of_worker[workerid] = d;
+		_STARPU_DEBUG("worker %d uses cache group %u (%lu bytes)\n", workerid, d, (unsigned long) cache_size);
+	}
+	STARPU_PTHREAD_MUTEX_UNLOCK(&data->policy_mutex);
+
+	for (i = 0; i < nworkers; i++)
+	{
+		int workerid = workerids[i];
+		int curr_workerid = _starpu_worker_get_id();
+		if(workerid != curr_workerid)
+			starpu_wake_worker_locked(workerid);
+
+		starpu_sched_ctx_worker_shares_tasks_lists(workerid, sched_ctx_id);
+	}
+}
+
+static void cache_affinity_remove_workers(unsigned sched_ctx_id, int *workerids, unsigned nworkers)
+{
+	struct _starpu_cache_affinity_data *data = (struct _starpu_cache_affinity_data*)starpu_sched_ctx_get_policy_data(sched_ctx_id);
+	unsigned i;
+
+	/* The tasks of groups which become empty will be stolen */
+	STARPU_PTHREAD_MUTEX_LOCK(&data->policy_mutex);
+	for (i = 0; i < nworkers; i++)
+	{
+		int d = data->domain_of_worker[workerids[i]];
+		if (d >= 0)
+		{
+			data->domains[d].nworkers--;
+			data->domain_of_worker[workerids[i]] = -1;
+		}
+	}
+	STARPU_PTHREAD_MUTEX_UNLOCK(&data->policy_mutex);
+}
+
+static void initialize_cache_affinity_policy(unsigned sched_ctx_id)
+{
+	struct _starpu_cache_affinity_data *data;
+	unsigned i;
+
+	_STARPU_CALLOC(data, 1, sizeof(struct _starpu_cache_affinity_data));
+	STARPU_PTHREAD_MUTEX_INIT(&data->policy_mutex, NULL);
+	starpu_bitmap_init(&data->waiters);
+	for (i = 0; i < STARPU_NMAXWORKERS; i++)
+		data->domain_of_worker[i] = -1;
+	data->level = starpu_getenv_number_default("STARPU_SCHED_CACHE_LEVEL", 0);
+
+	starpu_sched_ctx_set_policy_data(sched_ctx_id, (void*)data);
+}
+
+static void deinitialize_cache_affinity_policy(unsigned sched_ctx_id)
+{
+	struct _starpu_cache_affinity_data *data = (struct _starpu_cache_affinity_data*)starpu_sched_ctx_get_policy_data(sched_ctx_id);
+	unsigned d;
+
+	for (d = 0; d < data->ndomains; d++)
+	{
+		struct queued_data *queued, *tmp;
+		STARPU_ASSERT(starpu_task_list_empty(&data->domains[d].tasks));
+		HASH_ITER(hh, data->domains[d].queued, queued, tmp)
+		{
+			HASH_DEL(data->domains[d].queued, queued);
+			free(queued);
+		}
+	}
+	free(data->domains);
+	STARPU_PTHREAD_MUTEX_DESTROY(&data->policy_mutex);
+	free(data);
+}
+
+struct starpu_sched_policy _starpu_sched_cache_affinity_policy =
+{
+	.init_sched = initialize_cache_affinity_policy,
+	.deinit_sched = deinitialize_cache_affinity_policy,
+	.add_workers = cache_affinity_add_workers,
+	.remove_workers = cache_affinity_remove_workers,
+	.push_task = push_task_cache_affinity_policy,
+	.pop_task = pop_task_cache_affinity_policy,
+	.pre_exec_hook = NULL,
+	.post_exec_hook = NULL,
+	.policy_name = "cache-affinity",
+	.policy_description = "groups tasks sharing data on workers sharing a cache",
+	.worker_type = STARPU_WORKER_LIST,
+};
+
+/* Performance counters */
+
+static int __w_cache_hits;
+static int __w_cache_misses;
+static int __w_cache_hit_bytes;
+static int __w_cache_miss_bytes;
+
+static void per_worker_sample_updater(struct starpu_perf_counter_sample *sample, void *context)
+{
+	STARPU_ASSERT(context != NULL);
+	struct _starpu_worker *worker = context;
+
+	_starpu_perf_counter_sample_set_int64_value(sample, __w_cache_hits, cache_hits[worker->workerid]);
+	_starpu_perf_counter_sample_set_int64_value(sample, __w_cache_misses, cache_misses[worker->workerid]);
+	_starpu_perf_counter_sample_set_int64_value(sample, __w_cache_hit_bytes, cache_hit_bytes[worker->workerid]);
+	_starpu_perf_counter_sample_set_int64_value(sample, __w_cache_miss_bytes, cache_miss_bytes[worker->workerid]);
+}
+
+void _starpu__cache_affinity_policy_c__register_counters(void)
+{
+	const enum starpu_perf_counter_scope scope = starpu_perf_counter_scope_per_worker;
+	__STARPU_PERF_COUNTER_REG("starpu.sched.cache_affinity", scope, w_cache_hits, int64, "estimated number of task data found in the cache of this worker by the cache-affinity policy (since StarPU initialization)");
+	__STARPU_PERF_COUNTER_REG("starpu.sched.cache_affinity", scope, w_cache_misses, int64, "estimated number of task data not found in the cache of this worker by the cache-affinity policy (since StarPU initialization)");
+	__STARPU_PERF_COUNTER_REG("starpu.sched.cache_affinity", scope, w_cache_hit_bytes, int64, "estimated bytes of task data found in the cache of this worker by the cache-affinity policy (since StarPU initialization)");
+	__STARPU_PERF_COUNTER_REG("starpu.sched.cache_affinity", scope, w_cache_miss_bytes, int64, "estimated bytes of task data not found in the cache of this worker by the cache-affinity policy (since StarPU initialization)");
+
+	_starpu_perf_counter_register_updater(scope, per_worker_sample_updater);
+}
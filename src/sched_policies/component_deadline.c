@@ -0,0 +1,265 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+/* Deadline component: tasks which have a deadline are kept sorted by their
+ * latest start time, i.e. their deadline minus their expected length (least
+ * laxity first), or just by their deadline (earliest deadline first) when the
+ * length is not known. When a deadline is put on a whole DAG, the tasks of
+ * the DAG also have to leave time for their successors, so when the critical
+ * path is maintained (STARPU_CRITICAL_PATH), the expected length of the
+ * remaining path after the task is subtracted too. Otherwise, only deadlines
+ * which apply to the task alone are meaningful. Tasks with a deadline are
+ * always given before the tasks without a deadline, which are kept in a
+ * priority queue. */
+
+#include <starpu_sched_component.h>
+#include <starpu_scheduler.h>
+#include <schedulers/starpu_scheduler_toolbox.h>
+#include <core/workers.h>
+#include <core/task.h>
+#include <common/graph.h>
+#include <sched_policies/prio_deque.h>
+
+struct deadline_entry
+{
+	double key;
+	struct starpu_task *task;
+};
+
+struct _starpu_deadline_data
+{
+	/* Tasks with a deadline, sorted by increasing key */
+	struct deadline_entry *entries;
+	unsigned nentries;
+	unsigned size;
+	/* Tasks without a deadline */
+	struct starpu_st_prio_deque batch;
+	starpu_pthread_mutex_t mutex;
+	int laxity;
+};
+
+/* Date at which task has to start at the latest to meet its deadline */
+static double deadline_key(struct starpu_sched_component *component, struct starpu_task *task)
+{
+	struct _starpu_deadline_data *data = component->data;
+	double length = NAN;
+	double remaining;
+	int workerid;
+
+	if (!data->laxity || !task->cl)
+		return task->deadline;
+
+	/* Optimistically, the task will run on the fastest worker */
+	for(workerid = starpu_bitmap_first(&component->workers_in_ctx);
+	    workerid != -1;
+	    workerid = starpu_bitmap_next(&component->workers_in_ctx, workerid))
+	{
+		unsigned nimpl;
+		for (nimpl = 0; nimpl < STARPU_MAXIMPLEMENTATIONS; nimpl++)
+		{
+			double d;
+			if (!starpu_worker_can_execute_task(workerid, task, nimpl))
+				continue;
+			d = starpu_task_worker_expected_length(task, workerid, component->tree->sched_ctx_id, nimpl);
+			if (!isnan(d) && (isnan(length) || d < length))
+				length = d;
+		}
+	}
+
+	if (isnan(length))
+		/* Not calibrated yet */
+		length = 0.;
+	if (_starpu_graph_task_remaining_path(task, &remaining))
+		/* The successors have to complete before the deadline too */
+		length += remaining;
+	return task->deadline - length;
+}
+
+static void deadline_insert(struct _starpu_deadline_data *data, struct starpu_task *task, double key, int front)
+{
+	unsigned lo = 0, hi = data->nentries;
+
+	if (data->nentries == data->size)
+	{
+		data->size = data->size ? data->size * 2 : 16;
+		_STARPU_REALLOC(data->entries, data->size * sizeof(*data->entries));
+	}
+
+	/* Find the insertion point, after the tasks with the same key, or
+	 * before them when pushing back a task */
+	while (lo < hi)
+	{
+		unsigned mid = (lo + hi) / 2;
+		if (data->entries[mid].key < key || (!front && data->entries[mid].key == key))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	memmove(&data->entries[lo + 1], &data->entries[lo], (data->nentries - lo) * sizeof(*data->entries));
+	data->entries[lo].key = key;
+	data->entries[lo].task = task;
+	data->nentries++;
+}
+
+static void deadline_push_local_task(struct starpu_sched_component *component, struct starpu_task *task, int is_pushback)
+{
+	struct _starpu_deadline_data *data = component->data;
+	double key = 0.;
+
+	if (task->deadline != 0.)
+		/* Compute the key before taking the lock, it may query the
+		 * performance models */
+		key = deadline_key(component, task);
+
+	STARPU_COMPONENT_MUTEX_LOCK(&data->mutex);
+	if (task->deadline != 0.)
+		deadline_insert(data, task, key, is_pushback);
+	else if (is_pushback)
+		starpu_st_prio_deque_push_front_task(&data->batch, task);
+	else
+		starpu_st_prio_deque_push_back_task(&data->batch, task);
+	if (!is_pushback)
+		starpu_sched_component_prefetch_on_node(component, task);
+	STARPU_COMPONENT_MUTEX_UNLOCK(&data->mutex);
+}
+
+static int deadline_push_task(struct starpu_sched_component *component, struct starpu_task *task)
+{
+	STARPU_ASSERT(component && component->data && task);
+	STARPU_ASSERT(starpu_sched_component_can_execute_task(component,task));
+
+	deadline_push_local_task(component, task, 0);
+	component->can_pull(component);
+	return 0;
+}
+
+static struct starpu_task *deadline_pull_task(struct starpu_sched_component *component, struct starpu_sched_component *to)
+{
+	STARPU_ASSERT(component && component->data);
+	struct _starpu_deadline_data *data = component->data;
+	struct starpu_task *task = NULL;
+	unsigned i;
+
+	if (!STARPU_RUNNING_ON_VALGRIND && !data->nentries && starpu_st_prio_deque_is_empty(&data->batch))
+	{
+		starpu_sched_component_send_can_push_to_parents(component);
+		return NULL;
+	}
+
+	STARPU_COMPONENT_MUTEX_LOCK(&data->mutex);
+
+	/* Tasks with a deadline first, they overtake all batch tasks */
+	for (i = 0; i < data->nentries; i++)
+	{
+		if (!to || starpu_sched_component_can_execute_task(to, data->entries[i].task))
+		{
+			task = data->entries[i].task;
+			data->nentries--;
+			memmove(&data->entries[i], &data->entries[i + 1], (data->nentries - i) * sizeof(*data->entries));
+			break;
+		}
+	}
+
+	if (!task)
+	{
+		struct starpu_task *t;
+		for (t  = starpu_task_prio_list_begin(&data->batch.list);
+		     t != starpu_task_prio_list_end(&data->batch.list);
+		     t  = starpu_task_prio_list_next(&data->batch.list, t))
+		{
+			if (!to || starpu_sched_component_can_execute_task(to, t))
+			{
+				task = t;
+				starpu_st_prio_deque_erase(&data->batch, task);
+				data->batch.ntasks--;
+				break;
+			}
+		}
+	}
+
+	STARPU_COMPONENT_MUTEX_UNLOCK(&data->mutex);
+
+	starpu_sched_component_send_can_push_to_parents(component);
+
+	return task;
+}
+
+/* Children tell us that they have room, give them tasks, in our order */
+static int deadline_can_push(struct starpu_sched_component *component, struct starpu_sched_component *to STARPU_ATTRIBUTE_UNUSED)
+{
+	STARPU_ASSERT(component && starpu_sched_component_is_deadline(component));
+	int res = 0;
+	struct starpu_task *task;
+
+	if (component->nchildren != 1)
+		/* Several children, let them pull what they can run */
+		return 0;
+
+	task = starpu_sched_component_pump_downstream(component, &res);
+	if (task)
+		deadline_push_local_task(component, task, 1);
+
+	return res;
+}
+
+static double deadline_estimated_load(struct starpu_sched_component *component)
+{
+	struct _starpu_deadline_data *data = component->data;
+	double load = starpu_sched_component_estimated_load(component);
+	unsigned nworkers = starpu_bitmap_cardinal(&component->workers_in_ctx);
+
+	STARPU_ASSERT(nworkers != 0);
+	STARPU_COMPONENT_MUTEX_LOCK(&data->mutex);
+	load += (double) (data->nentries + data->batch.ntasks) / nworkers;
+	STARPU_COMPONENT_MUTEX_UNLOCK(&data->mutex);
+	return load;
+}
+
+static void deadline_component_deinit_data(struct starpu_sched_component *component)
+{
+	STARPU_ASSERT(component && component->data);
+	struct _starpu_deadline_data *data = component->data;
+	STARPU_ASSERT(!data->nentries);
+	free(data->entries);
+	starpu_st_prio_deque_destroy(&data->batch);
+	STARPU_PTHREAD_MUTEX_DESTROY(&data->mutex);
+	free(data);
+}
+
+int starpu_sched_component_is_deadline(struct starpu_sched_component *component)
+{
+	return component->push_task == deadline_push_task;
+}
+
+struct starpu_sched_component *starpu_sched_component_deadline_create(struct starpu_sched_tree *tree, struct starpu_sched_component_deadline_data *params)
+{
+	struct starpu_sched_component *component = starpu_sched_component_create(tree, "deadline");
+	struct _starpu_deadline_data *data;
+	_STARPU_CALLOC(data, 1, sizeof(*data));
+	starpu_st_prio_deque_init(&data->batch);
+	STARPU_PTHREAD_MUTEX_INIT(&data->mutex, NULL);
+	data->laxity = params ? params->laxity : 1;
+
+	component->data = data;
+	component->push_task = deadline_push_task;
+	component->pull_task = deadline_pull_task;
+	component->can_push = deadline_can_push;
+	component->estimated_load = deadline_estimated_load;
+	component->deinit_data = deadline_component_deinit_data;
+
+	return component;
+}
@@ -96,7 +96,7 @@ static int heft_progress_one(struct starpu_sched_component *component)
 		{
 			unsigned offset = component->nchildren * n;
 
-			nsuitable_components[n] = starpu_mct_compute_execution_times(component, tasks[n],
+			nsuitable_components[n] = starpu_mct_compute_execution_times(d, component, tasks[n],
 					estimated_lengths + offset,
 					estimated_transfer_length + offset,
 					suitable_components + offset);
@@ -215,7 +215,7 @@ static void heft_component_deinit_data(struct starpu_sched_component * component
 	struct _starpu_heft_data * d = component->data;
 	struct _starpu_mct_data * mct_d = d->mct_data;
 	starpu_st_prio_deque_destroy(&d->prio);
-	free(mct_d);
+	starpu_mct_deinit_parameters(mct_d);
 	free(d);
 }
 
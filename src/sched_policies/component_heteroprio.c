@@ -119,7 +119,7 @@ static int heteroprio_progress_accel(struct starpu_sched_component *component, s
 	unsigned suitable_components[component->nchildren];
 	unsigned nsuitable_components;
 
-	nsuitable_components = starpu_mct_compute_execution_times(component, task,
+	nsuitable_components = starpu_mct_compute_execution_times(d, component, task,
 			estimated_lengths,
 			estimated_transfer_length,
 			suitable_components);
@@ -265,7 +265,7 @@ static int heteroprio_progress_noaccel(struct starpu_sched_component *component,
 	unsigned suitable_components[component->nchildren];
 	unsigned nsuitable_components;
 
-	nsuitable_components = starpu_mct_compute_execution_times(component, task,
+	nsuitable_components = starpu_mct_compute_execution_times(d, component, task,
 			estimated_lengths,
 			estimated_transfer_length,
 			suitable_components);
@@ -538,7 +538,7 @@ static void heteroprio_component_deinit_data(struct starpu_sched_component * com
 	starpu_st_prio_deque_destroy(&d->no_accel);
 	STARPU_PTHREAD_MUTEX_DESTROY(&d->mutex);
 	STARPU_PTHREAD_MUTEX_DESTROY(&mct_d->scheduling_mutex);
-	free(mct_d);
+	starpu_mct_deinit_parameters(mct_d);
 	free(d);
 }
 
@@ -0,0 +1,388 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+/*
+ * Locality component: meant to be stacked following the machine hierarchy.
+ * Tasks are pushed down towards the children which hold most of their data,
+ * and kept in one queue per worker child. Idle workers first take from their
+ * own queue, then steal from their siblings, and then from further and
+ * further subtrees by going up the hierarchy.
+ */
+
+#include <float.h>
+
+#include <starpu.h>
+#include <starpu_sched_component.h>
+#include <starpu_scheduler.h>
+#include <schedulers/starpu_scheduler_toolbox.h>
+#include <core/workers.h>
+#include <core/sched_policy.h>
+#include <core/task.h>
+#include <datawizard/coherency.h>
+#include <sched_policies/prio_deque.h>
+
+struct _starpu_component_locality_data
+{
+	/* One queue per child, only used for worker children */
+	struct starpu_st_prio_deque *fifos;
+	starpu_pthread_mutex_t **mutexes;
+	unsigned size;
+
+	/* Number of tasks queued in the whole subtree */
+	int ntasks;
+	unsigned last_push_child;
+};
+
+static struct starpu_sched_component *locality_parent(struct starpu_sched_component *component)
+{
+	unsigned sched_ctx_id = component->tree->sched_ctx_id;
+	if (sched_ctx_id >= component->nparents)
+		return NULL;
+	return component->parents[sched_ctx_id];
+}
+
+/* Account for a task added to (or removed from) the subtree of component */
+static void locality_account(struct starpu_sched_component *component, int n)
+{
+	while (component && starpu_sched_component_is_locality(component))
+	{
+		struct _starpu_component_locality_data *ld = component->data;
+		(void) STARPU_ATOMIC_ADD(&ld->ntasks, n);
+		component = locality_parent(component);
+	}
+}
+
+static int child_ntasks(struct starpu_sched_component *component, unsigned i)
+{
+	struct _starpu_component_locality_data *ld = component->data;
+	struct starpu_sched_component *child = component->children[i];
+	if (starpu_sched_component_is_locality(child))
+		return ((struct _starpu_component_locality_data *) child->data)->ntasks;
+	return ld->fifos[i].ntasks;
+}
+
+/* Take a task which workerid can execute from the subtree of child i */
+static struct starpu_task *steal_from_child(struct starpu_sched_component *component, unsigned i, int workerid)
+{
+	struct _starpu_component_locality_data *ld = component->data;
+	struct starpu_sched_component *child = component->children[i];
+	struct starpu_task *task = NULL;
+
+	if (!child_ntasks(component, i))
+		return NULL;
+
+	if (starpu_sched_component_is_locality(child))
+	{
+		unsigned j;
+		for (j = 0; j < child->nchildren && !task; j++)
+			task = steal_from_child(child, j, workerid);
+		return task;
+	}
+
+	STARPU_COMPONENT_MUTEX_LOCK(ld->mutexes[i]);
+	task = starpu_st_prio_deque_deque_task_for_worker(&ld->fifos[i], workerid, NULL);
+	STARPU_COMPONENT_MUTEX_UNLOCK(ld->mutexes[i]);
+	if (task)
+	{
+		locality_account(component, -1);
+		starpu_sched_task_break(task);
+	}
+	return task;
+}
+
+static struct starpu_task *locality_pull_task(struct starpu_sched_component *component, struct starpu_sched_component *to)
+{
+	struct _starpu_component_locality_data *ld = component->data;
+	int workerid = starpu_worker_get_id_check();
+	struct starpu_task *task = NULL;
+	unsigned i, k;
+
+	for (i = 0; i < component->nchildren; i++)
+		if (component->children[i] == to)
+			break;
+	STARPU_ASSERT(i < component->nchildren);
+
+	/* Our own queue first */
+	if (!starpu_sched_component_is_locality(to) && ld->fifos[i].ntasks)
+	{
+		STARPU_COMPONENT_MUTEX_LOCK(ld->mutexes[i]);
+		task = starpu_st_prio_deque_pop_task_for_worker(&ld->fifos[i], workerid, NULL);
+		STARPU_COMPONENT_MUTEX_UNLOCK(ld->mutexes[i]);
+		if (task)
+		{
+			locality_account(component, -1);
+			return task;
+		}
+	}
+
+	/* Then our nearest siblings */
+	for (k = 1; k < component->nchildren && !task; k++)
+		task = steal_from_child(component, (i + k) % component->nchildren, workerid);
+	if (task)
+		return task;
+
+	/* And then further away */
+	for (i = 0; i < component->nparents; i++)
+	{
+		if (component->parents[i] == NULL)
+			continue;
+		task = starpu_sched_component_pull_task(component->parents[i], component);
+		if (task)
+			break;
+	}
+	return task;
+}
+
+/* Amount of the input data of task which is already valid on memory_node */
+static size_t local_data_size(struct starpu_task *task, unsigned memory_node)
+{
+	unsigned nbuffers = STARPU_TASK_GET_NBUFFERS(task);
+	unsigned buffer;
+	size_t size = 0;
+
+	if (!task->cl)
+		return 0;
+
+	for (buffer = 0; buffer < nbuffers; buffer++)
+	{
+		starpu_data_handle_t handle = STARPU_TASK_GET_HANDLE(task, buffer);
+		enum starpu_data_access_mode mode = STARPU_TASK_GET_MODE(task, buffer);
+		if (!(mode & STARPU_R))
+			continue;
+		if (handle->per_node[memory_node].state != STARPU_INVALID)
+			size += _starpu_data_get_size(handle);
+	}
+	return size;
+}
+
+/* Memory node of the workers of child, or -1 if they do not share one */
+static int child_memory_node(struct starpu_sched_component *child)
+{
+	int workerid = starpu_bitmap_first(&child->workers_in_ctx);
+	if (workerid == -1)
+		return -1;
+	if (starpu_bitmap_cardinal(&child->workers_in_ctx) == 1 || STARPU_SCHED_COMPONENT_IS_SINGLE_MEMORY_NODE(child))
+		return starpu_worker_get_memory_node(workerid);
+	return -1;
+}
+
+#if !defined(STARPU_NON_BLOCKING_DRIVERS) || defined(STARPU_SIMGRID)
+/* Wake up an idle worker of the subtree of component, but out of the subtree
+ * of child from, which can execute task. Return whether one was woken up */
+static int locality_wake_stealer(struct starpu_sched_component *component, struct starpu_sched_component *from, struct starpu_task *task)
+{
+	int workerid;
+	for (workerid = starpu_bitmap_first(&component->workers_in_ctx);
+	     workerid != -1;
+	     workerid = starpu_bitmap_next(&component->workers_in_ctx, workerid))
+	{
+		if (starpu_bitmap_get(&from->workers_in_ctx, workerid))
+			continue;
+		if (!starpu_worker_can_execute_task_first_impl(workerid, task, NULL))
+			continue;
+		if (starpu_wake_worker_relax_light(workerid))
+			return 1;
+	}
+	return 0;
+}
+#endif
+
+static int locality_push_task(struct starpu_sched_component *component, struct starpu_task *task)
+{
+	struct _starpu_component_locality_data *ld = component->data;
+	int workerid = starpu_worker_get_id();
+	size_t data_size[STARPU_MAXNODES];
+	int data_size_computed[STARPU_MAXNODES];
+	int best = -1;
+	size_t best_size = 0;
+	int best_local = 0;
+	double best_load = DBL_MAX;
+	unsigned i, k;
+
+	memset(data_size_computed, 0, sizeof(data_size_computed));
+
+	/* Locality first: prefer the child which already holds most of the
+	 * data, then the child of the pushing worker, then the least loaded
+	 * child */
+	for (k = 0; k < component->nchildren; k++)
+	{
+		i = (ld->last_push_child + 1 + k) % component->nchildren;
+		struct starpu_sched_component *child = component->children[i];
+		size_t size = 0;
+		int local;
+		double load;
+		int nworkers;
+
+		if (!starpu_sched_component_can_execute_task(child, task))
+			continue;
+
+		int memory_node = child_memory_node(child);
+		if (memory_node >= 0)
+		{
+			if (!data_size_computed[memory_node])
+			{
+				data_size[memory_node] = local_data_size(task, memory_node);
+				data_size_computed[memory_node] = 1;
+			}
+			size = data_size[memory_node];
+		}
+
+		local = workerid != -1 && starpu_bitmap_get(&child->workers_in_ctx, workerid);
+		nworkers = starpu_bitmap_cardinal(&child->workers_in_ctx);
+		load = (double) child_ntasks(component, i) / (nworkers ? nworkers : 1);
+
+		if (best == -1
+		    || size > best_size
+		    || (size == best_size && local > best_local)
+		    || (size == best_size && local == best_local && load < best_load))
+		{
+			best = i;
+			best_size = size;
+			best_local = local;
+			best_load = load;
+		}
+	}
+	STARPU_ASSERT_MSG(best != -1, "Could not find child able to execute this task");
+	ld->last_push_child = best;
+
+	struct starpu_sched_component *child = component->children[best];
+	if (starpu_sched_component_is_locality(child))
+		return starpu_sched_component_push_task(component, child, task);
+
+	locality_account(component, 1);
+	STARPU_COMPONENT_MUTEX_LOCK(ld->mutexes[best]);
+	starpu_sched_task_break(task);
+	int ret = starpu_st_prio_deque_push_back_task(&ld->fifos[best], task);
+	STARPU_COMPONENT_MUTEX_UNLOCK(ld->mutexes[best]);
+
+	/* Wake up the target, and its siblings which may steal the task */
+	starpu_sched_component_can_pull_all(component);
+
+#if !defined(STARPU_NON_BLOCKING_DRIVERS) || defined(STARPU_SIMGRID)
+	/* And one idle worker from the nearest other subtree, which will steal
+	 * it if the workers here are busy */
+	struct starpu_sched_component *from = component, *parent;
+	while ((parent = locality_parent(from)) && starpu_sched_component_is_locality(parent))
+	{
+		if (locality_wake_stealer(parent, from, task))
+			break;
+		from = parent;
+	}
+#endif
+	return ret;
+}
+
+static double locality_estimated_load(struct starpu_sched_component *component)
+{
+	struct _starpu_component_locality_data *ld = component->data;
+	double speedup = 0.0;
+	int workerid;
+	for(workerid = starpu_bitmap_first(&component->workers_in_ctx);
+	    -1 != workerid;
+	    workerid = starpu_bitmap_next(&component->workers_in_ctx, workerid))
+	{
+		speedup += starpu_worker_get_relative_speedup(starpu_worker_get_perf_archtype(workerid, component->tree->sched_ctx_id));
+	}
+	if (speedup == 0.0)
+		return 0.0;
+	return ld->ntasks / speedup;
+}
+
+static void locality_add_child(struct starpu_sched_component *component, struct starpu_sched_component *child)
+{
+	struct _starpu_component_locality_data *ld = component->data;
+	starpu_sched_component_add_child(component, child);
+	if(ld->size < component->nchildren)
+	{
+		STARPU_ASSERT(ld->size == component->nchildren - 1);
+		_STARPU_REALLOC(ld->fifos, component->nchildren * sizeof(*ld->fifos));
+		_STARPU_REALLOC(ld->mutexes, component->nchildren * sizeof(*ld->mutexes));
+		ld->size = component->nchildren;
+	}
+
+	starpu_st_prio_deque_init(&ld->fifos[component->nchildren - 1]);
+
+	starpu_pthread_mutex_t *mutex;
+	_STARPU_MALLOC(mutex, sizeof(*mutex));
+	STARPU_PTHREAD_MUTEX_INIT(mutex,NULL);
+	ld->mutexes[component->nchildren - 1] = mutex;
+}
+
+static void locality_remove_child(struct starpu_sched_component *component, struct starpu_sched_component *child)
+{
+	struct _starpu_component_locality_data *ld = component->data;
+	unsigned i, last = component->nchildren - 1;
+
+	for(i = 0; i < component->nchildren; i++)
+		if(component->children[i] == child)
+			break;
+	STARPU_ASSERT(i != component->nchildren);
+
+	struct starpu_st_prio_deque tmp_fifo = ld->fifos[i];
+	starpu_pthread_mutex_t *tmp_mutex = ld->mutexes[i];
+	ld->fifos[i] = ld->fifos[last];
+	ld->mutexes[i] = ld->mutexes[last];
+	component->children[i] = component->children[last];
+	component->nchildren--;
+
+	STARPU_PTHREAD_MUTEX_DESTROY(tmp_mutex);
+	free(tmp_mutex);
+
+	/* Give back the tasks which were queued for that child */
+	struct starpu_task *task;
+	while ((task = starpu_st_prio_deque_pop_task(&tmp_fifo)))
+	{
+		locality_account(component, -1);
+		starpu_sched_component_push_task(NULL, component, task);
+	}
+	starpu_st_prio_deque_destroy(&tmp_fifo);
+}
+
+static void locality_deinit_data(struct starpu_sched_component *component)
+{
+	struct _starpu_component_locality_data *ld = component->data;
+	unsigned i;
+	for (i = 0; i < component->nchildren; i++)
+	{
+		starpu_st_prio_deque_destroy(&ld->fifos[i]);
+		STARPU_PTHREAD_MUTEX_DESTROY(ld->mutexes[i]);
+		free(ld->mutexes[i]);
+	}
+	free(ld->fifos);
+	free(ld->mutexes);
+	free(ld);
+}
+
+int starpu_sched_component_is_locality(struct starpu_sched_component *component)
+{
+	return component->push_task == locality_push_task;
+}
+
+struct starpu_sched_component *starpu_sched_component_locality_create(struct starpu_sched_tree *tree, void *arg)
+{
+	(void)arg;
+	struct starpu_sched_component *component = starpu_sched_component_create(tree, "locality");
+	struct _starpu_component_locality_data *ld;
+	_STARPU_CALLOC(ld, 1, sizeof(*ld));
+	component->pull_task = locality_pull_task;
+	component->push_task = locality_push_task;
+	component->add_child = locality_add_child;
+	component->remove_child = locality_remove_child;
+	component->estimated_load = locality_estimated_load;
+	component->deinit_data = locality_deinit_data;
+	component->data = ld;
+	return component;
+}
@@ -47,7 +47,7 @@ static int mct_push_task(struct starpu_sched_component * component, struct starp
 	unsigned suitable_components[component->nchildren];
 	unsigned nsuitable_components;
 
-	nsuitable_components = starpu_mct_compute_execution_times(component, task,
+	nsuitable_components = starpu_mct_compute_execution_times(d, component, task,
 								  estimated_lengths, estimated_transfer_length, suitable_components);
 
 	/* If no suitable components were found, it means that the perfmodel of
@@ -108,7 +108,7 @@ static void mct_component_deinit_data(struct starpu_sched_component * component)
 	STARPU_ASSERT(starpu_sched_component_is_mct(component));
 	struct _starpu_mct_data * d = component->data;
 	STARPU_PTHREAD_MUTEX_DESTROY(&d->scheduling_mutex);
-	free(d);
+	starpu_mct_deinit_parameters(d);
 }
 
 int starpu_sched_component_is_mct(struct starpu_sched_component * component)
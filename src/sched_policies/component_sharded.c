@@ -0,0 +1,297 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+/* Sharded component: a fifo or prio component whose queue is split into
+ * several shards, each with its own lock, so that threads pushing tasks
+ * concurrently at the top of a tree do not all contend on the same mutex.
+ * Each pushing thread always uses the same shard, so the order of the tasks
+ * it submits is preserved, but there is no global order between threads.
+ * Pullers start with their own shard and go round the others; in prio mode
+ * they pick the shard whose first task has the highest priority. Like the
+ * fifo and prio components, tasks which the pulling child can not execute are
+ * skipped. */
+
+#include <starpu_sched_component.h>
+#include <starpu_scheduler.h>
+#include <schedulers/starpu_scheduler_toolbox.h>
+#include <core/workers.h>
+#include <sched_policies/prio_deque.h>
+
+struct _starpu_shard
+{
+	starpu_pthread_mutex_t mutex;
+	/* fifo mode */
+	struct starpu_task_list list;
+	/* prio mode */
+	struct starpu_st_prio_deque prio;
+	/* These are read without the lock, to find where tasks are */
+	unsigned ntasks;
+	int top_priority;
+	/* Avoid false sharing between the shards */
+	char padding[STARPU_CACHELINE_SIZE];
+};
+
+struct _starpu_sharded_data
+{
+	struct _starpu_shard *shards;
+	unsigned nshards;
+	int prio;
+};
+
+/* Each thread always pushes to the same shard */
+static unsigned push_shard(struct _starpu_sharded_data *data)
+{
+	starpu_pthread_t self = starpu_pthread_self();
+	return starpu_hash_crc32c_be_n(&self, sizeof(self), 0) % data->nshards;
+}
+
+static void shard_update_top(struct _starpu_sharded_data *data, struct _starpu_shard *shard)
+{
+	if (data->prio)
+	{
+		struct starpu_task *top = starpu_st_prio_deque_highest_task(&shard->prio);
+		shard->top_priority = top ? top->priority : INT_MIN;
+	}
+}
+
+static void sharded_push_local_task(struct starpu_sched_component *component, struct starpu_task *task, int is_pushback)
+{
+	struct _starpu_sharded_data *data = component->data;
+	struct _starpu_shard *shard = &data->shards[push_shard(data)];
+
+	STARPU_COMPONENT_MUTEX_LOCK(&shard->mutex);
+	if (data->prio)
+	{
+		if (is_pushback)
+			starpu_st_prio_deque_push_front_task(&shard->prio, task);
+		else
+			starpu_st_prio_deque_push_back_task(&shard->prio, task);
+		shard_update_top(data, shard);
+	}
+	else
+	{
+		if (is_pushback)
+			starpu_task_list_push_front(&shard->list, task);
+		else
+			starpu_task_list_push_back(&shard->list, task);
+	}
+	shard->ntasks++;
+	if (!is_pushback)
+		starpu_sched_component_prefetch_on_node(component, task);
+	STARPU_COMPONENT_MUTEX_UNLOCK(&shard->mutex);
+}
+
+static int sharded_push_task(struct starpu_sched_component *component, struct starpu_task *task)
+{
+	STARPU_ASSERT(component && component->data && task);
+	STARPU_ASSERT(starpu_sched_component_can_execute_task(component,task));
+
+	sharded_push_local_task(component, task, 0);
+	component->can_pull(component);
+	return 0;
+}
+
+/* Find the shard to pull from, without taking any lock */
+static int pick_shard(struct _starpu_sharded_data *data, unsigned home)
+{
+	unsigned i;
+	int best = -1;
+
+	for (i = 0; i < data->nshards; i++)
+	{
+		unsigned n = (home + i) % data->nshards;
+		struct _starpu_shard *shard = &data->shards[n];
+		STARPU_HG_DISABLE_CHECKING(shard->ntasks);
+		STARPU_HG_DISABLE_CHECKING(shard->top_priority);
+		if (!shard->ntasks)
+			continue;
+		if (!data->prio)
+			/* Take the first non-empty shard */
+			return n;
+		if (best == -1 || shard->top_priority > data->shards[best].top_priority)
+			best = n;
+	}
+	return best;
+}
+
+/* Pop the first task of the shard that the target can execute */
+static struct starpu_task *shard_pop_task(struct _starpu_sharded_data *data, struct _starpu_shard *shard, struct starpu_sched_component *to)
+{
+	struct starpu_task *task;
+
+	STARPU_HG_DISABLE_CHECKING(shard->ntasks);
+	if (!shard->ntasks)
+		return NULL;
+
+	STARPU_COMPONENT_MUTEX_LOCK(&shard->mutex);
+	if (data->prio)
+	{
+		struct starpu_st_prio_deque *prio = &shard->prio;
+		for (task  = starpu_task_prio_list_begin(&prio->list);
+		     task != starpu_task_prio_list_end(&prio->list);
+		     task  = starpu_task_prio_list_next(&prio->list, task))
+			if (!to || starpu_sched_component_can_execute_task(to, task))
+				break;
+		if (task == starpu_task_prio_list_end(&prio->list))
+			task = NULL;
+		if (task)
+		{
+			starpu_task_prio_list_erase(&prio->list, task);
+			prio->ntasks--;
+			shard_update_top(data, shard);
+		}
+	}
+	else
+	{
+		for (task  = starpu_task_list_begin(&shard->list);
+		     task != starpu_task_list_end(&shard->list);
+		     task  = starpu_task_list_next(task))
+			if (!to || starpu_sched_component_can_execute_task(to, task))
+				break;
+		if (task == starpu_task_list_end(&shard->list))
+			task = NULL;
+		if (task)
+			starpu_task_list_erase(&shard->list, task);
+	}
+	if (task)
+		shard->ntasks--;
+	STARPU_COMPONENT_MUTEX_UNLOCK(&shard->mutex);
+
+	return task;
+}
+
+static struct starpu_task *sharded_pull_task(struct starpu_sched_component *component, struct starpu_sched_component *to)
+{
+	STARPU_ASSERT(component && component->data);
+	struct _starpu_sharded_data *data = component->data;
+	struct starpu_task *task = NULL;
+	unsigned home = 0;
+	unsigned i;
+	int n;
+
+	if (to)
+	{
+		int workerid = starpu_bitmap_first(&to->workers_in_ctx);
+		if (workerid != -1)
+			home = workerid % data->nshards;
+	}
+
+	while ((n = pick_shard(data, home)) != -1)
+	{
+		struct _starpu_shard *shard = &data->shards[n];
+
+		task = shard_pop_task(data, shard, to);
+		if (task)
+			break;
+		if (shard->ntasks)
+		{
+			/* On heterogeneous trees, the target may not be able
+			 * to execute any of its tasks, look at all shards */
+			for (i = 0; !task && i < data->nshards; i++)
+				task = shard_pop_task(data, &data->shards[(home + i) % data->nshards], to);
+			break;
+		}
+		/* Otherwise somebody else emptied it meanwhile, look again */
+	}
+
+	starpu_sched_component_send_can_push_to_parents(component);
+
+	return task;
+}
+
+static int sharded_can_push(struct starpu_sched_component *component, struct starpu_sched_component *to STARPU_ATTRIBUTE_UNUSED)
+{
+	STARPU_ASSERT(component && starpu_sched_component_is_sharded(component));
+	int res = 0;
+	struct starpu_task *task;
+
+	task = starpu_sched_component_pump_downstream(component, &res);
+	if (task)
+		sharded_push_local_task(component, task, 1);
+
+	return res;
+}
+
+static double sharded_estimated_load(struct starpu_sched_component *component)
+{
+	struct _starpu_sharded_data *data = component->data;
+	double load = starpu_sched_component_estimated_load(component);
+	unsigned nworkers = starpu_bitmap_cardinal(&component->workers_in_ctx);
+	unsigned ntasks = 0;
+	unsigned i;
+
+	STARPU_ASSERT(nworkers != 0);
+	for (i = 0; i < data->nshards; i++)
+	{
+		STARPU_HG_DISABLE_CHECKING(data->shards[i].ntasks);
+		ntasks += data->shards[i].ntasks;
+	}
+	return load + (double) ntasks / nworkers;
+}
+
+static void sharded_component_deinit_data(struct starpu_sched_component *component)
+{
+	STARPU_ASSERT(component && component->data);
+	struct _starpu_sharded_data *data = component->data;
+	unsigned i;
+
+	for (i = 0; i < data->nshards; i++)
+	{
+		struct _starpu_shard *shard = &data->shards[i];
+		STARPU_ASSERT(!shard->ntasks);
+		starpu_st_prio_deque_destroy(&shard->prio);
+		STARPU_PTHREAD_MUTEX_DESTROY(&shard->mutex);
+	}
+	free(data->shards);
+	free(data);
+}
+
+int starpu_sched_component_is_sharded(struct starpu_sched_component *component)
+{
+	return component->push_task == sharded_push_task;
+}
+
+struct starpu_sched_component *starpu_sched_component_sharded_create(struct starpu_sched_tree *tree, struct starpu_sched_component_sharded_data *params)
+{
+	struct starpu_sched_component *component = starpu_sched_component_create(tree, "sharded");
+	struct _starpu_sharded_data *data;
+	unsigned i;
+
+	_STARPU_CALLOC(data, 1, sizeof(*data));
+	data->nshards = params && params->nshards ? params->nshards : starpu_worker_get_count();
+	if (!data->nshards)
+		data->nshards = 1;
+	data->prio = params ? params->prio : 0;
+
+	_STARPU_CALLOC(data->shards, data->nshards, sizeof(*data->shards));
+	for (i = 0; i < data->nshards; i++)
+	{
+		struct _starpu_shard *shard = &data->shards[i];
+		STARPU_PTHREAD_MUTEX_INIT(&shard->mutex, NULL);
+		starpu_task_list_init(&shard->list);
+		starpu_st_prio_deque_init(&shard->prio);
+		shard->top_priority = INT_MIN;
+	}
+
+	component->data = data;
+	component->push_task = sharded_push_task;
+	component->pull_task = sharded_pull_task;
+	component->can_push = sharded_can_push;
+	component->estimated_load = sharded_estimated_load;
+	component->deinit_data = sharded_component_deinit_data;
+
+	return component;
+}
@@ -27,12 +27,14 @@
 #include <schedulers/starpu_scheduler_toolbox.h>
 
 #include <common/fxt.h>
+#include <common/graph.h>
 #include <core/task.h>
 #include <core/workers.h>
 #include <core/sched_policy.h>
 #include <core/debug.h>
 #ifdef BUILDING_STARPU
 #include <datawizard/memory_nodes.h>
+#include <datawizard/coherency.h>
 #endif
 #include <sched_policies/fifo_queues.h>
 
@@ -63,6 +65,7 @@ struct _starpu_dmda_data
 	long int ready_task_cnt;
 	long int eager_task_cnt; /* number of tasks scheduled without model */
 	int num_priorities;
+	unsigned lookahead; /* whether to account for the optimistic cost table of the task graph */
 };
 
 /* performance steering knobs */
@@ -459,13 +462,34 @@ static void compute_all_performance_predictions(struct starpu_task *task,
 	struct starpu_worker_collection *workers = starpu_sched_ctx_get_worker_collection(sched_ctx_id);
 	double now = starpu_timing_now();
 
+	/* Workers which can execute the task, and their implementations */
+	unsigned workerids[nworkers];
+	unsigned impl_masks[nworkers];
+	unsigned nexec = 0;
+
 	struct starpu_sched_ctx_iterator it;
 	workers->init_iterator_for_parallel_tasks(workers, &it, task);
-	while(worker_ctx<nworkers && workers->has_next(workers, &it))
+	while(nexec<nworkers && workers->has_next(workers, &it))
 	{
-		unsigned nimpl;
-		unsigned impl_mask;
 		unsigned workerid = workers->get_next(workers, &it);
+		if (!starpu_worker_can_execute_task_impl(workerid, task, &impl_masks[nexec]))
+			continue;
+		workerids[nexec++] = workerid;
+	}
+
+	/* Predictions for all workers at once, indexed by nimpl * nexec + worker_ctx */
+	double lengths[STARPU_MAXIMPLEMENTATIONS * nworkers];
+	double energies[STARPU_MAXIMPLEMENTATIONS * nworkers];
+	double transfers[nworkers];
+	if (!bundle && nexec)
+		_starpu_task_expected_predictions(task, sched_ctx_id, nexec, workerids, impl_masks,
+						  lengths, local_energy ? energies : NULL, local_data_penalty ? transfers : NULL);
+
+	for (worker_ctx = 0; worker_ctx < nexec; worker_ctx++)
+	{
+		unsigned nimpl;
+		unsigned impl_mask = impl_masks[worker_ctx];
+		unsigned workerid = workerids[worker_ctx];
 		struct starpu_st_fifo_taskq *fifo = &dt->queue_array[workerid];
 		struct starpu_perfmodel_arch* perf_arch = starpu_worker_get_perf_archtype(workerid, sched_ctx_id);
 		unsigned memory_node = starpu_worker_get_memory_node(workerid);
@@ -475,9 +499,6 @@ static void compute_all_performance_predictions(struct starpu_task *task,
 		/* Sometimes workers didn't take the tasks as early as we expected */
 		double exp_start = isnan(fifo->exp_start) ? now + fifo->pipeline_len : STARPU_MAX(fifo->exp_start, now);
 
-		if (!starpu_worker_can_execute_task_impl(workerid, task, &impl_mask))
-			continue;
-
 		for (nimpl  = 0; nimpl < STARPU_MAXIMPLEMENTATIONS; nimpl++)
 		{
 			if (!(impl_mask & (1U << nimpl)))
@@ -523,11 +544,11 @@ static void compute_all_performance_predictions(struct starpu_task *task,
 			}
 			else
 			{
-				local_task_length[worker_ctx][nimpl] = starpu_task_worker_expected_length(task, workerid, sched_ctx_id, nimpl);
+				local_task_length[worker_ctx][nimpl] = lengths[nimpl * nexec + worker_ctx];
 				if (local_data_penalty)
-					local_data_penalty[worker_ctx][nimpl] = starpu_task_expected_data_transfer_time_for(task, workerid);
+					local_data_penalty[worker_ctx][nimpl] = transfers[worker_ctx];
 				if (local_energy)
-					local_energy[worker_ctx][nimpl] = starpu_task_worker_expected_energy(task, workerid, sched_ctx_id,nimpl);
+					local_energy[worker_ctx][nimpl] = energies[nimpl * nexec + worker_ctx];
 				double conversion_time = starpu_task_expected_conversion_time(task, perf_arch, nimpl);
 				if (conversion_time > 0.0)
 					local_task_length[worker_ctx][nimpl] += conversion_time;
@@ -603,7 +624,6 @@ static void compute_all_performance_predictions(struct starpu_task *task,
 					local_energy[worker_ctx][nimpl] = 0.;
 
 		}
-		worker_ctx++;
 	}
 
 	*forced_worker = unknown?ntasks_best:-1;
@@ -651,6 +671,10 @@ static double _dmda_push_task(struct starpu_task *task, unsigned prio, unsigned
 
 	double fitness[nworkers_ctx][STARPU_MAXIMPLEMENTATIONS];
 
+	/* Expected length of the rest of the task graph, for each worker class */
+	double oct[STARPU_NMAXWORKERS];
+	int lookahead = dt->lookahead && _starpu_graph_lookahead_task_costs(task, NULL, oct);
+
 
 	compute_all_performance_predictions(task,
 					    nworkers_ctx,
@@ -703,6 +727,11 @@ static double _dmda_push_task(struct starpu_task *task, unsigned prio, unsigned
 																									  must be in Joules, thus the / 1000000.0 */
 				}
 
+				if (lookahead && worker < starpu_worker_get_count())
+					/* Favour the workers which will let the successors
+					 * finish early, like PEFT */
+					fitness[worker_ctx][nimpl] += dt->alpha * __s_alpha__value * oct[_starpu_graph_lookahead_worker_class(worker)];
+
 				if (best == -1 || fitness[worker_ctx][nimpl] < best_fitness)
 				{
 					/* we found a better solution */
@@ -925,6 +954,83 @@ static void deinitialize_dmda_policy(unsigned sched_ctx_id)
 	free(dt);
 }
 
+/* Number of contexts using dmdal, which share the ready soon notification */
+static int dmda_lookahead_nctxs;
+static void initialize_dmda_lookahead_policy(unsigned sched_ctx_id);
+
+/* The last dependency of task has just started, so it will be ready after
+ * delay: prefetch its input on the worker which looks best for it, so that it
+ * does not have to wait for them once it is pushed */
+static void dmda_lookahead_notify_ready_soon(void *data STARPU_ATTRIBUTE_UNUSED, struct starpu_task *task, double delay)
+{
+	unsigned sched_ctx_id = task->sched_ctx;
+	double length[STARPU_NMAXWORKERS];
+	double oct[STARPU_NMAXWORKERS];
+	double best_end = DBL_MAX;
+	int best = -1;
+
+	if (!task->cl || !starpu_get_prefetch_flag())
+		return;
+	struct starpu_sched_policy *policy = _starpu_get_sched_ctx_struct(sched_ctx_id)->sched_policy;
+	if (!policy || policy->init_sched != initialize_dmda_lookahead_policy)
+		/* Not for us */
+		return;
+	if (!_starpu_graph_lookahead_task_costs(task, length, oct))
+		return;
+
+	struct _starpu_dmda_data *dt = (struct _starpu_dmda_data*)starpu_sched_ctx_get_policy_data(sched_ctx_id);
+	struct starpu_worker_collection *workers = starpu_sched_ctx_get_worker_collection(sched_ctx_id);
+	struct starpu_sched_ctx_iterator it;
+	double now = starpu_timing_now();
+
+	workers->init_iterator(workers, &it);
+	while(workers->has_next(workers, &it))
+	{
+		unsigned worker = workers->get_next(workers, &it);
+		unsigned class;
+		double exp_end, end;
+
+		if (worker >= starpu_worker_get_count())
+			continue;
+		class = _starpu_graph_lookahead_worker_class(worker);
+		if (isinf(length[class]) || !starpu_worker_can_execute_task_first_impl(worker, task, NULL))
+			continue;
+
+		/* This is only a hint, we can read it with races */
+		exp_end = dt->queue_array[worker].exp_end;
+		if (isnan(exp_end))
+			exp_end = now;
+		end = STARPU_MAX(exp_end, now + delay) + length[class] + oct[class];
+		if (end < best_end)
+		{
+			best_end = end;
+			best = worker;
+		}
+	}
+
+	if (best != -1)
+		_starpu_idle_prefetch_task_ready_soon_input_for(task, best, task->priority);
+}
+
+static void initialize_dmda_lookahead_policy(unsigned sched_ctx_id)
+{
+	initialize_dmda_policy(sched_ctx_id);
+
+	struct _starpu_dmda_data *dt = (struct _starpu_dmda_data*)starpu_sched_ctx_get_policy_data(sched_ctx_id);
+	dt->lookahead = 1;
+	_starpu_graph_lookahead_enable();
+	if (STARPU_ATOMIC_ADD(&dmda_lookahead_nctxs, 1) == 1)
+		starpu_task_notify_ready_soon_register(dmda_lookahead_notify_ready_soon, NULL);
+}
+
+static void deinitialize_dmda_lookahead_policy(unsigned sched_ctx_id)
+{
+	if (STARPU_ATOMIC_ADD(&dmda_lookahead_nctxs, -1) == 0)
+		starpu_task_notify_ready_soon_register(NULL, NULL);
+	_starpu_graph_lookahead_disable();
+	deinitialize_dmda_policy(sched_ctx_id);
+}
+
 /* dmda_pre_exec_hook is called right after the data transfer is done and right
  * before the computation to begin, it is useful to update more precisely the
  * value of the expected start, end, length, etc... */
@@ -1158,3 +1264,21 @@ struct starpu_sched_policy _starpu_sched_dmda_ready_policy =
 	.worker_type = STARPU_WORKER_LIST,
 	.prefetches = 1,
 };
+
+struct starpu_sched_policy _starpu_sched_dmda_lookahead_policy =
+{
+	.init_sched = initialize_dmda_lookahead_policy,
+	.deinit_sched = deinitialize_dmda_lookahead_policy,
+	.add_workers = dmda_add_workers ,
+	.remove_workers = dmda_remove_workers,
+	.push_task = dmda_push_task,
+	.simulate_push_task = dmda_simulate_push_task,
+	.push_task_notify = dmda_push_task_notify,
+	.pop_task = dmda_pop_ready_task,
+	.pre_exec_hook = dmda_pre_exec_hook,
+	.post_exec_hook = dmda_post_exec_hook,
+	.policy_name = "dmdal",
+	.policy_description = "data-aware performance model (lookahead)",
+	.worker_type = STARPU_WORKER_LIST,
+	.prefetches = 1,
+};
@@ -204,6 +204,7 @@ struct starpu_sched_policy _starpu_sched_eager_policy =
 	.pop_task = pop_task_eager_policy,
 	.pre_exec_hook = NULL,
 	.post_exec_hook = NULL,
+	.successor_continuation = 1,
 	.policy_name = "eager",
 	.policy_description = "eager policy with a central queue",
 	.worker_type = STARPU_WORKER_LIST,
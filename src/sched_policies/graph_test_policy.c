@@ -81,7 +81,7 @@ static void deinitialize_graph_test_policy(unsigned sched_ctx_id)
 	 starpu_st_prio_deque_destroy(&data->prio_cpu);
 	 starpu_st_prio_deque_destroy(&data->prio_gpu);
 
-	_starpu_graph_record = 0;
+	_starpu_graph_record_disable();
 	STARPU_PTHREAD_MUTEX_DESTROY(&data->policy_mutex);
 	free(data);
 }
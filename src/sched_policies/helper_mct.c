@@ -17,6 +17,11 @@
  */
 
 #include <starpu_sched_component.h>
+#include <core/perfmodel/perfmodel.h>
+#include <core/workers.h>
+#include <core/jobs.h>
+#include <datawizard/footprint.h>
+#include <common/uthash.h>
 #include "helper_mct.h"
 #include <float.h>
 
@@ -29,6 +34,27 @@
 #define _STARPU_SCHED_BETA_DEFAULT 1.0
 #define _STARPU_SCHED_GAMMA_DEFAULT 1000.0
 
+/* Beyond this number of entries, the decision cache is flushed */
+#define _STARPU_MCT_CACHE_MAX_ENTRIES 1024
+
+struct _starpu_mct_cache_key
+{
+	struct starpu_codelet *cl;
+	uint32_t footprint;
+	/* Hash of the location, size and access mode of the data */
+	uint32_t location;
+};
+
+struct _starpu_mct_cache_entry
+{
+	UT_hash_handle hh;
+	struct _starpu_mct_cache_key key;
+	unsigned nsuitable_components;
+	unsigned *suitable_components;
+	double *estimated_lengths;
+	double *estimated_transfer_length;
+};
+
 struct _starpu_mct_data *starpu_mct_init_parameters(struct starpu_sched_component_mct_data *params)
 {
 	struct _starpu_mct_data *data;
@@ -54,9 +80,43 @@ struct _starpu_mct_data *starpu_mct_init_parameters(struct starpu_sched_componen
 		data->idle_power = starpu_getenv_float_default("STARPU_IDLE_POWER", 0.0);
 	}
 
+	data->cache_enabled = starpu_getenv_number_default("STARPU_SCHED_MCT_CACHE", 0);
+	data->cache = NULL;
+	data->cache_nentries = 0;
+	data->cache_generation = 0;
+	data->cache_nchildren = 0;
+	starpu_bitmap_init(&data->cache_workers);
+	STARPU_PTHREAD_MUTEX_INIT(&data->cache_mutex, NULL);
+
 	return data;
 }
 
+static void cache_entry_free(struct _starpu_mct_cache_entry *entry)
+{
+	free(entry->suitable_components);
+	free(entry->estimated_lengths);
+	free(entry->estimated_transfer_length);
+	free(entry);
+}
+
+static void cache_flush(struct _starpu_mct_data *d)
+{
+	struct _starpu_mct_cache_entry *entry, *tmp;
+	HASH_ITER(hh, d->cache, entry, tmp)
+	{
+		HASH_DEL(d->cache, entry);
+		cache_entry_free(entry);
+	}
+	d->cache_nentries = 0;
+}
+
+void starpu_mct_deinit_parameters(struct _starpu_mct_data *d)
+{
+	cache_flush(d);
+	STARPU_PTHREAD_MUTEX_DESTROY(&d->cache_mutex);
+	free(d);
+}
+
 /* compute predicted_end by taking into account the case of the predicted transfer and the predicted_end overlap
  */
 static double compute_expected_time(double now, double predicted_end, double predicted_length, double predicted_transfer)
@@ -108,21 +168,124 @@ double starpu_mct_compute_fitness(struct _starpu_mct_data * d, double exp_end, d
 	return fitness;
 }
 
-unsigned starpu_mct_compute_execution_times(struct starpu_sched_component *component, struct starpu_task *task,
+/* Same as starpu_sched_component_execute_preds for all children at once, with
+ * predictions batched over all the workers to be considered */
+static void compute_batched_lengths(struct starpu_sched_component *component, struct starpu_task *task,
+				    double *estimated_lengths, int *can_execute)
+{
+	unsigned nworkers = 0;
+	unsigned i, n;
+	int workerid;
+
+	for(i = 0; i < component->nchildren; i++)
+	{
+		struct starpu_sched_component * c = component->children[i];
+		if(STARPU_SCHED_COMPONENT_IS_HOMOGENEOUS(c))
+			nworkers += starpu_bitmap_first(&c->workers_in_ctx) != -1;
+		else
+			nworkers += starpu_bitmap_cardinal(&c->workers_in_ctx);
+	}
+	if (!nworkers)
+	{
+		for(i = 0; i < component->nchildren; i++)
+			can_execute[i] = 0;
+		return;
+	}
+
+	unsigned workerids[nworkers];
+	unsigned impl_masks[nworkers];
+	double lengths[STARPU_MAXIMPLEMENTATIONS * nworkers];
+
+	/* Gather the workers to be considered, in the order execute_preds would consider them */
+	n = 0;
+	for(i = 0; i < component->nchildren; i++)
+	{
+		struct starpu_sched_component * c = component->children[i];
+		for(workerid = starpu_bitmap_first(&c->workers_in_ctx);
+		    workerid != -1;
+		    workerid = starpu_bitmap_next(&c->workers_in_ctx, workerid))
+		{
+			unsigned nimpl;
+			workerids[n] = workerid;
+			impl_masks[n] = 0;
+			for(nimpl = 0; nimpl < STARPU_MAXIMPLEMENTATIONS; nimpl++)
+				if(starpu_worker_can_execute_task(workerid,task,nimpl)
+				   || starpu_combined_worker_can_execute_task(workerid, task, nimpl))
+					impl_masks[n] |= 1U << nimpl;
+			n++;
+			if(STARPU_SCHED_COMPONENT_IS_HOMOGENEOUS(c))
+				break;
+		}
+	}
+	STARPU_ASSERT(n == nworkers);
+
+	_starpu_task_expected_predictions(task, component->tree->sched_ctx_id, nworkers, workerids, impl_masks, lengths, NULL, NULL);
+
+	/* And reduce them for each child */
+	n = 0;
+	for(i = 0; i < component->nchildren; i++)
+	{
+		struct starpu_sched_component * c = component->children[i];
+		unsigned nchild = STARPU_SCHED_COMPONENT_IS_HOMOGENEOUS(c) ? starpu_bitmap_first(&c->workers_in_ctx) != -1 : (unsigned) starpu_bitmap_cardinal(&c->workers_in_ctx);
+		unsigned end = n + nchild;
+		double len = DBL_MAX;
+
+		can_execute[i] = 0;
+		for(; n < end && !isnan(len); n++)
+		{
+			unsigned nimpl;
+			for(nimpl = 0; nimpl < STARPU_MAXIMPLEMENTATIONS; nimpl++)
+			{
+				double d;
+				if (!(impl_masks[n] & (1U << nimpl)))
+					continue;
+				can_execute[i] = 1;
+				d = lengths[nimpl * nworkers + n];
+				if(isnan(d))
+				{
+					len = d;
+					break;
+				}
+				if(_STARPU_IS_ZERO(d))
+					continue;
+				STARPU_ASSERT_MSG(d >= 0, "workerid=%u, nimpl=%u, d=%lf\n", workerids[n], nimpl, d);
+				if(d < len)
+					len = d;
+			}
+		}
+		n = end;
+
+		if(len == DBL_MAX) /* we dont have perf model */
+			len = 0.0;
+		estimated_lengths[i] = len;
+	}
+}
+
+static unsigned compute_execution_times(struct starpu_sched_component *component, struct starpu_task *task,
 				       double *estimated_lengths, double *estimated_transfer_length, unsigned *suitable_components)
 {
 	unsigned nsuitable_components = 0;
+	int can_execute[component->nchildren];
+	/* Transfer length for single memory node children, per memory node */
+	double node_transfer_length[STARPU_MAXNODES];
 
 	unsigned i;
+	for(i = 0; i < STARPU_MAXNODES; i++)
+		node_transfer_length[i] = NAN;
+
+	if (!task->bundle)
+		compute_batched_lengths(component, task, estimated_lengths, can_execute);
+
 	for(i = 0; i < component->nchildren; i++)
 	{
 		struct starpu_sched_component * c = component->children[i];
 
 		/* Silence static analysis warnings */
-		estimated_lengths[i] = NAN;
+		if (task->bundle)
+			estimated_lengths[i] = NAN;
 		estimated_transfer_length[i] = NAN;
 
-		if(starpu_sched_component_execute_preds(c, task, estimated_lengths + i))
+		if(task->bundle ? starpu_sched_component_execute_preds(c, task, estimated_lengths + i) : can_execute[i])
 		{
 			if(isnan(estimated_lengths[i]))
 				/* The perfmodel had been purged since the task was pushed
@@ -130,13 +293,167 @@ unsigned starpu_mct_compute_execution_times(struct starpu_sched_component *compo
 				continue;
 			STARPU_ASSERT_MSG(estimated_lengths[i]>=0, "component=%p, child[%u]=%p, estimated_lengths[%u]=%lf\n", component, i, c, i, estimated_lengths[i]);
 
-			estimated_transfer_length[i] = starpu_sched_component_transfer_length(c, task);
+			if(STARPU_SCHED_COMPONENT_IS_SINGLE_MEMORY_NODE(c))
+			{
+				/* Children on the same memory node have the same transfer length */
+				unsigned memory_node = starpu_worker_get_memory_node(starpu_bitmap_first(&c->workers_in_ctx));
+				if(isnan(node_transfer_length[memory_node]))
+					node_transfer_length[memory_node] = starpu_sched_component_transfer_length(c, task);
+				estimated_transfer_length[i] = node_transfer_length[memory_node];
+			}
+			else
+				estimated_transfer_length[i] = starpu_sched_component_transfer_length(c, task);
 			suitable_components[nsuitable_components++] = i;
 		}
 	}
 	return nsuitable_components;
 }
 
+/* Whether the execution and transfer times of the task only depend on what
+ * the cache key captures */
+static int cache_can_be_used(struct starpu_task *task)
+{
+	struct starpu_codelet *cl = task->cl;
+
+	if (!cl || task->bundle || task->execute_on_a_specific_worker || task->workerids_len
+	    || task->where != (int32_t) cl->where || cl->can_execute || _starpu_config.conf.data_locality_enforce)
+		return 0;
+
+	/* Other models may depend on anything in the task */
+	if (cl->model && cl->model->type != STARPU_HISTORY_BASED
+		      && cl->model->type != STARPU_REGRESSION_BASED
+		      && cl->model->type != STARPU_NL_REGRESSION_BASED)
+		return 0;
+
+	return 1;
+}
+
+static void cache_compute_key(struct starpu_task *task, struct _starpu_mct_cache_key *key)
+{
+	struct _starpu_job *j = _starpu_get_job_associated_to_task(task);
+	unsigned nbuffers = STARPU_TASK_GET_NBUFFERS(task);
+	unsigned nnodes = starpu_memory_nodes_get_count();
+	uint32_t location = 0;
+	unsigned i, node;
+
+	memset(key, 0, sizeof(*key));
+	key->cl = task->cl;
+	key->footprint = _starpu_compute_buffers_footprint(task->cl->model, NULL, 0, j);
+
+	for (i = 0; i < nbuffers; i++)
+	{
+		starpu_data_handle_t handle = STARPU_TASK_GET_HANDLE(task, i);
+		enum starpu_data_access_mode mode = STARPU_TASK_GET_MODE(task, i);
+		size_t size = starpu_data_get_size(handle);
+		uint64_t where = 0;
+
+		for (node = 0; node < nnodes; node++)
+		{
+			if (starpu_data_is_on_node(handle, node))
+				where |= 1ULL << (node % 64);
+			if (node % 64 == 63 || node == nnodes - 1)
+			{
+				location = starpu_hash_crc32c_be_n(&where, sizeof(where), location);
+				where = 0;
+			}
+		}
+		location = starpu_hash_crc32c_be(mode, location);
+		location = starpu_hash_crc32c_be_n(&size, sizeof(size), location);
+	}
+	key->location = location;
+}
+
+/* Predictions are memoized for tasks which look the same: same codelet, same
+ * footprint, and data at the same places. The cache is flushed whenever a
+ * performance model or the set of workers changes. Only the predictions are
+ * cached: the load of the workers is always taken into account afresh by
+ * starpu_mct_compute_expected_times. */
+unsigned starpu_mct_compute_execution_times(struct _starpu_mct_data *d, struct starpu_sched_component *component, struct starpu_task *task,
+				       double *estimated_lengths, double *estimated_transfer_length, unsigned *suitable_components)
+{
+	struct _starpu_mct_cache_key key;
+	struct _starpu_mct_cache_entry *entry;
+	unsigned nsuitable_components, i;
+	unsigned generation;
+
+	if (!d->cache_enabled || !cache_can_be_used(task))
+		return compute_execution_times(component, task, estimated_lengths, estimated_transfer_length, suitable_components);
+
+	cache_compute_key(task, &key);
+
+	STARPU_HG_DISABLE_CHECKING(_starpu_perfmodel_generation);
+	generation = _starpu_perfmodel_generation;
+
+	STARPU_PTHREAD_MUTEX_LOCK(&d->cache_mutex);
+	if (d->cache_generation != generation || d->cache_nchildren != component->nchildren
+	    || memcmp(&d->cache_workers, &component->workers_in_ctx, sizeof(d->cache_workers)))
+	{
+		cache_flush(d);
+		d->cache_generation = generation;
+		d->cache_nchildren = component->nchildren;
+		d->cache_workers = component->workers_in_ctx;
+	}
+
+	HASH_FIND(hh, d->cache, &key, sizeof(key), entry);
+	if (entry)
+	{
+		nsuitable_components = entry->nsuitable_components;
+		memcpy(suitable_components, entry->suitable_components, nsuitable_components * sizeof(*suitable_components));
+		for (i = 0; i < nsuitable_components; i++)
+		{
+			unsigned icomponent = suitable_components[i];
+			estimated_lengths[icomponent] = entry->estimated_lengths[icomponent];
+			estimated_transfer_length[icomponent] = entry->estimated_transfer_length[icomponent];
+		}
+		STARPU_PTHREAD_MUTEX_UNLOCK(&d->cache_mutex);
+		return nsuitable_components;
+	}
+	STARPU_PTHREAD_MUTEX_UNLOCK(&d->cache_mutex);
+
+	nsuitable_components = compute_execution_times(component, task, estimated_lengths, estimated_transfer_length, suitable_components);
+
+	/* Do not keep anything while some workers still need calibration */
+	for (i = 0; i < component->nchildren; i++)
+		if (isnan(estimated_lengths[i]))
+			return nsuitable_components;
+
+	_STARPU_MALLOC(entry, sizeof(*entry));
+	entry->key = key;
+	entry->nsuitable_components = nsuitable_components;
+	_STARPU_MALLOC(entry->suitable_components, component->nchildren * sizeof(*entry->suitable_components));
+	_STARPU_MALLOC(entry->estimated_lengths, component->nchildren * sizeof(*entry->estimated_lengths));
+	_STARPU_MALLOC(entry->estimated_transfer_length, component->nchildren * sizeof(*entry->estimated_transfer_length));
+	memcpy(entry->suitable_components, suitable_components, nsuitable_components * sizeof(*suitable_components));
+	memcpy(entry->estimated_lengths, estimated_lengths, component->nchildren * sizeof(*estimated_lengths));
+	memcpy(entry->estimated_transfer_length, estimated_transfer_length, component->nchildren * sizeof(*estimated_transfer_length));
+
+	STARPU_PTHREAD_MUTEX_LOCK(&d->cache_mutex);
+	if (d->cache_generation != generation || d->cache_nchildren != component->nchildren)
+	{
+		/* Got invalidated meanwhile */
+		STARPU_PTHREAD_MUTEX_UNLOCK(&d->cache_mutex);
+		cache_entry_free(entry);
+		return nsuitable_components;
+	}
+	struct _starpu_mct_cache_entry *old;
+	HASH_FIND(hh, d->cache, &key, sizeof(key), old);
+	if (old)
+	{
+		/* Somebody else computed it meanwhile */
+		cache_entry_free(entry);
+	}
+	else
+	{
+		if (d->cache_nentries >= _STARPU_MCT_CACHE_MAX_ENTRIES)
+			cache_flush(d);
+		HASH_ADD(hh, d->cache, key, sizeof(key), entry);
+		d->cache_nentries++;
+	}
+	STARPU_PTHREAD_MUTEX_UNLOCK(&d->cache_mutex);
+
+	return nsuitable_components;
+}
+
 void starpu_mct_compute_expected_times(struct starpu_sched_component *component, struct starpu_task *task STARPU_ATTRIBUTE_UNUSED,
 		double *estimated_lengths, double *estimated_transfer_length, double *estimated_ends_with_task,
 				       double *min_exp_end_of_task, double *max_exp_end_of_workers, unsigned *suitable_components, unsigned nsuitable_components)
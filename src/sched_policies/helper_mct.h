@@ -19,6 +19,8 @@
 
 /** @file */
 
+struct _starpu_mct_cache_entry;
+
 struct _starpu_mct_data
 {
 	double alpha;
@@ -26,11 +28,26 @@ struct _starpu_mct_data
 	double _gamma;
 	double idle_power;
 	starpu_pthread_mutex_t scheduling_mutex;
+
+	/* Cache of the execution and transfer times of the tasks, indexed by
+	 * codelet, footprint and location of the data, see
+	 * STARPU_SCHED_MCT_CACHE */
+	int cache_enabled;
+	struct _starpu_mct_cache_entry *cache;
+	unsigned cache_nentries;
+	/* What the cache was computed for */
+	unsigned cache_generation;
+	unsigned cache_nchildren;
+	struct starpu_bitmap cache_workers;
+	starpu_pthread_mutex_t cache_mutex;
 };
 
 struct _starpu_mct_data *starpu_mct_init_parameters(struct starpu_sched_component_mct_data *params);
 
-unsigned starpu_mct_compute_execution_times(struct starpu_sched_component *component,
+void starpu_mct_deinit_parameters(struct _starpu_mct_data *d);
+
+unsigned starpu_mct_compute_execution_times(struct _starpu_mct_data *d,
+					    struct starpu_sched_component *component,
 					    struct starpu_task *task,
 					    double *estimated_lengths,
 					    double *estimated_transfer_length,
@@ -374,6 +374,11 @@ struct _starpu_heteroprio_data
 	// 1 = if a task has no implementation on arch, expected time will be the shortest time among all archs
 	unsigned autoheteroprio_time_estimation_policy;
 
+	// relative difference of score (resp. time) needed to swap two priorities (resp. to change a slow factor or
+	// the fastest arch of a priority), so that the mapping does not keep changing because of measurement noise
+	// 0 = always apply the latest ordering and factors
+	double autoheteroprio_hysteresis;
+
 
 	// environment hyperparameters
 
@@ -399,6 +404,9 @@ struct _starpu_heteroprio_data
 
 	int priority_last_ordering;
 
+	// rank+1 of each bucket for each arch at the last ordering, 0 if it was not ordered yet
+	unsigned prio_last_rank[STARPU_NB_TYPES][HETEROPRIO_MAX_PRIO];
+
 	// lightweight time profiling:
 
 	// busy time and free time of each arch for current execution
@@ -1455,6 +1463,10 @@ static void initialize_heteroprio_policy(unsigned sched_ctx_id)
 		_STARPU_DISP("[AUTOHETEROPRIO] Print on update : %s\n", hp->autoheteroprio_print_data_on_update?"ENABLED":"DISABLED");
 
 		hp->autoheteroprio_time_estimation_policy = starpu_getenv_number_default("STARPU_AUTOHETEROPRIO_TIME_ESTIMATION_POLICY", 0);
+
+		hp->autoheteroprio_hysteresis = starpu_getenv_float_default("STARPU_AUTOHETEROPRIO_HYSTERESIS", 0.1);
+		STARPU_ASSERT_MSG(hp->autoheteroprio_hysteresis >= 0., "STARPU_AUTOHETEROPRIO_HYSTERESIS must be >= 0.\n");
+		_STARPU_DISP("[AUTOHETEROPRIO] Hysteresis : %f\n", hp->autoheteroprio_hysteresis);
 	}
 
 	starpu_bitmap_init(&hp->waiters);
@@ -1824,7 +1836,7 @@ static void deinitialize_heteroprio_policy(unsigned sched_ctx_id)
 		starpu_autoheteroprio_save_task_data(hp);
 	}
 
-	_starpu_graph_record = 0; // disable starpu graph recording (that may have been activated due to hp->use_auto_calibration)
+	_starpu_graph_record_disable(); // disable starpu graph recording (that may have been activated due to hp->use_auto_calibration), unless needed for critical path analysis or lookahead
 
 	free(hp);
 }
@@ -2358,17 +2370,58 @@ static double rpg(double x)
 	return sqrt(x)*sqrt(2.0f-x);
 }
 
-struct prio_score
-{
-	unsigned index;
-	double score;
-};
-
 static int compare_prio_scores(const void* elem1, const void* elem2)
 {
-	if(((const struct prio_score*)elem1)->score > ((const struct prio_score*)elem2)->score)
+	if(((const struct _starpu_heteroprio_score*)elem1)->score > ((const struct _starpu_heteroprio_score*)elem2)->score)
 		return -1;
-	return ((const struct prio_score*)elem1)->score < ((const struct prio_score*)elem2)->score;
+	return ((const struct _starpu_heteroprio_score*)elem1)->score < ((const struct _starpu_heteroprio_score*)elem2)->score;
+}
+
+// previous order first, then the priorities which were never ordered
+static int compare_prio_last_ranks(const void* elem1, const void* elem2)
+{
+	const struct _starpu_heteroprio_score *score1 = elem1, *score2 = elem2;
+	const unsigned rank1 = score1->last_rank ? score1->last_rank : HETEROPRIO_MAX_PRIO + 1 + score1->index;
+	const unsigned rank2 = score2->last_rank ? score2->last_rank : HETEROPRIO_MAX_PRIO + 1 + score2->index;
+	return (rank1 > rank2) - (rank1 < rank2);
+}
+
+// whether score1 is sufficiently better than score2 to be placed before it
+static int prio_score_overtakes(double hysteresis, const struct _starpu_heteroprio_score *score1, const struct _starpu_heteroprio_score *score2)
+{
+	const double margin = hysteresis * fmax(fabs(score1->score), fabs(score2->score));
+	return score1->score > score2->score + margin;
+}
+
+void _starpu_heteroprio_sort_scores(struct _starpu_heteroprio_score *scores, unsigned n, double hysteresis)
+{
+	unsigned i, pass;
+
+	if(hysteresis == 0.)
+	{
+		qsort(scores, n, sizeof(struct _starpu_heteroprio_score), compare_prio_scores);
+		return;
+	}
+
+	qsort(scores, n, sizeof(struct _starpu_heteroprio_score), compare_prio_last_ranks);
+
+	// bubble sort, each pass moves up the priorities which overtake their predecessor
+	for(pass = 0; pass < n; ++pass)
+	{
+		unsigned swapped = 0;
+		for(i = 0; i + 1 < n; ++i)
+		{
+			if(prio_score_overtakes(hysteresis, &scores[i+1], &scores[i]))
+			{
+				struct _starpu_heteroprio_score tmp = scores[i];
+				scores[i] = scores[i+1];
+				scores[i+1] = tmp;
+				swapped = 1;
+			}
+		}
+		if(!swapped)
+			break;
+	}
 }
 
 static void order_priorities(struct _starpu_heteroprio_data *hp)
@@ -2376,7 +2429,7 @@ static void order_priorities(struct _starpu_heteroprio_data *hp)
 	STARPU_ASSERT(use_auto_mode);
 	STARPU_ASSERT(hp->use_auto_calibration); // priorities should only be changed during execution if in auto calibration mode
 
-	struct prio_score prio_arch[STARPU_NB_TYPES][HETEROPRIO_MAX_PRIO];
+	struct _starpu_heteroprio_score prio_arch[STARPU_NB_TYPES][HETEROPRIO_MAX_PRIO];
 	unsigned prio_arch_index[STARPU_NB_TYPES] = {0};
 
 	// lock the global policy mutex
@@ -2477,6 +2530,7 @@ static void order_priorities(struct _starpu_heteroprio_data *hp)
 				double URT = (URT_own*need_own + URT_other*need_other);
 
 				prio_arch[a][prio].index = p;
+				prio_arch[a][prio].last_rank = hp->prio_last_rank[a][p];
 
 				if(hp->autoheteroprio_priority_ordering_policy == STARPU_HETEROPRIO_NOD_TIME_COMBINATION)
 				{
@@ -2614,7 +2668,7 @@ static void order_priorities(struct _starpu_heteroprio_data *hp)
 
 	for(a=0;a<STARPU_NB_TYPES;++a)
 	{
-		qsort(&prio_arch[a][0], hp->found_codelet_names_on_arch[a], sizeof(struct prio_score), compare_prio_scores);
+		_starpu_heteroprio_sort_scores(&prio_arch[a][0], hp->found_codelet_names_on_arch[a], hp->autoheteroprio_hysteresis);
 	}
 
 	starpu_heteroprio_clear_mapping_hp(hp);
@@ -2624,6 +2678,7 @@ static void order_priorities(struct _starpu_heteroprio_data *hp)
 		for(p=0;p<hp->found_codelet_names_on_arch[a];++p)
 		{
 			starpu_heteroprio_set_mapping_hp(hp, a, p, prio_arch[a][p].index);
+			hp->prio_last_rank[a][prio_arch[a][p].index] = p + 1;
 		}
 	}
 
@@ -3129,6 +3184,51 @@ static void add_best_time_to_data(struct _starpu_heteroprio_data *hp, unsigned t
 					+ sum / (double)count;
 }
 
+unsigned _starpu_heteroprio_update_slow_factors(const unsigned valid_archs[STARPU_NARCH], const double arch_times[STARPU_NARCH], unsigned current_base_arch, float slow_factors[STARPU_NARCH], double hysteresis)
+{
+	unsigned arch = 0;
+	while(!valid_archs[arch])
+		++arch;
+	unsigned fastest_arch = arch;
+	double best_time = arch_times[arch];
+
+	++arch;
+	for(; arch < STARPU_NB_TYPES; ++arch)
+	{
+		if(valid_archs[arch] && arch_times[arch] < best_time)
+		{
+			fastest_arch = arch;
+			best_time = arch_times[arch];
+		}
+	}
+
+	if(current_base_arch != fastest_arch && valid_archs[current_base_arch]
+	   && arch_times[current_base_arch] <= best_time * (1. + hysteresis))
+	{
+		// the new fastest arch is not faster by enough, keep the same base arch
+		fastest_arch = current_base_arch;
+		best_time = arch_times[fastest_arch];
+	}
+
+	for(arch = 0; arch < STARPU_NB_TYPES; ++arch)
+	{
+		if(valid_archs[arch] && arch != fastest_arch)
+		{
+			// when the base arch was kept while being slightly slower, the
+			// faster arch would get a factor below 1, which would let it
+			// steal the tasks of the bucket more eagerly than the base arch
+			// itself, consider them as fast as each other instead
+			const double slow_factor = fmax(arch_times[arch]/best_time, 1.);
+			const double current_slow_factor = slow_factors[arch];
+			if(fastest_arch != current_base_arch
+			   || fabs(slow_factor - current_slow_factor) > hysteresis * current_slow_factor)
+				slow_factors[arch] = slow_factor;
+		}
+	}
+
+	return fastest_arch;
+}
+
 static void autoheteroprio_update_slowdown_data(struct _starpu_heteroprio_data *hp)
 {
 	unsigned p, arch;
@@ -3153,28 +3253,18 @@ static void autoheteroprio_update_slowdown_data(struct _starpu_heteroprio_data *
 			;
 		STARPU_ASSERT(arch < STARPU_NB_TYPES);
 
-		arch = 0;
-		while(!valid_archs[arch])
-			++arch;
-		unsigned fastest_arch = arch;
-		double best_time = arch_times[arch];
-
-		++arch;
-		for(; arch < STARPU_NB_TYPES; ++arch)
-		{
-			if(valid_archs[arch] && arch_times[arch] < best_time)
-			{
-				fastest_arch = arch;
-				best_time = arch_times[arch];
-			}
-		}
+		const unsigned current_base_arch = hp->buckets[p].factor_base_arch_index;
+		float slow_factors[STARPU_NB_TYPES];
+		memcpy(slow_factors, hp->buckets[p].slow_factors_per_index, sizeof(slow_factors));
+		const unsigned base_arch = _starpu_heteroprio_update_slow_factors(valid_archs, arch_times, current_base_arch, slow_factors, hp->autoheteroprio_hysteresis);
 
-		starpu_heteroprio_set_faster_arch_hp(hp, fastest_arch, p);
+		if(base_arch != current_base_arch)
+			starpu_heteroprio_set_faster_arch_hp(hp, base_arch, p);
 
 		for(arch = 0; arch < STARPU_NB_TYPES; ++arch)
 		{
-			if(valid_archs[arch] && arch != fastest_arch)
-				starpu_heteroprio_set_arch_slow_factor_hp(hp, arch, p, arch_times[arch]/best_time);
+			if(valid_archs[arch] && arch != base_arch)
+				starpu_heteroprio_set_arch_slow_factor_hp(hp, arch, p, slow_factors[arch]);
 		}
 	}
 
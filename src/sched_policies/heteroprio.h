@@ -17,6 +17,7 @@
 #ifndef __SCHED_HETEROPRIO_H__
 #define __SCHED_HETEROPRIO_H__
 
+#include <starpu_util.h>
 #include <schedulers/starpu_heteroprio.h>
 
 #define CODELET_MAX_NAME_LENGTH 32
@@ -41,4 +42,22 @@
 // (probably in us)
 #define AUTOHETEROPRIO_MAX_WORKER_PROFILING_TIME 1000000000.0
 
+// score of a priority when ordering them automatically
+struct _starpu_heteroprio_score
+{
+	unsigned index;
+	double score;
+	// rank+1 at the last ordering, 0 if none
+	unsigned last_rank;
+};
+
+// sort the priorities by decreasing score, but starting from the previous order and only letting a priority
+// overtake another one if its score is better by the hysteresis margin
+void _starpu_heteroprio_sort_scores(struct _starpu_heteroprio_score *scores, unsigned n, double hysteresis) STARPU_ATTRIBUTE_VISIBILITY_DEFAULT;
+
+// pick the base arch of a bucket from the estimated times of the archs which can execute it, and update the slow
+// factors of the other archs accordingly, only changing the base arch or a factor when the difference is larger
+// than the hysteresis margin. Returns the base arch
+unsigned _starpu_heteroprio_update_slow_factors(const unsigned valid_archs[STARPU_NARCH], const double arch_times[STARPU_NARCH], unsigned current_base_arch, float slow_factors[STARPU_NARCH], double hysteresis) STARPU_ATTRIBUTE_VISIBILITY_DEFAULT;
+
 #endif // __SCHED_HETEROPRIO_H__
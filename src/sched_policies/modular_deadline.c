@@ -0,0 +1,65 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+/*
+ * Deadline-aware scheduler: a single deadline component, from which idle
+ * workers pull the task with the least laxity, tasks without a deadline
+ * coming last.
+ */
+
+#include <starpu_sched_component.h>
+#include <starpu_scheduler.h>
+
+static void initialize_deadline_policy(unsigned sched_ctx_id)
+{
+	struct starpu_sched_tree *t;
+	struct starpu_sched_component_deadline_data params;
+	unsigned nworkers = starpu_worker_get_count();
+	unsigned i;
+
+	params.laxity = starpu_getenv_number_default("STARPU_SCHED_DEADLINE_LAXITY", 1);
+
+	t = starpu_sched_tree_create(sched_ctx_id);
+	t->root = starpu_sched_component_deadline_create(t, &params);
+
+	for (i = 0; i < nworkers; i++)
+	{
+		struct starpu_sched_component *worker_component = starpu_sched_component_worker_new(sched_ctx_id, i);
+		/* The task is only given to a worker when it pulls it, choose
+		 * the implementation at that moment */
+		struct starpu_sched_component *impl_component = starpu_sched_component_best_implementation_create(t, NULL);
+		starpu_sched_component_connect(impl_component, worker_component);
+		starpu_sched_component_connect(t->root, impl_component);
+	}
+
+	starpu_sched_tree_update_workers(t);
+	starpu_sched_ctx_set_policy_data(sched_ctx_id, (void*)t);
+}
+
+struct starpu_sched_policy _starpu_sched_modular_deadline_policy =
+{
+	.init_sched = initialize_deadline_policy,
+	.deinit_sched = starpu_sched_tree_deinitialize,
+	.add_workers = starpu_sched_tree_add_workers,
+	.remove_workers = starpu_sched_tree_remove_workers,
+	.push_task = starpu_sched_tree_push_task,
+	.pop_task = starpu_sched_tree_pop_task,
+	.pre_exec_hook = NULL,
+	.post_exec_hook = NULL,
+	.policy_name = "modular-deadline",
+	.policy_description = "least laxity first modular policy for tasks with deadlines",
+	.worker_type = STARPU_WORKER_LIST,
+};
@@ -221,6 +221,7 @@ void starpu_sched_component_initialize_simple_schedulers(unsigned sched_ctx_id,
 
 		int above_prio = starpu_getenv_number_default("STARPU_SCHED_SORTED_ABOVE", (flags & STARPU_SCHED_SIMPLE_FIFO_ABOVE_PRIO) ? 1 : 0);
 		int below_prio = starpu_getenv_number_default("STARPU_SCHED_SORTED_BELOW", (flags & STARPU_SCHED_SIMPLE_FIFOS_BELOW_PRIO) ? 1 : 0);
+		int sharded_above = starpu_getenv_number_default("STARPU_SCHED_SHARDED_ABOVE", 0);
 
 		if (nbelow == 1 && !(flags & STARPU_SCHED_SIMPLE_DECIDE_ALWAYS))
 		{
@@ -244,7 +245,17 @@ void starpu_sched_component_initialize_simple_schedulers(unsigned sched_ctx_id,
 		if (flags & STARPU_SCHED_SIMPLE_FIFO_ABOVE)
 		{
 			struct starpu_sched_component *fifo_above;
-			if (above_prio)
+			if (sharded_above > 0)
+			{
+				/* Many threads may be submitting tasks, split the queue */
+				struct starpu_sched_component_sharded_data sharded_data =
+					{
+						.nshards = sharded_above,
+						.prio = above_prio,
+					};
+				fifo_above = starpu_sched_component_sharded_create(t, &sharded_data);
+			}
+			else if (above_prio)
 			{
 				fifo_above = starpu_sched_component_prio_create(t, NULL);
 			}
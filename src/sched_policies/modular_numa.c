@@ -0,0 +1,159 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+/*
+ * Hierarchical scheduler: locality components are stacked following the hwloc
+ * tree of the machine (machine, packages, NUMA nodes, caches, cores), so that
+ * tasks are pushed towards the data they need, and idle workers steal from
+ * their closest neighbours first.
+ */
+
+#include <starpu_sched_component.h>
+#include <starpu_scheduler.h>
+#include <core/workers.h>
+
+/* Add the component for worker workerid below parent */
+static void connect_worker(struct starpu_sched_tree *t, struct starpu_sched_component *parent, unsigned workerid)
+{
+	struct starpu_sched_component *worker_component = starpu_sched_component_worker_new(t->sched_ctx_id, workerid);
+	/* Tasks may be stolen by any worker, so choose the implementation at
+	 * the last moment */
+	struct starpu_sched_component *impl_component = starpu_sched_component_best_implementation_create(t, NULL);
+	starpu_sched_component_connect(impl_component, worker_component);
+	starpu_sched_component_connect(parent, impl_component);
+}
+
+#ifdef STARPU_HAVE_HWLOC
+/* Build the locality subtree for the n workers of the array workers, which
+ * are all below obj */
+static struct starpu_sched_component *make_locality_subtree(struct starpu_sched_tree *t, hwloc_topology_t topology, hwloc_obj_t obj, unsigned *workers, unsigned n)
+{
+	struct starpu_sched_component *component;
+	unsigned *child_workers;
+	unsigned i, j, nchild;
+
+	/* Skip the levels which do not split the workers */
+	while (1)
+	{
+		hwloc_obj_t only_child = NULL;
+		for (i = 0; i < n; i++)
+			if (_starpu_get_worker_struct(workers[i])->hwloc_obj == obj)
+				break;
+		if (i < n)
+			/* Some workers are right here */
+			break;
+
+		for (j = 0; j < obj->arity; j++)
+		{
+			for (i = 0; i < n; i++)
+				if (hwloc_obj_is_in_subtree(topology, _starpu_get_worker_struct(workers[i])->hwloc_obj, obj->children[j]))
+					break;
+			if (i == n)
+				continue;
+			if (only_child)
+			{
+				only_child = NULL;
+				break;
+			}
+			only_child = obj->children[j];
+		}
+		if (!only_child)
+			break;
+		obj = only_child;
+	}
+
+	component = starpu_sched_component_locality_create(t, NULL);
+	component->obj = obj;
+
+	_STARPU_MALLOC(child_workers, n * sizeof(*child_workers));
+	for (j = 0; j < obj->arity; j++)
+	{
+		nchild = 0;
+		for (i = 0; i < n; i++)
+			if (_starpu_get_worker_struct(workers[i])->hwloc_obj != obj
+			    && hwloc_obj_is_in_subtree(topology, _starpu_get_worker_struct(workers[i])->hwloc_obj, obj->children[j]))
+				child_workers[nchild++] = workers[i];
+
+		if (nchild == 1)
+			connect_worker(t, component, child_workers[0]);
+		else if (nchild > 1)
+			starpu_sched_component_connect(component, make_locality_subtree(t, topology, obj->children[j], child_workers, nchild));
+	}
+	free(child_workers);
+
+	for (i = 0; i < n; i++)
+		if (_starpu_get_worker_struct(workers[i])->hwloc_obj == obj)
+			connect_worker(t, component, workers[i]);
+
+	return component;
+}
+#endif
+
+static void initialize_numa_policy(unsigned sched_ctx_id)
+{
+	struct starpu_sched_tree *t;
+	unsigned nworkers = starpu_worker_get_count();
+	unsigned i;
+
+	t = starpu_sched_tree_create(sched_ctx_id);
+	t->root = starpu_sched_component_locality_create(t, NULL);
+
+#ifdef STARPU_HAVE_HWLOC
+	struct _starpu_machine_config *config = _starpu_get_machine_config();
+	hwloc_topology_t topology = config->topology.hwtopology;
+	unsigned *cpu_workers;
+	unsigned ncpu_workers = 0;
+
+	/* Only CPU workers follow the hierarchy, the others (and CPU workers
+	 * which are not bound) are put at the top */
+	_STARPU_MALLOC(cpu_workers, nworkers * sizeof(*cpu_workers));
+	for (i = 0; i < nworkers; i++)
+	{
+		struct _starpu_worker *worker = _starpu_get_worker_struct(i);
+		if (worker->arch == STARPU_CPU_WORKER && worker->hwloc_obj)
+			cpu_workers[ncpu_workers++] = i;
+		else
+			connect_worker(t, t->root, i);
+	}
+
+	if (ncpu_workers == 1)
+		connect_worker(t, t->root, cpu_workers[0]);
+	else if (ncpu_workers > 1)
+		starpu_sched_component_connect(t->root, make_locality_subtree(t, topology, hwloc_get_root_obj(topology), cpu_workers, ncpu_workers));
+	free(cpu_workers);
+#else
+	for (i = 0; i < nworkers; i++)
+		connect_worker(t, t->root, i);
+#endif
+
+	starpu_sched_tree_update_workers(t);
+	starpu_sched_ctx_set_policy_data(sched_ctx_id, (void*)t);
+}
+
+struct starpu_sched_policy _starpu_sched_modular_numa_policy =
+{
+	.init_sched = initialize_numa_policy,
+	.deinit_sched = starpu_sched_tree_deinitialize,
+	.add_workers = starpu_sched_tree_add_workers,
+	.remove_workers = starpu_sched_tree_remove_workers,
+	.push_task = starpu_sched_tree_push_task,
+	.pop_task = starpu_sched_tree_pop_task,
+	.pre_exec_hook = NULL,
+	.post_exec_hook = NULL,
+	.policy_name = "modular-numa",
+	.policy_description = "hierarchical locality-aware modular policy",
+	.worker_type = STARPU_WORKER_LIST,
+};
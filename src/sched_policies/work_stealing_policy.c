@@ -21,6 +21,7 @@
 
 #include <float.h>
 #include <limits.h>
+#include <math.h>
 
 #include <core/workers.h>
 #include <core/debug.h>
@@ -89,6 +90,20 @@ struct _starpu_work_stealing_data_per_worker
 	 */
 	unsigned last_pop_worker;
 
+	/* For cws */
+	/* Topology distance to the other workers */
+	unsigned *distance;
+	/* Size of the input data of the queued tasks */
+	size_t queued_bytes;
+	/* Number of pops during which we will not try to steal again */
+	unsigned steal_skip;
+	/* Current backoff, doubled on each failed steal */
+	unsigned steal_backoff;
+	/* Whether the last steal failed because the victim was busy */
+	int steal_contended;
+	/* Value of npushed at the last failed steal */
+	unsigned steal_npushed;
+
 #ifdef USE_LOCALITY_TASKS
 	/* This records the same as queue, but hashed by data accessed with locality flag.  */
 	/* FIXME: we record only one task per data, assuming that the access is
@@ -109,8 +124,18 @@ struct _starpu_work_stealing_data
 	 * better decisions about which queue to select when deferring work
 	 */
 	unsigned last_push_worker;
+	/* cws: steal half of the victim queue, account the transfer cost, and
+	 * back off after failed steals */
+	int cost_aware;
+	/* cws: number of tasks pushed so far, to notice new work */
+	unsigned npushed;
 };
 
+/* Maximum number of tasks stolen at once by cws */
+#define CWS_MAX_STEAL 32
+/* Maximum number of pops during which cws does not try to steal again */
+#define CWS_MAX_BACKOFF 64
+
 #ifdef USE_OVERLOAD
 
 /**
@@ -258,6 +283,39 @@ static void record_data_locality(struct starpu_task *task STARPU_ATTRIBUTE_UNUSE
 }
 #endif
 
+/* Size of the data that task reads */
+static size_t ws_task_input_size(struct starpu_task *task)
+{
+	unsigned i;
+	size_t size = 0;
+	for (i = 0; i < STARPU_TASK_GET_NBUFFERS(task); i++)
+		if (STARPU_TASK_GET_MODE(task, i) & STARPU_R)
+			size += starpu_data_get_size(STARPU_TASK_GET_HANDLE(task, i));
+	return size;
+}
+
+/* Called with the lock of workerid held when task was added to its queue */
+static void ws_task_queued(struct _starpu_work_stealing_data *ws, struct starpu_task *task, int workerid)
+{
+	if (ws->cost_aware)
+		ws->per_worker[workerid].queued_bytes += ws_task_input_size(task);
+}
+
+/* Called with the lock of workerid held when task was removed from its queue */
+static void ws_task_dequeued(struct _starpu_work_stealing_data *ws, struct starpu_task *task, int workerid)
+{
+	if (ws->cost_aware)
+	{
+		size_t size = ws_task_input_size(task);
+		struct _starpu_work_stealing_data_per_worker *data = &ws->per_worker[workerid];
+		if (!data->queue.ntasks || data->queued_bytes < size)
+			/* Data sizes may have changed meanwhile */
+			data->queued_bytes = 0;
+		else
+			data->queued_bytes -= size;
+	}
+}
+
 #ifdef USE_LOCALITY_TASKS
 /* Record in the worker which data it used last with the locality flag */
 static void record_worker_locality(struct _starpu_work_stealing_data *ws, struct starpu_task *task, int workerid, unsigned sched_ctx_id)
@@ -345,6 +403,7 @@ static struct starpu_task *ws_pick_task(struct _starpu_work_stealing_data *ws, i
 		/* found an interesting task, try to pick it! */
 		if (starpu_st_prio_deque_pop_this_task(&data_source->queue, target, best_task))
 		{
+			ws_task_dequeued(ws, best_task, source);
 			if (!data_source->queue.ntasks)
 			{
 				STARPU_ASSERT(ws->per_worker[source].notask == 0);
@@ -362,6 +421,8 @@ static struct starpu_task *ws_pick_task(struct _starpu_work_stealing_data *ws, i
 	else
 		task = starpu_st_prio_deque_pop_task_for_worker(&data_source->queue, target, NULL);
 
+	if (task)
+		ws_task_dequeued(ws, task, source);
 	if (task && !data_source->queue.ntasks)
 	{
 		STARPU_ASSERT(ws->per_worker[source].notask == 0);
@@ -408,6 +469,8 @@ static struct starpu_task *ws_pick_task(struct _starpu_work_stealing_data *ws, i
 	else
 		task = starpu_st_prio_deque_pop_task_for_worker(&ws->per_worker[source].queue, target, NULL);
 
+	if (task)
+		ws_task_dequeued(ws, task, source);
 	if (task && !ws->per_worker[source].queue.ntasks)
 	{
 		STARPU_ASSERT(ws->per_worker[source].notask == 0);
@@ -560,6 +623,86 @@ static inline unsigned select_worker(struct _starpu_work_stealing_data *ws, stru
 }
 
 
+/* cws: whether workerid should not try to steal for now */
+static int cws_backing_off(struct _starpu_work_stealing_data *ws, int workerid)
+{
+	struct _starpu_work_stealing_data_per_worker *data = &ws->per_worker[workerid];
+
+	if (!data->steal_skip)
+		return 0;
+	if (data->steal_npushed != ws->npushed)
+	{
+		/* New tasks were pushed meanwhile, try again now */
+		data->steal_skip = 0;
+		data->steal_backoff = 0;
+		return 0;
+	}
+	data->steal_skip--;
+#if !defined(STARPU_NON_BLOCKING_DRIVERS) && !defined(STARPU_SIMGRID)
+	if (data->steal_contended)
+		/* There is work to steal, do not go to sleep */
+		starpu_wake_worker_no_relax(workerid);
+#endif
+	return 1;
+}
+
+/* cws: the steal attempt of workerid failed, skip the next attempts,
+ * exponentially more and more. If the victim was just busy, the worker will
+ * stay awake, otherwise the worker may go to sleep until new tasks are
+ * pushed, which also ends the backoff. */
+static void cws_steal_failed(struct _starpu_work_stealing_data *ws, int workerid, unsigned npushed, int contended)
+{
+	struct _starpu_work_stealing_data_per_worker *data = &ws->per_worker[workerid];
+
+	data->steal_backoff = data->steal_backoff ? STARPU_MIN(2 * data->steal_backoff, CWS_MAX_BACKOFF) : 1;
+	data->steal_skip = data->steal_backoff;
+	data->steal_contended = contended;
+	data->steal_npushed = npushed;
+#if !defined(STARPU_NON_BLOCKING_DRIVERS) && !defined(STARPU_SIMGRID)
+	if (contended)
+		starpu_wake_worker_no_relax(workerid);
+#endif
+}
+
+/* cws: with the lock of victim held, after having stolen one task from it,
+ * steal more to get half of its queue. Return the number of tasks put in
+ * stolen. */
+static unsigned cws_steal_more(struct _starpu_work_stealing_data *ws, int victim, int workerid, unsigned sched_ctx_id, unsigned ntasks, struct starpu_task **stolen)
+{
+	unsigned nstolen = 0;
+	unsigned n = STARPU_MIN(ntasks / 2, CWS_MAX_STEAL);
+
+	while (nstolen < n)
+	{
+		struct starpu_task *task = ws_pick_task(ws, victim, workerid);
+		if (!task)
+			break;
+		starpu_sched_task_break(task);
+		starpu_sched_ctx_list_task_counters_decrement(sched_ctx_id, victim);
+		record_data_locality(task, workerid);
+		locality_popped_task(ws, task, victim, sched_ctx_id);
+		stolen[nstolen++] = task;
+	}
+	return nstolen;
+}
+
+/* cws: put the tasks stolen in excess in our own queue */
+static void cws_queue_stolen(struct _starpu_work_stealing_data *ws, int workerid, unsigned sched_ctx_id, struct starpu_task **stolen, unsigned nstolen)
+{
+	struct _starpu_work_stealing_data_per_worker *data = &ws->per_worker[workerid];
+	unsigned i;
+
+	for (i = 0; i < nstolen; i++)
+	{
+		starpu_st_prio_deque_push_back_task(&data->queue, stolen[i]);
+		locality_pushed_task(ws, stolen[i], workerid, sched_ctx_id);
+		ws_task_queued(ws, stolen[i], workerid);
+		starpu_sched_ctx_list_task_counters_increment(sched_ctx_id, workerid);
+	}
+	if (data->notask && data->queue.ntasks)
+		data->notask = 0;
+}
+
 /* Note: this is not scalable work stealing,  use lws instead */
 static struct starpu_task *ws_pop_task(unsigned sched_ctx_id)
 {
@@ -598,17 +741,28 @@ static struct starpu_task *ws_pop_task(unsigned sched_ctx_id)
 	}
 
 	/* we need to steal someone's job */
+	struct starpu_task *stolen[CWS_MAX_STEAL];
+	unsigned nstolen = 0;
+	unsigned npushed = ws->npushed;
+
+	if (ws->cost_aware && cws_backing_off(ws, workerid))
+		return NULL;
+
 	starpu_worker_relax_on();
 	int victim = ws->select_victim(ws, sched_ctx_id, workerid);
 	starpu_worker_relax_off();
 	if (victim == -1)
 	{
+		if (ws->cost_aware)
+			cws_steal_failed(ws, workerid, npushed, 0);
 		return NULL;
 	}
 
 	if (_starpu_worker_trylock(victim))
 	{
 		/* victim is busy, don't bother it, come back later */
+		if (ws->cost_aware)
+			cws_steal_failed(ws, workerid, npushed, 1);
 #ifdef STARPU_SIMGRID
 		starpu_sleep(0.000001);
 		/* Make sure we come back and not block */
@@ -618,7 +772,11 @@ static struct starpu_task *ws_pop_task(unsigned sched_ctx_id)
 	}
 	if (ws->per_worker[victim].running && ws->per_worker[victim].queue.ntasks > 0)
 	{
+		unsigned ntasks = ws->per_worker[victim].queue.ntasks;
 		task = ws_pick_task(ws, victim, workerid);
+		if (task && ws->cost_aware)
+			/* Take half of its queue at once */
+			nstolen = cws_steal_more(ws, victim, workerid, sched_ctx_id, ntasks - 1, stolen);
 	}
 
 	if (task)
@@ -632,6 +790,17 @@ static struct starpu_task *ws_pop_task(unsigned sched_ctx_id)
 	}
 	starpu_worker_unlock(victim);
 
+	if (ws->cost_aware)
+	{
+		if (nstolen)
+			cws_queue_stolen(ws, workerid, sched_ctx_id, stolen, nstolen);
+		if (task)
+			ws->per_worker[workerid].steal_backoff = 0;
+		else
+			/* It had nothing for us */
+			cws_steal_failed(ws, workerid, npushed, 0);
+	}
+
 #ifndef STARPU_NON_BLOCKING_DRIVERS
 	/* While stealing, perhaps somebody actually give us a task, don't miss
 	 * the opportunity to take it before going to sleep. */
@@ -699,9 +868,13 @@ int ws_push_task(struct starpu_task *task)
 		ws->per_worker[workerid].notask = 0;
 	}
 	locality_pushed_task(ws, task, workerid, sched_ctx_id);
+	ws_task_queued(ws, task, workerid);
 
 	starpu_push_task_end(task);
 	starpu_worker_unlock(workerid);
+	if (ws->cost_aware)
+		/* Let thieves which were backing off try again */
+		(void) STARPU_ATOMIC_ADD(&ws->npushed, 1);
 	starpu_sched_ctx_list_task_counters_increment(sched_ctx_id, workerid);
 
 #if !defined(STARPU_NON_BLOCKING_DRIVERS) || defined(STARPU_SIMGRID)
@@ -744,6 +917,10 @@ static void ws_add_workers(unsigned sched_ctx_id, int *workerids,unsigned nworke
 		STARPU_HG_DISABLE_CHECKING(ws->per_worker[workerid].queue.ntasks);
 		ws->per_worker[workerid].busy = 0;
 		STARPU_HG_DISABLE_CHECKING(ws->per_worker[workerid].busy);
+		ws->per_worker[workerid].queued_bytes = 0;
+		STARPU_HG_DISABLE_CHECKING(ws->per_worker[workerid].queued_bytes);
+		ws->per_worker[workerid].steal_skip = 0;
+		ws->per_worker[workerid].steal_backoff = 0;
 	}
 }
 
@@ -760,6 +937,8 @@ static void ws_remove_workers(unsigned sched_ctx_id, int *workerids, unsigned nw
 		ws->per_worker[workerid].running = 0;
 		free(ws->per_worker[workerid].proxlist);
 		ws->per_worker[workerid].proxlist = NULL;
+		free(ws->per_worker[workerid].distance);
+		ws->per_worker[workerid].distance = NULL;
 	}
 }
 
@@ -772,6 +951,9 @@ static void initialize_ws_policy(unsigned sched_ctx_id)
 	ws->last_push_worker = 0;
 	STARPU_HG_DISABLE_CHECKING(ws->last_push_worker);
 	ws->select_victim = select_victim;
+	ws->cost_aware = 0;
+	ws->npushed = 0;
+	STARPU_HG_DISABLE_CHECKING(ws->npushed);
 
 	unsigned nw = starpu_worker_get_count();
 	_STARPU_CALLOC(ws->per_worker, nw, sizeof(struct _starpu_work_stealing_data_per_worker));
@@ -802,6 +984,7 @@ struct starpu_sched_policy _starpu_sched_ws_policy =
 	.push_task_notify = ws_push_task_notify,
 	.pre_exec_hook = NULL,
 	.post_exec_hook = NULL,
+	.successor_continuation = 1,
 	.policy_name = "ws",
 	.policy_description = "work stealing",
 	.worker_type = STARPU_WORKER_LIST,
@@ -913,6 +1096,7 @@ struct starpu_sched_policy _starpu_sched_lws_policy =
 	.push_task_notify = ws_push_task_notify,
 	.pre_exec_hook = NULL,
 	.post_exec_hook = NULL,
+	.successor_continuation = 1,
 	.policy_name = "lws",
 	.policy_description = "locality work stealing",
 #ifdef STARPU_HAVE_HWLOC
@@ -921,3 +1105,123 @@ struct starpu_sched_policy _starpu_sched_lws_policy =
 	.worker_type = STARPU_WORKER_LIST,
 #endif
 };
+
+/* cost-aware work stealing policy */
+/* Number of topology levels to go through from worker a to worker b */
+static unsigned cws_distance(int a, int b)
+{
+	unsigned far = 2;
+
+	if (a == b)
+		return 0;
+#ifdef STARPU_HAVE_HWLOC
+	hwloc_topology_t topology = _starpu_get_machine_config()->topology.hwtopology;
+	hwloc_obj_t obj_a = _starpu_get_worker_struct(a)->hwloc_obj;
+	hwloc_obj_t obj_b = _starpu_get_worker_struct(b)->hwloc_obj;
+	if (obj_a && obj_b)
+	{
+		hwloc_obj_t ancestor = hwloc_get_common_ancestor_obj(topology, obj_a, obj_b);
+		return (obj_a->depth - ancestor->depth) + (obj_b->depth - ancestor->depth);
+	}
+	/* Not bound, consider it as far as the other side of the machine */
+	far = 2 * hwloc_topology_get_depth(topology);
+#endif
+	return starpu_worker_get_memory_node(a) == starpu_worker_get_memory_node(b) ? far / 2 : far;
+}
+
+/* Return a worker to steal tasks from. We will get half of its queue, and
+ * weight this by the cost of getting them: the topology distance, plus the
+ * time to transfer their input data, assuming that they are on the memory node
+ * of the victim. A topology level is thus accounted as much as a microsecond
+ * of transfer. */
+static int cws_select_victim(struct _starpu_work_stealing_data *ws, unsigned sched_ctx_id, int workerid)
+{
+	struct _starpu_work_stealing_data_per_worker *data = &ws->per_worker[workerid];
+	unsigned node = starpu_worker_get_memory_node(workerid);
+	int *workerids;
+	unsigned nworkers = starpu_sched_ctx_get_workers_list_raw(sched_ctx_id, &workerids);
+	double best_score = 0.;
+	int best = -1;
+	unsigned i;
+
+	for (i = 0; i < nworkers; i++)
+	{
+		int victim = workerids[i];
+		struct _starpu_work_stealing_data_per_worker *victim_data = &ws->per_worker[victim];
+		/* Here helgrind would shout that this is unprotected, but we
+		 * are fine with getting outdated values, this is just an
+		 * estimation */
+		unsigned ntasks = victim_data->queue.ntasks;
+		double cost, score;
+
+		if (victim == workerid || victim_data->notask || !ntasks)
+			continue;
+		if (!victim_data->busy && !starpu_worker_is_blocked_in_parallel(victim))
+			/* It will take them itself */
+			continue;
+
+		cost = data->distance[victim];
+		if (victim_data->queued_bytes)
+		{
+			unsigned victim_node = starpu_worker_get_memory_node(victim);
+			if (victim_node != node)
+			{
+				double transfer = starpu_transfer_predict(victim_node, node, victim_data->queued_bytes / ntasks);
+				if (!isnan(transfer))
+					cost += transfer * ((ntasks + 1) / 2);
+			}
+		}
+
+		score = ((ntasks + 1) / 2) / (1. + cost);
+		if (score > best_score)
+		{
+			best_score = score;
+			best = victim;
+		}
+	}
+	return best;
+}
+
+static void cws_add_workers(unsigned sched_ctx_id, int *workerids, unsigned nworkers)
+{
+	struct _starpu_work_stealing_data *ws = (struct _starpu_work_stealing_data*)starpu_sched_ctx_get_policy_data(sched_ctx_id);
+	unsigned i, j;
+
+	ws_add_workers(sched_ctx_id, workerids, nworkers);
+
+	/* get the complete list of workers (not just the added one) and rebuild the distances */
+	nworkers = starpu_sched_ctx_get_workers_list_raw(sched_ctx_id, &workerids);
+	for (i = 0; i < nworkers; i++)
+	{
+		int workerid = workerids[i];
+		if (ws->per_worker[workerid].distance == NULL)
+			_STARPU_CALLOC(ws->per_worker[workerid].distance, STARPU_NMAXWORKERS, sizeof(unsigned));
+		for (j = 0; j < nworkers; j++)
+			ws->per_worker[workerid].distance[workerids[j]] = cws_distance(workerid, workerids[j]);
+	}
+}
+
+static void initialize_cws_policy(unsigned sched_ctx_id)
+{
+	initialize_ws_policy(sched_ctx_id);
+
+	struct _starpu_work_stealing_data *ws = (struct _starpu_work_stealing_data *)starpu_sched_ctx_get_policy_data(sched_ctx_id);
+	ws->select_victim = cws_select_victim;
+	ws->cost_aware = 1;
+}
+
+struct starpu_sched_policy _starpu_sched_cws_policy =
+{
+	.init_sched = initialize_cws_policy,
+	.deinit_sched = deinit_ws_policy,
+	.add_workers = cws_add_workers,
+	.remove_workers = ws_remove_workers,
+	.push_task = ws_push_task,
+	.pop_task = ws_pop_task,
+	.push_task_notify = ws_push_task_notify,
+	.pre_exec_hook = NULL,
+	.post_exec_hook = NULL,
+	.policy_name = "cws",
+	.policy_description = "cost-aware batch work stealing",
+	.worker_type = STARPU_WORKER_LIST,
+};
@@ -449,6 +449,10 @@ int _starpu_task_insert_create(struct starpu_codelet *cl, struct starpu_task *ta
 			double flops = va_arg(varg_list, double);
 			task->flops = flops;
 		}
+		else if (arg_type==STARPU_TASK_DEADLINE)
+		{
+			task->deadline = va_arg(varg_list, double);
+		}
 		else if (arg_type==STARPU_TAG)
 		{
 			starpu_tag_t tag = va_arg(varg_list, starpu_tag_t);
@@ -821,6 +825,11 @@ int _fstarpu_task_insert_create(struct starpu_codelet *cl, struct starpu_task *t
 			arg_i++;
 			task->flops = *(double *)arglist[arg_i];
 		}
+		else if (arg_type == STARPU_TASK_DEADLINE)
+		{
+			arg_i++;
+			task->deadline = *(double *)arglist[arg_i];
+		}
 		else if (arg_type == STARPU_TAG)
 		{
 			arg_i++;
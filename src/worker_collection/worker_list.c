@@ -17,6 +17,170 @@
 #include <starpu.h>
 #include "core/workers.h"
 
+/* The list of workers is read by all workers on every push and pop, but
+ * seldom modified. On NUMA machines, keep a copy of it in each NUMA node, so
+ * that workers iterate over a local copy, and the cache lines of the
+ * reference list do not bounce between sockets. Copies are refreshed lazily
+ * by their readers, when the version of the reference list has changed: a new
+ * copy is filled and published, since other workers may still be iterating
+ * over the previous one. Only workers use the copies, and only while they
+ * schedule, so the previous copy is retired along the quiescent epochs of the
+ * workers of the node, and freed once they have all gone through their
+ * scheduling loop or fallen asleep since then. */
+struct _starpu_worker_list_replica
+{
+	unsigned version;
+	unsigned nworkers;
+	/** NUMA node of the copy */
+	unsigned node;
+	/** Next retired copy */
+	struct _starpu_worker_list_replica *next_retired;
+	/** Quiescent epochs of the workers when the copy was retired */
+	unsigned long *retired_epochs;
+	int workerids[STARPU_NMAXWORKERS+STARPU_NMAX_COMBINEDWORKERS];
+};
+
+struct _starpu_worker_list_replicas
+{
+	/** Incremented on each modification of the reference list */
+	unsigned version;
+	starpu_pthread_mutex_t mutex;
+	struct _starpu_worker_list_replica *replicas[STARPU_MAXNUMANODES];
+	/** Copies which were replaced by newer ones, but may still be in use */
+	struct _starpu_worker_list_replica *retired;
+};
+
+static void list_modified(struct starpu_worker_collection *workers)
+{
+	struct _starpu_worker_list_replicas *replicas = workers->collection_private;
+	/* Make sure the list is updated before readers see the new version */
+	STARPU_WMB();
+	replicas->version++;
+}
+
+static void replica_free(struct _starpu_worker_list_replica *replica)
+{
+	free(replica->retired_epochs);
+	free(replica);
+}
+
+/* Record the epochs of the workers of the node, once the copy is not
+ * reachable any more. */
+static void replica_retire(struct _starpu_worker_list_replicas *replicas, struct _starpu_worker_list_replica *replica)
+{
+	unsigned nworkers = starpu_worker_get_count();
+	unsigned worker;
+
+	/* Pairs with the barriers of _starpu_worker_quiescent*: either we see
+	 * that a worker is still in the epoch where it might have read the
+	 * copy, or it will read the newer one */
+	STARPU_SYNCHRONIZE();
+	_STARPU_MALLOC(replica->retired_epochs, nworkers * sizeof(replica->retired_epochs[0]));
+	for (worker = 0; worker < nworkers; worker++)
+	{
+		struct _starpu_worker *w = _starpu_get_worker_struct(worker);
+		STARPU_HG_DISABLE_CHECKING(w->quiescent_epoch);
+		replica->retired_epochs[worker] = w->quiescent_epoch;
+	}
+	replica->next_retired = replicas->retired;
+	replicas->retired = replica;
+}
+
+/* Whether no worker can be using the retired copy any more */
+static int replica_quiescent(struct _starpu_worker_list_replica *replica)
+{
+	unsigned nworkers = starpu_worker_get_count();
+	unsigned worker;
+
+	for (worker = 0; worker < nworkers; worker++)
+	{
+		struct _starpu_worker *w = _starpu_get_worker_struct(worker);
+		unsigned long epoch = w->quiescent_epoch;
+
+		if (w->numa_memory_node != replica->node)
+			continue;
+		/* Still in the epoch where it was scheduling and might have
+		 * read the copy */
+		if (epoch == replica->retired_epochs[worker] && !(epoch & 1))
+			return 0;
+	}
+	return 1;
+}
+
+/* Free the retired copies which are not used any more */
+static void replica_reclaim(struct _starpu_worker_list_replicas *replicas)
+{
+	struct _starpu_worker_list_replica **prev = &replicas->retired;
+
+	while (*prev)
+	{
+		struct _starpu_worker_list_replica *replica = *prev;
+		if (replica_quiescent(replica))
+		{
+			*prev = replica->next_retired;
+			replica_free(replica);
+		}
+		else
+			prev = &replica->next_retired;
+	}
+}
+
+/* Get the copy of the list for the NUMA node of the calling worker, or NULL if
+ * the reference list should just be used */
+static struct _starpu_worker_list_replica *list_get_replica(struct starpu_worker_collection *workers)
+{
+	struct _starpu_worker_list_replicas *replicas = workers->collection_private;
+	struct _starpu_worker_list_replica *replica, *old;
+	struct _starpu_worker *worker;
+	unsigned node, version;
+
+	if (starpu_memory_nodes_get_numa_count() <= 1)
+		return NULL;
+	worker = _starpu_get_local_worker_key();
+	if (!worker)
+		return NULL;
+	node = worker->numa_memory_node;
+	if (node >= STARPU_MAXNUMANODES)
+		return NULL;
+
+	STARPU_HG_DISABLE_CHECKING(replicas->version);
+	STARPU_HG_DISABLE_CHECKING(replicas->replicas[node]);
+	version = replicas->version;
+	replica = replicas->replicas[node];
+	if (replica)
+		STARPU_HG_DISABLE_CHECKING(*replica);
+	if (STARPU_LIKELY(replica && replica->version == version))
+		return replica;
+
+	STARPU_PTHREAD_MUTEX_LOCK(&replicas->mutex);
+	old = replicas->replicas[node];
+	version = replicas->version;
+	if (old && old->version == version)
+	{
+		/* Another worker of the node refreshed it meanwhile */
+		STARPU_PTHREAD_MUTEX_UNLOCK(&replicas->mutex);
+		return old;
+	}
+	/* Allocated and first touched by a worker of the node */
+	_STARPU_MALLOC(replica, sizeof(*replica));
+	STARPU_RMB();
+	replica->version = version;
+	replica->nworkers = workers->nworkers;
+	replica->node = node;
+	replica->next_retired = NULL;
+	replica->retired_epochs = NULL;
+	memcpy(replica->workerids, workers->workerids, workers->nworkers * sizeof(replica->workerids[0]));
+	/* Publish the content before the replica itself */
+	STARPU_WMB();
+	replicas->replicas[node] = replica;
+	if (old)
+		replica_retire(replicas, old);
+	replica_reclaim(replicas);
+	STARPU_PTHREAD_MUTEX_UNLOCK(&replicas->mutex);
+
+	return replica;
+}
+
 static unsigned list_has_next_unblocked_worker(struct starpu_worker_collection *workers, struct starpu_sched_ctx_iterator *it)
 {
 	int nworkers = workers->nunblocked_workers;
@@ -72,7 +236,8 @@ static unsigned list_has_next(struct starpu_worker_collection *workers, struct s
 	else if(it->possibly_parallel == 0)
 		return list_has_next_unblocked_worker(workers, it);
 
-	int nworkers = workers->nworkers;
+	struct _starpu_worker_list_replica *replica = it->value;
+	int nworkers = replica ? replica->nworkers : workers->nworkers;
 	STARPU_ASSERT(it != NULL);
 
 	unsigned ret = it->cursor < nworkers ;
@@ -89,8 +254,9 @@ static int list_get_next(struct starpu_worker_collection *workers, struct starpu
 	else if(it->possibly_parallel == 0)
 		return list_get_next_unblocked_worker(workers, it);
 
-	int *workerids = (int *)workers->workerids;
-	int nworkers = (int)workers->nworkers;
+	struct _starpu_worker_list_replica *replica = it->value;
+	int *workerids = replica ? replica->workerids : (int *)workers->workerids;
+	int nworkers = replica ? (int)replica->nworkers : (int)workers->nworkers;
 
 	STARPU_ASSERT(it->cursor < nworkers);
 
@@ -123,6 +289,7 @@ static int list_add(struct starpu_worker_collection *workers, int worker)
 	if(!_worker_belongs_to_ctx(workers, worker))
 	{
 		workerids[(*nworkers)++] = worker;
+		list_modified(workers);
 		return worker;
 	}
 	else
@@ -186,7 +353,10 @@ static int list_remove(struct starpu_worker_collection *workers, int worker)
 
 	_rearange_workerids(workerids, nworkers);
 	if(found_worker != -1)
+	{
 		workers->nworkers--;
+		list_modified(workers);
+	}
 
 	int found_unblocked = -1;
 	for(i = 0; i < nunblocked_workers; i++)
@@ -235,6 +405,7 @@ static void list_init(struct starpu_worker_collection *workers)
 	int *workerids;
 	int *unblocked_workers;
 	int *masters;
+	struct _starpu_worker_list_replicas *replicas;
 
 	_STARPU_MALLOC(workerids, (STARPU_NMAXWORKERS+STARPU_NMAX_COMBINEDWORKERS) * sizeof(int));
 	_STARPU_MALLOC(unblocked_workers, (STARPU_NMAXWORKERS+STARPU_NMAX_COMBINEDWORKERS) * sizeof(int));
@@ -250,6 +421,10 @@ static void list_init(struct starpu_worker_collection *workers)
 	workers->masters = (void*)masters;
 	workers->nmasters = 0;
 
+	_STARPU_CALLOC(replicas, 1, sizeof(*replicas));
+	STARPU_PTHREAD_MUTEX_INIT(&replicas->mutex, NULL);
+	workers->collection_private = replicas;
+
 	return;
 }
 
@@ -258,13 +433,28 @@ static void list_deinit(struct starpu_worker_collection *workers)
 	free(workers->workerids);
 	free(workers->unblocked_workers);
 	free(workers->masters);
+
+	struct _starpu_worker_list_replicas *replicas = workers->collection_private;
+	unsigned node;
+	for (node = 0; node < STARPU_MAXNUMANODES; node++)
+		free(replicas->replicas[node]);
+	/* Nobody uses the collection any more */
+	while (replicas->retired)
+	{
+		struct _starpu_worker_list_replica *next = replicas->retired->next_retired;
+		replica_free(replicas->retired);
+		replicas->retired = next;
+	}
+	STARPU_PTHREAD_MUTEX_DESTROY(&replicas->mutex);
+	free(replicas);
+	workers->collection_private = NULL;
 }
 
 static void list_init_iterator(struct starpu_worker_collection *workers, struct starpu_sched_ctx_iterator *it)
 {
-	(void) workers;
 	it->cursor = 0;
 	it->possibly_parallel = -1; /* -1 => we don't care about this field */
+	it->value = list_get_replica(workers);
 
 }
 
@@ -0,0 +1,147 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Register data in main memory, let StarPU find out on which NUMA node it
+ * actually is, and move it from NUMA node to NUMA node while tasks keep
+ * modifying it.
+ */
+
+#if !defined(STARPU_HAVE_SETENV)
+#warning setenv is not defined. Skipping test
+int main(void)
+{
+	return STARPU_TEST_SKIPPED;
+}
+#else
+
+#define N (4*1024*1024)
+/* Number of tasks still in flight when we ask for the migration */
+#define NTASKS 4
+
+static void inc(void *descr[], void *arg)
+{
+	(void)arg;
+	unsigned n = STARPU_VECTOR_GET_NX(descr[0]);
+	char *v = (char *) STARPU_VECTOR_GET_PTR(descr[0]);
+	unsigned i;
+
+	for (i = 0; i < n; i++)
+		v[i]++;
+}
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = { inc },
+	.cpu_funcs_name = { "inc" },
+	.nbuffers = 1,
+	.modes = { STARPU_RW },
+};
+
+int main(int argc, char **argv)
+{
+	starpu_data_handle_t handle;
+	struct starpu_conf conf;
+	char *buffer;
+	unsigned nnodes, node, niter = 0, i;
+	int home_node;
+	int ret;
+
+	setenv("STARPU_USE_NUMA", "1", 1);
+	setenv("STARPU_DATA_NUMA_HOME", "1", 1);
+
+	starpu_conf_init(&conf);
+	starpu_conf_noworker(&conf);
+	conf.ncpus = -1;
+
+	ret = starpu_initialize(&conf, &argc, &argv);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	buffer = malloc(N);
+	/* First touch */
+	memset(buffer, 0, N);
+	starpu_vector_data_register(&handle, STARPU_MAIN_RAM, (uintptr_t) buffer, N, 1);
+
+	home_node = starpu_data_get_home_node(handle);
+	STARPU_ASSERT(starpu_node_get_kind(home_node) == STARPU_CPU_RAM);
+	FPRINTF(stderr, "data was found on memory node %d\n", home_node);
+
+	/* Nothing to do */
+	ret = starpu_data_migrate_home_node(handle, home_node);
+	STARPU_ASSERT(ret == 0);
+
+	/* Not a CPU node */
+	nnodes = starpu_memory_nodes_get_count();
+	for (node = 0; node < nnodes; node++)
+		if (starpu_node_get_kind(node) != STARPU_CPU_RAM)
+		{
+			ret = starpu_data_migrate_home_node(handle, node);
+			STARPU_ASSERT(ret == -EINVAL);
+			break;
+		}
+
+	/* Move the data around */
+	for (node = 0; node < nnodes; node++)
+	{
+		if (starpu_node_get_kind(node) != STARPU_CPU_RAM)
+			continue;
+
+		/* Do not wait for them, the migration has to */
+		for (i = 0; i < NTASKS; i++)
+		{
+			ret = starpu_task_insert(&cl, STARPU_RW, handle, 0);
+			if (ret == -ENODEV)
+				goto enodev;
+			STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+			niter++;
+		}
+
+		ret = starpu_data_migrate_home_node(handle, node);
+		if (ret == -ENOSYS)
+			break;
+		STARPU_ASSERT(ret == 0);
+		STARPU_ASSERT(starpu_data_get_home_node(handle) == (int) node);
+	}
+
+	ret = starpu_task_insert(&cl, STARPU_RW, handle, 0);
+	if (ret == -ENODEV)
+		goto enodev;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+	niter++;
+
+	starpu_data_unregister(handle);
+	for (i = 0; i < N; i++)
+		STARPU_ASSERT(buffer[i] == (char) niter);
+	free(buffer);
+
+	starpu_shutdown();
+	return EXIT_SUCCESS;
+
+enodev:
+	starpu_data_unregister(handle);
+	free(buffer);
+	fprintf(stderr, "WARNING: No one can execute this task\n");
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
+#endif
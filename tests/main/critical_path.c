@@ -0,0 +1,135 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <math.h>
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Check the online bottom level and slack computation on a small diamond:
+ *
+ *        A(10)
+ *       /     \
+ *    B(20)   C(1)
+ *       \     /
+ *        D(5)
+ *
+ * Dependencies are declared in a different order than submission, to check
+ * that the propagation does not depend on it.
+ */
+
+static void dummy_func(void *descr[], void *arg)
+{
+	(void)descr;
+	(void)arg;
+}
+
+static double cost_function(struct starpu_task *t, struct starpu_perfmodel_arch *a, unsigned i)
+{
+	(void) a; (void) i;
+	return *(double *) t->cl_arg;
+}
+
+static struct starpu_perfmodel model =
+{
+	.type = STARPU_PER_ARCH,
+	.arch_cost_function = cost_function,
+};
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = { dummy_func },
+	.cpu_funcs_name = { "dummy_func" },
+	.where = STARPU_CPU,
+	.nbuffers = 0,
+	.model = &model,
+};
+
+static int check(const char *name, double value, double expected)
+{
+	if (fabs(value - expected) > 0.001)
+	{
+		FPRINTF(stderr, "%s is %f instead of %f\n", name, value, expected);
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int ret, i, err = 0;
+	double lengths[] = { 10., 20., 1., 5. };
+	struct starpu_task *start, *tasks[4];
+
+	setenv("STARPU_CRITICAL_PATH", "1", 1);
+
+	ret = starpu_initialize(NULL, &argc, &argv);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	if (starpu_cpu_worker_get_count() == 0)
+	{
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+
+	/* Keep tasks in the graph while we check */
+	start = starpu_task_create();
+	start->detach = 0;
+
+	for (i = 0; i < 4; i++)
+	{
+		tasks[i] = starpu_task_create();
+		tasks[i]->cl = &cl;
+		tasks[i]->cl_arg = &lengths[i];
+		tasks[i]->detach = 0;
+	}
+	starpu_task_declare_deps(tasks[3], 2, tasks[1], tasks[2]);
+	starpu_task_declare_deps(tasks[1], 1, tasks[0]);
+	starpu_task_declare_deps(tasks[2], 1, tasks[0]);
+	starpu_task_declare_deps(tasks[0], 1, start);
+
+	for (i = 3; i >= 0; i--)
+	{
+		ret = starpu_task_submit(tasks[i]);
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	}
+
+	err |= check("critical path", starpu_critical_path_length(), 35.);
+	err |= check("bottom level of A", starpu_task_bottom_level(tasks[0]), 35.);
+	err |= check("bottom level of B", starpu_task_bottom_level(tasks[1]), 25.);
+	err |= check("bottom level of C", starpu_task_bottom_level(tasks[2]), 6.);
+	err |= check("bottom level of D", starpu_task_bottom_level(tasks[3]), 5.);
+	err |= check("slack of A", starpu_task_slack(tasks[0]), 0.);
+	err |= check("slack of B", starpu_task_slack(tasks[1]), 0.);
+	err |= check("slack of C", starpu_task_slack(tasks[2]), 19.);
+	err |= check("slack of D", starpu_task_slack(tasks[3]), 0.);
+
+	ret = starpu_task_submit(start);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	ret = starpu_task_wait(start);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait");
+
+	for (i = 0; i < 4; i++)
+	{
+		ret = starpu_task_wait(tasks[i]);
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait");
+	}
+
+	starpu_shutdown();
+
+	return err ? EXIT_FAILURE : EXIT_SUCCESS;
+}
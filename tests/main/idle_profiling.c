@@ -0,0 +1,112 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Leave the workers idle between tasks, and check that the idle time they
+ * report as spinning, yielding and parked makes sense.
+ */
+
+#if !defined(STARPU_HAVE_SETENV)
+#warning setenv is not defined. Skipping test
+int main(void)
+{
+	return STARPU_TEST_SKIPPED;
+}
+#else
+
+#define NTASKS 10
+#define IDLE 10000 /* us */
+
+static void func(void *descr[], void *arg)
+{
+	(void) descr;
+	(void) arg;
+}
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = { func },
+	.cpu_funcs_name = { "func" },
+	.nbuffers = 0,
+};
+
+int main(void)
+{
+	double total_idle = 0., total_yielding = 0.;
+	unsigned i;
+	int worker, ret;
+
+#ifdef STARPU_SIMGRID
+	/* Workers are not actually idle */
+	return STARPU_TEST_SKIPPED;
+#endif
+
+	setenv("STARPU_PROFILING", "1", 1);
+
+	ret = starpu_init(NULL);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	for (i = 0; i < NTASKS; i++)
+	{
+		usleep(IDLE);
+		ret = starpu_task_insert(&cl, 0);
+		if (ret == -ENODEV) goto enodev;
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+		starpu_task_wait_for_all();
+	}
+
+	for (worker = 0; worker < (int) starpu_worker_get_count(); worker++)
+	{
+		struct starpu_profiling_worker_info info;
+		double total, spinning, yielding, parked;
+
+		ret = starpu_profiling_worker_get_info(worker, &info);
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_profiling_worker_get_info");
+
+		total = starpu_timing_timespec_to_us(&info.total_time);
+		spinning = starpu_timing_timespec_to_us(&info.spinning_time);
+		yielding = starpu_timing_timespec_to_us(&info.yielding_time);
+		parked = starpu_timing_timespec_to_us(&info.parked_time);
+		FPRINTF(stderr, "worker %d: %f us total, %f us spinning, %f us yielding, %f us parked\n", worker, total, spinning, yielding, parked);
+
+		STARPU_ASSERT(spinning >= 0. && yielding >= 0. && parked >= 0.);
+		STARPU_ASSERT_MSG(spinning + yielding + parked <= total, "worker %d was idle for longer than it existed\n", worker);
+		total_idle += spinning + yielding + parked;
+		total_yielding += yielding;
+	}
+
+	/* At least the workers which ran the tasks have ended an idle period */
+	STARPU_ASSERT_MSG(total_idle > 0., "no idle time was reported\n");
+#ifdef STARPU_NON_BLOCKING_DRIVERS
+	/* Workers which can not block stop spinning after a while */
+	STARPU_ASSERT_MSG(total_yielding > 0., "no yielding time was reported\n");
+#endif
+
+	starpu_shutdown();
+	return EXIT_SUCCESS;
+
+enodev:
+	fprintf(stderr, "WARNING: No one can execute this task\n");
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
+#endif
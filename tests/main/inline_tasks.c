@@ -0,0 +1,120 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Submit a chain of small tasks with the STARPU_CODELET_INLINE flag: each of
+ * them is made ready by the worker which completes the previous one, which
+ * should thus run it itself.
+ */
+
+#ifdef STARPU_QUICK_CHECK
+#define NTASKS 64
+#else
+#define NTASKS 1024
+#endif
+
+static int workers[NTASKS];
+
+static void inc_func(void *descr[], void *arg)
+{
+	unsigned *x = (unsigned *) STARPU_VARIABLE_GET_PTR(descr[0]);
+	unsigned i = (uintptr_t) arg;
+	workers[i] = starpu_worker_get_id();
+	STARPU_ASSERT(*x == i);
+	(*x)++;
+}
+
+static double cost_function(struct starpu_task *t, struct starpu_perfmodel_arch *a, unsigned i)
+{
+	(void) t; (void) a; (void) i;
+	return 1.;
+}
+
+static struct starpu_perfmodel model =
+{
+	.type = STARPU_PER_ARCH,
+	.arch_cost_function = cost_function,
+};
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = { inc_func },
+	.cpu_funcs_name = { "inc_func" },
+	.where = STARPU_CPU,
+	.nbuffers = 1,
+	.modes = { STARPU_RW },
+	.model = &model,
+	.flags = STARPU_CODELET_INLINE,
+};
+
+int main(void)
+{
+	unsigned x = 0, i, nsame = 0;
+	starpu_data_handle_t handle;
+	struct starpu_task *start;
+	int ret;
+
+	ret = starpu_init(NULL);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	if (starpu_cpu_worker_get_count() == 0)
+		goto enodev;
+
+	starpu_variable_data_register(&handle, STARPU_MAIN_RAM, (uintptr_t) &x, sizeof(x));
+
+	/* Make sure the tasks get ready only when their predecessor completes:
+	 * hold the first one back until all of them are submitted */
+	start = starpu_task_create();
+	start->detach = 0;
+
+	for (i = 0; i < NTASKS; i++)
+	{
+		struct starpu_task *task = starpu_task_build(&cl, STARPU_RW, handle, STARPU_CL_ARGS_NFREE, (void *) (uintptr_t) i, 0, 0);
+		STARPU_ASSERT(task);
+		/* This is not a pointer */
+		task->cl_arg_free = 0;
+		if (i == 0)
+			starpu_task_declare_deps(task, 1, start);
+		ret = starpu_task_submit(task);
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	}
+	ret = starpu_task_submit(start);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	ret = starpu_task_wait(start);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait");
+
+	starpu_data_unregister(handle);
+	STARPU_ASSERT(x == NTASKS);
+
+	for (i = 1; i < NTASKS; i++)
+		if (workers[i] == workers[i-1])
+			nsame++;
+	FPRINTF(stderr, "%u tasks out of %u were run by the worker which completed their predecessor\n", nsame, NTASKS - 1);
+
+	starpu_shutdown();
+
+	if (!starpu_getenv("STARPU_INLINE_TASK_THRESHOLD") && nsame != NTASKS - 1)
+		return EXIT_FAILURE;
+	return EXIT_SUCCESS;
+
+enodev:
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
@@ -0,0 +1,133 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Check that the number of submitted tasks stays exact when tasks are
+ * submitted and terminated by workers, i.e. through the per-worker shards of
+ * the counter, and that waiting for it gets woken up by workers.
+ *
+ * The callback of each task submits a child task which is held back by a
+ * start task, so the number of submitted tasks can not go below the number
+ * of initial tasks, until the start task is submitted.
+ */
+
+#ifdef STARPU_QUICK_CHECK
+#define NTASKS 64
+#else
+#define NTASKS 1024
+#endif
+
+static struct starpu_task *start;
+static unsigned ncallbacks;
+static unsigned nexecuted;
+
+static void func(void *descr[], void *arg)
+{
+	(void) descr;
+	(void) arg;
+	STARPU_ATOMIC_ADD(&nexecuted, 1);
+}
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = { func },
+	.cpu_funcs_name = { "func" },
+	.where = STARPU_CPU,
+	.nbuffers = 0,
+};
+
+static void callback(void *arg)
+{
+	struct starpu_task *task;
+	int ret;
+	(void) arg;
+
+	task = starpu_task_create();
+	task->cl = &cl;
+	starpu_task_declare_deps(task, 1, start);
+	ret = starpu_task_submit(task);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+
+	STARPU_ATOMIC_ADD(&ncallbacks, 1);
+}
+
+int main(void)
+{
+	unsigned i;
+	int n, ret;
+
+	ret = starpu_init(NULL);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	if (starpu_cpu_worker_get_count() == 0)
+	{
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+
+	start = starpu_task_create();
+	start->detach = 0;
+
+	for (i = 0; i < NTASKS; i++)
+	{
+		struct starpu_task *task = starpu_task_create();
+		task->cl = &cl;
+		task->callback_func = callback;
+		ret = starpu_task_submit(task);
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	}
+
+	/* Each task is replaced by its child before being counted out, so
+	 * there may only be one more per worker */
+	do
+	{
+		n = starpu_task_nsubmitted();
+		STARPU_ASSERT_MSG(n >= NTASKS && n <= NTASKS + (int) starpu_worker_get_count(), "%d tasks submitted instead of %d\n", n, NTASKS);
+		STARPU_SYNCHRONIZE();
+	}
+	while (ncallbacks < NTASKS);
+
+	/* The children can not terminate, so this has to stop exactly there */
+	ret = starpu_task_wait_for_n_submitted(NTASKS);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait_for_n_submitted");
+	n = starpu_task_nsubmitted();
+	STARPU_ASSERT_MSG(n == NTASKS, "%d tasks submitted instead of %d\n", n, NTASKS);
+
+	/* Now let the children go, only workers will decrement the counter */
+	ret = starpu_task_submit(start);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+
+	ret = starpu_task_wait_for_n_submitted(NTASKS / 2);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait_for_n_submitted");
+	n = starpu_task_nsubmitted();
+	STARPU_ASSERT_MSG(n <= NTASKS / 2, "%d tasks submitted, more than %d\n", n, NTASKS / 2);
+
+	ret = starpu_task_wait_for_n_submitted(0);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait_for_n_submitted");
+	n = starpu_task_nsubmitted();
+	STARPU_ASSERT_MSG(n == 0, "%d tasks still submitted\n", n);
+	STARPU_ASSERT(nexecuted == 2 * NTASKS);
+
+	ret = starpu_task_wait(start);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait");
+
+	starpu_shutdown();
+	return EXIT_SUCCESS;
+}
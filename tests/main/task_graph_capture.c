@@ -0,0 +1,192 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Capture a small task graph with implicit data dependencies, and launch it
+ * several times, updating a task parameter between launches:
+ *
+ *	A: x += inc
+ *	B: y = x
+ *	C: x += inc
+ *
+ * B depends on A (read after write), and C depends on B (write after read).
+ *
+ * Also check that only the launches are counted as submissions by the
+ * performance counters.
+ */
+
+#ifdef STARPU_QUICK_CHECK
+static unsigned niter = 16;
+#else
+static unsigned niter = 1024;
+#endif
+
+static unsigned inc;
+
+static int id_c_total_submitted;
+static int64_t total_submitted;
+
+static void listener_cb(struct starpu_perf_counter_listener *listener, struct starpu_perf_counter_sample *sample, void *context)
+{
+	(void) listener;
+	(void) context;
+	int64_t value = starpu_perf_counter_sample_get_int64_value(sample, id_c_total_submitted);
+	STARPU_HG_DISABLE_CHECKING(total_submitted);
+	if (value > total_submitted)
+		total_submitted = value;
+}
+
+void add_func(void *descr[], void *arg)
+{
+	unsigned *x = (unsigned *) STARPU_VARIABLE_GET_PTR(descr[0]);
+	*x += *(unsigned *) arg;
+}
+
+static struct starpu_codelet add_cl =
+{
+	.cpu_funcs = { add_func },
+	.cpu_funcs_name = { "add_func" },
+	.nbuffers = 1,
+	.modes = { STARPU_RW },
+};
+
+void copy_func(void *descr[], void *arg)
+{
+	(void) arg;
+	unsigned *x = (unsigned *) STARPU_VARIABLE_GET_PTR(descr[0]);
+	unsigned *y = (unsigned *) STARPU_VARIABLE_GET_PTR(descr[1]);
+	*y = *x;
+}
+
+static struct starpu_codelet copy_cl =
+{
+	.cpu_funcs = { copy_func },
+	.cpu_funcs_name = { "copy_func" },
+	.nbuffers = 2,
+	.modes = { STARPU_R, STARPU_W },
+};
+
+int main(int argc, char **argv)
+{
+	unsigned x = 0, y = 0, expected = 0, i;
+	starpu_data_handle_t x_handle, y_handle;
+	struct starpu_task *taskA, *taskC;
+	starpu_task_graph_t graph;
+	struct starpu_perf_counter_set *set;
+	struct starpu_perf_counter_listener *listener;
+	struct starpu_conf conf;
+	int ret;
+
+	starpu_conf_init(&conf);
+	conf.start_perf_counter_collection = 1;
+
+	ret = starpu_initialize(&conf, &argc, &argv);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	/* Watch the submissions of add_cl */
+	set = starpu_perf_counter_set_alloc(starpu_perf_counter_scope_per_codelet);
+	id_c_total_submitted = starpu_perf_counter_name_to_id(starpu_perf_counter_scope_per_codelet, "starpu.task.c_total_submitted");
+	STARPU_ASSERT(id_c_total_submitted != -1);
+	starpu_perf_counter_set_enable_id(set, id_c_total_submitted);
+	listener = starpu_perf_counter_listener_init(set, listener_cb, NULL);
+	starpu_perf_counter_set_per_codelet_listener(&add_cl, listener);
+
+	starpu_variable_data_register(&x_handle, STARPU_MAIN_RAM, (uintptr_t) &x, sizeof(x));
+	starpu_variable_data_register(&y_handle, STARPU_MAIN_RAM, (uintptr_t) &y, sizeof(y));
+
+	starpu_task_graph_capture_begin();
+
+	taskA = starpu_task_create();
+	taskA->cl = &add_cl;
+	taskA->cl_arg = &inc;
+	taskA->handles[0] = x_handle;
+	ret = starpu_task_submit(taskA);
+	if (ret == -ENODEV)
+	{
+		starpu_task_graph_destroy(starpu_task_graph_capture_end());
+		goto enodev;
+	}
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+
+	ret = starpu_task_insert(&copy_cl, STARPU_R, x_handle, STARPU_W, y_handle, 0);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+
+	taskC = starpu_task_create();
+	taskC->cl = &add_cl;
+	taskC->cl_arg = &inc;
+	taskC->handles[0] = x_handle;
+	ret = starpu_task_submit(taskC);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+
+	graph = starpu_task_graph_capture_end();
+	STARPU_ASSERT(starpu_task_graph_get_ntasks(graph) == 3);
+	STARPU_ASSERT(starpu_task_graph_get_task(graph, 2) == taskC);
+
+	/* Nothing should have been executed yet */
+	starpu_data_acquire(x_handle, STARPU_R);
+	STARPU_ASSERT(x == 0);
+	starpu_data_release(x_handle);
+
+	/* Nor even counted as submitted */
+	STARPU_ASSERT_MSG(total_submitted == 0, "recorded tasks were counted as submitted\n");
+
+	for (i = 0; i < niter; i++)
+	{
+		/* Parameters can only be changed once the previous launch is over */
+		starpu_task_graph_wait(graph);
+		inc = i + 1;
+		expected += 2 * inc;
+
+		ret = starpu_task_graph_launch(graph);
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_graph_launch");
+	}
+
+	starpu_task_graph_wait(graph);
+	STARPU_ASSERT_MSG(total_submitted == 2 * niter, "%ld tasks were counted as submitted instead of %u\n", (long) total_submitted, 2 * niter);
+
+	starpu_task_graph_destroy(graph);
+
+	starpu_data_unregister(x_handle);
+	starpu_data_unregister(y_handle);
+
+	starpu_perf_counter_unset_per_codelet_listener(&add_cl);
+	starpu_perf_counter_listener_exit(listener);
+	starpu_perf_counter_set_free(set);
+
+	starpu_shutdown();
+
+	if (x != expected || y != expected - niter)
+	{
+		FPRINTF(stderr, "x is %u instead of %u, y is %u instead of %u\n", x, expected, y, expected - niter);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+
+enodev:
+	starpu_data_unregister(x_handle);
+	starpu_data_unregister(y_handle);
+	starpu_perf_counter_unset_per_codelet_listener(&add_cl);
+	starpu_perf_counter_listener_exit(listener);
+	starpu_perf_counter_set_free(set);
+	fprintf(stderr, "WARNING: No one can execute this task\n");
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
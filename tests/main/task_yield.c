@@ -0,0 +1,166 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * With a single CPU worker, tasks submit a child task and wait for it, or
+ * for a piece of data written by it, by yielding their worker. Without
+ * yielding, this would deadlock.
+ */
+
+#ifdef STARPU_QUICK_CHECK
+#define NTASKS 8
+#else
+#define NTASKS 64
+#endif
+
+static unsigned child_done[NTASKS];
+static unsigned data_written[NTASKS];
+static unsigned values[NTASKS];
+static starpu_data_handle_t handles[NTASKS];
+
+void child_func(void *descr[], void *arg)
+{
+	(void) descr;
+	unsigned i = (uintptr_t) arg;
+	child_done[i] = 1;
+}
+
+static struct starpu_codelet child_cl =
+{
+	.cpu_funcs = {child_func},
+	.cpu_funcs_name = {"child_func"},
+	.nbuffers = 0,
+};
+
+void write_func(void *descr[], void *arg)
+{
+	unsigned i = (uintptr_t) arg;
+	*(unsigned *) STARPU_VARIABLE_GET_PTR(descr[0]) = i + 1;
+	data_written[i] = 1;
+}
+
+static struct starpu_codelet write_cl =
+{
+	.cpu_funcs = {write_func},
+	.cpu_funcs_name = {"write_func"},
+	.nbuffers = 1,
+	.modes = {STARPU_W},
+};
+
+void parent_func(void *descr[], void *arg)
+{
+	(void) descr;
+	unsigned i = (uintptr_t) arg;
+	struct starpu_task *child, *writer;
+	int ret;
+
+	ret = starpu_task_yield();
+	STARPU_ASSERT(ret == 0);
+
+	/* Wait for a child task */
+	child = starpu_task_create();
+	child->cl = &child_cl;
+	child->cl_arg = (void *) (uintptr_t) i;
+	child->destroy = 0;
+	ret = starpu_task_submit(child);
+	STARPU_ASSERT(ret == 0);
+	ret = starpu_task_yield_until(1, &child);
+	STARPU_ASSERT(ret == 0);
+	STARPU_ASSERT(child_done[i]);
+	starpu_task_destroy(child);
+
+	/* Wait for a piece of data */
+	writer = starpu_task_create();
+	writer->cl = &write_cl;
+	writer->cl_arg = (void *) (uintptr_t) i;
+	writer->handles[0] = handles[i];
+	ret = starpu_task_submit(writer);
+	STARPU_ASSERT(ret == 0);
+	ret = starpu_task_yield_until_data(handles[i], STARPU_R);
+	STARPU_ASSERT(ret == 0);
+	STARPU_ASSERT(data_written[i]);
+}
+
+static struct starpu_codelet parent_cl =
+{
+	.cpu_funcs = {parent_func},
+	.cpu_funcs_name = {"parent_func"},
+	.nbuffers = 0,
+	.flags = STARPU_CODELET_YIELDABLE,
+};
+
+int main(void)
+{
+	struct starpu_conf conf;
+	unsigned i;
+	int ret;
+
+	starpu_conf_init(&conf);
+	starpu_conf_noworker(&conf);
+	conf.ncpus = 1;
+	ret = starpu_initialize(&conf, NULL, NULL);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	/* Not from a task */
+	ret = starpu_task_yield();
+	if (ret == -ENOSYS)
+	{
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+	STARPU_ASSERT(ret == -EINVAL);
+
+	for (i = 0; i < NTASKS; i++)
+		starpu_variable_data_register(&handles[i], -1, 0, sizeof(values[i]));
+
+	for (i = 0; i < NTASKS; i++)
+	{
+		struct starpu_task *task = starpu_task_create();
+		task->cl = &parent_cl;
+		task->cl_arg = (void *) (uintptr_t) i;
+		ret = starpu_task_submit(task);
+		if (ret == -ENODEV)
+		{
+			task->destroy = 0;
+			starpu_task_destroy(task);
+			goto enodev;
+		}
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	}
+
+	starpu_task_wait_for_all();
+
+	for (i = 0; i < NTASKS; i++)
+	{
+		starpu_data_acquire(handles[i], STARPU_R);
+		STARPU_ASSERT(*(unsigned *) starpu_data_get_local_ptr(handles[i]) == i + 1);
+		starpu_data_release(handles[i]);
+		starpu_data_unregister(handles[i]);
+	}
+
+	starpu_shutdown();
+	return EXIT_SUCCESS;
+
+enodev:
+	for (i = 0; i < NTASKS; i++)
+		starpu_data_unregister(handles[i]);
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
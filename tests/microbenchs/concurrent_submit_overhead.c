@@ -0,0 +1,175 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Measure the cost of submitting tasks from many application threads at the
+ * same time, which stresses the locks of the scheduler push path. Run e.g.
+ * with -p modular-eager, with and without STARPU_SCHED_SHARDED_ABOVE.
+ */
+
+#ifdef STARPU_QUICK_CHECK
+static unsigned nthreads = 16;
+static unsigned ntasks = 1024;
+#else
+static unsigned nthreads = 64;
+static unsigned ntasks = 65536;
+#endif
+
+void dummy_func(void *descr[], void *arg)
+{
+	(void)descr;
+	(void)arg;
+}
+
+static struct starpu_codelet dummy_codelet =
+{
+	.cpu_funcs = {dummy_func},
+	.cuda_funcs = {dummy_func},
+	.opencl_funcs = {dummy_func},
+	.cpu_funcs_name = {"dummy_func"},
+	.model = NULL,
+	.nbuffers = 0,
+};
+
+static int enodev;
+
+static void *submitter(void *arg)
+{
+	unsigned n = (uintptr_t) arg;
+	unsigned i;
+
+	for (i = 0; i < n; i++)
+	{
+		struct starpu_task *task = starpu_task_create();
+		task->cl = &dummy_codelet;
+		int ret = starpu_task_submit(task);
+		if (ret == -ENODEV)
+		{
+			task->destroy = 0;
+			starpu_task_destroy(task);
+			enodev = 1;
+			break;
+		}
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	}
+	return NULL;
+}
+
+static void usage(char **argv)
+{
+	fprintf(stderr, "Usage: %s [-t nthreads] [-i ntasks] [-p sched_policy] [-h]\n", argv[0]);
+	exit(EXIT_FAILURE);
+}
+
+static void parse_args(int argc, char **argv, struct starpu_conf *conf)
+{
+	int c;
+	while ((c = getopt(argc, argv, "t:i:p:h")) != -1)
+	switch(c)
+	{
+		case 't':
+			nthreads = atoi(optarg);
+			break;
+		case 'i':
+			ntasks = atoi(optarg);
+			break;
+		case 'p':
+			conf->sched_policy_name = optarg;
+			break;
+		case 'h':
+			usage(argv);
+			break;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+	unsigned t;
+	double timing;
+	double start;
+	double end;
+	starpu_pthread_t *threads;
+
+	struct starpu_conf conf;
+	starpu_conf_init(&conf);
+	conf.ncpus = 2;
+
+	parse_args(argc, argv, &conf);
+	if (!nthreads)
+		nthreads = 1;
+
+	ret = starpu_initialize(&conf, &argc, &argv);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	fprintf(stderr, "#threads : %u\n#tasks : %u\n", nthreads, ntasks);
+
+	threads = malloc(nthreads * sizeof(*threads));
+
+	start = starpu_timing_now();
+	for (t = 0; t < nthreads; t++)
+	{
+		/* Spread the remainder over the first threads */
+		unsigned n = ntasks / nthreads + (t < ntasks % nthreads);
+		STARPU_PTHREAD_CREATE(&threads[t], NULL, submitter, (void *)(uintptr_t) n);
+	}
+	for (t = 0; t < nthreads; t++)
+		STARPU_PTHREAD_JOIN(threads[t], NULL);
+
+	ret = starpu_task_wait_for_all();
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait_for_all");
+	end = starpu_timing_now();
+
+	free(threads);
+
+	if (enodev)
+	{
+		fprintf(stderr, "WARNING: No one can execute this task\n");
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+
+	timing = end - start;
+
+	fprintf(stderr, "Total: %f secs\n", timing/1000000);
+	fprintf(stderr, "Per task: %f usecs\n", timing/ntasks);
+
+	{
+		char *output_dir = getenv("STARPU_BENCH_DIR");
+		char *bench_id = getenv("STARPU_BENCH_ID");
+
+		if (output_dir && bench_id)
+		{
+			char file[1024];
+			FILE *f;
+
+			snprintf(file, sizeof(file), "%s/concurrent_submit_overhead_per_task_%u.dat", output_dir, nthreads);
+			f = fopen(file, "a");
+			fprintf(f, "%s\t%f\n", bench_id, timing/ntasks);
+			fclose(f);
+		}
+	}
+
+	starpu_shutdown();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,221 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Measure the time of random accesses to a big piece of data, allocated with
+ * and without STARPU_MALLOC_HUGEPAGES, and allocated by StarPU itself, which
+ * uses huge pages when STARPU_HUGEPAGES=1. Most accesses get a TLB miss with
+ * normal pages. Run e.g. with and without STARPU_HUGEPAGE_SIZE=2M or 1G, and
+ * within perf stat -e dTLB-load-misses to get the actual number of TLB misses.
+ */
+
+#ifdef STARPU_QUICK_CHECK
+static unsigned size = 64; /* MiB */
+static unsigned long naccesses = 1UL << 20;
+static unsigned niter = 2;
+#else
+static unsigned size = 512; /* MiB */
+static unsigned long naccesses = 1UL << 24;
+static unsigned niter = 8;
+#endif
+
+void access_func(void *descr[], void *arg)
+{
+	(void)arg;
+	unsigned long n = STARPU_VECTOR_GET_NX(descr[0]);
+	unsigned long *v = (unsigned long *) STARPU_VECTOR_GET_PTR(descr[0]);
+	unsigned long i, idx = 0;
+
+	for (i = 0; i < naccesses; i++)
+	{
+		idx = idx * 6364136223846793005UL + 1442695040888963407UL;
+		v[(idx >> 16) % n]++;
+	}
+}
+
+static struct starpu_codelet access_codelet =
+{
+	.cpu_funcs = {access_func},
+	.cpu_funcs_name = {"access_func"},
+	.nbuffers = 1,
+	.modes = {STARPU_RW},
+};
+
+void init_func(void *descr[], void *arg)
+{
+	(void)arg;
+	memset((void *) STARPU_VECTOR_GET_PTR(descr[0]), 0, STARPU_VECTOR_GET_NX(descr[0]) * STARPU_VECTOR_GET_ELEMSIZE(descr[0]));
+}
+
+static struct starpu_codelet init_codelet =
+{
+	.cpu_funcs = {init_func},
+	.cpu_funcs_name = {"init_func"},
+	.nbuffers = 1,
+	.modes = {STARPU_W},
+};
+
+static void usage(char **argv)
+{
+	fprintf(stderr, "Usage: %s [-s size_MiB] [-a naccesses] [-i niter] [-h]\n", argv[0]);
+	exit(EXIT_FAILURE);
+}
+
+static void parse_args(int argc, char **argv)
+{
+	int c;
+	while ((c = getopt(argc, argv, "s:a:i:h")) != -1)
+	switch(c)
+	{
+		case 's':
+			size = atoi(optarg);
+			break;
+		case 'a':
+			naccesses = atol(optarg);
+			break;
+		case 'i':
+			niter = atoi(optarg);
+			break;
+		case 'h':
+			usage(argv);
+			break;
+	}
+}
+
+/* Return the time per access, in ns */
+static double run(starpu_data_handle_t handle)
+{
+	double start;
+	unsigned i;
+	int ret;
+
+	ret = starpu_task_insert(&init_codelet, STARPU_W, handle, 0);
+	if (ret == -ENODEV)
+		return -1.;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+	starpu_task_wait_for_all();
+
+	start = starpu_timing_now();
+	for (i = 0; i < niter; i++)
+	{
+		ret = starpu_task_insert(&access_codelet, STARPU_RW, handle, 0);
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+	}
+	starpu_task_wait_for_all();
+
+	return (starpu_timing_now() - start) * 1000. / niter / naccesses;
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+	size_t bytes;
+	unsigned long n;
+	unsigned j;
+	double timing;
+	starpu_data_handle_t handle;
+	void *early;
+	static const struct
+	{
+		const char *name;
+		int flags;
+	} allocs[] =
+	{
+		{ "starpu_malloc", STARPU_MALLOC_PINNED },
+		{ "starpu_malloc with huge pages", STARPU_MALLOC_PINNED | STARPU_MALLOC_HUGEPAGES },
+	};
+
+	struct starpu_conf conf;
+	starpu_conf_init(&conf);
+	starpu_conf_noworker(&conf);
+	conf.ncpus = 1;
+
+	parse_args(argc, argv);
+	if (!size)
+		size = 1;
+	if (!niter)
+		niter = 1;
+
+#ifdef STARPU_SIMGRID
+	/* Accesses would not mean anything */
+	return STARPU_TEST_SKIPPED;
+#endif
+
+	bytes = (size_t) size << 20;
+	n = bytes / sizeof(unsigned long);
+
+	/* Allocations made before initialization may be freed after it */
+	ret = starpu_malloc_flags(&early, bytes, STARPU_MALLOC_HUGEPAGES);
+	if (ret == -ENOMEM)
+		return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_malloc_flags");
+	memset(early, 0, bytes);
+
+	ret = starpu_initialize(&conf, &argc, &argv);
+	if (ret == -ENODEV)
+	{
+		starpu_free_flags(early, bytes, STARPU_MALLOC_HUGEPAGES);
+		return STARPU_TEST_SKIPPED;
+	}
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	starpu_free_flags(early, bytes, STARPU_MALLOC_HUGEPAGES);
+
+	for (j = 0; j < sizeof(allocs) / sizeof(allocs[0]); j++)
+	{
+		void *buffer;
+
+		ret = starpu_malloc_flags(&buffer, bytes, allocs[j].flags);
+		if (ret == -ENOMEM)
+		{
+			fprintf(stderr, "could not allocate %uMiB\n", size);
+			starpu_shutdown();
+			return STARPU_TEST_SKIPPED;
+		}
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_malloc_flags");
+
+		starpu_vector_data_register(&handle, STARPU_MAIN_RAM, (uintptr_t) buffer, n, sizeof(unsigned long));
+		timing = run(handle);
+		starpu_data_unregister(handle);
+		starpu_free_flags(buffer, bytes, allocs[j].flags);
+
+		if (timing < 0.)
+			goto enodev;
+		fprintf(stderr, "%s: %f ns per access\n", allocs[j].name, timing);
+	}
+
+	/* Let StarPU allocate the data */
+	starpu_vector_data_register(&handle, -1, 0, n, sizeof(unsigned long));
+	timing = run(handle);
+	starpu_data_unregister(handle);
+	if (timing < 0.)
+		goto enodev;
+	fprintf(stderr, "allocated by StarPU (STARPU_HUGEPAGES=%s): %f ns per access\n", starpu_getenv("STARPU_HUGEPAGES") ? starpu_getenv("STARPU_HUGEPAGES") : "0", timing);
+
+	starpu_shutdown();
+	return EXIT_SUCCESS;
+
+enodev:
+	fprintf(stderr, "WARNING: No one can execute this task\n");
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
@@ -0,0 +1,252 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Like main/empty_task_chain, but with small tasks which actually run and
+ * touch a piece of data written by their predecessor: measure the time to
+ * run a set of chains, and a binary tree, and how many tasks run on the
+ * worker of their predecessor. Run e.g. with and without
+ * STARPU_SUCCESSOR_CONTINUATION=1.
+ */
+
+#ifdef STARPU_QUICK_CHECK
+static unsigned nchains = 4;
+static unsigned length = 64;
+static unsigned depth = 6;
+#else
+static unsigned nchains = 16;
+static unsigned length = 1024;
+static unsigned depth = 12;
+#endif
+/* Size of the data of each task */
+static unsigned size = 16*1024;
+
+static int *workers;
+
+void touch_func(void *descr[], void *arg)
+{
+	unsigned i = (uintptr_t) arg;
+	unsigned n = STARPU_VECTOR_GET_NX(descr[0]);
+	char *v = (char *) STARPU_VECTOR_GET_PTR(descr[0]);
+	unsigned j;
+
+	for (j = 0; j < n; j++)
+		v[j]++;
+	workers[i] = starpu_worker_get_id();
+}
+
+static struct starpu_codelet touch_codelet =
+{
+	.cpu_funcs = {touch_func},
+	.cpu_funcs_name = {"touch_func"},
+	.nbuffers = 1,
+	.modes = {STARPU_RW},
+};
+
+void read_func(void *descr[], void *arg)
+{
+	unsigned i = (uintptr_t) arg;
+	unsigned n = STARPU_VECTOR_GET_NX(descr[0]);
+	char *v = (char *) STARPU_VECTOR_GET_PTR(descr[0]);
+	char *parent = (char *) STARPU_VECTOR_GET_PTR(descr[1]);
+	unsigned j;
+
+	for (j = 0; j < n; j++)
+		v[j] = parent[j] + 1;
+	workers[i] = starpu_worker_get_id();
+}
+
+static struct starpu_codelet read_codelet =
+{
+	.cpu_funcs = {read_func},
+	.cpu_funcs_name = {"read_func"},
+	.nbuffers = 2,
+	.modes = {STARPU_W, STARPU_R},
+};
+
+static void usage(char **argv)
+{
+	fprintf(stderr, "Usage: %s [-c nchains] [-l length] [-d depth] [-s size] [-p sched_policy] [-h]\n", argv[0]);
+	exit(EXIT_FAILURE);
+}
+
+static void parse_args(int argc, char **argv, struct starpu_conf *conf)
+{
+	int c;
+	while ((c = getopt(argc, argv, "c:l:d:s:p:h")) != -1)
+	switch(c)
+	{
+		case 'c':
+			nchains = atoi(optarg);
+			break;
+		case 'l':
+			length = atoi(optarg);
+			break;
+		case 'd':
+			depth = atoi(optarg);
+			break;
+		case 's':
+			size = atoi(optarg);
+			break;
+		case 'p':
+			conf->sched_policy_name = optarg;
+			break;
+		case 'h':
+			usage(argv);
+			break;
+	}
+}
+
+static struct starpu_task *create_task(starpu_data_handle_t handle, starpu_data_handle_t pred_handle, unsigned i, struct starpu_task *pred)
+{
+	struct starpu_task *task = starpu_task_create();
+	task->handles[0] = handle;
+	if (pred_handle)
+	{
+		task->cl = &read_codelet;
+		task->handles[1] = pred_handle;
+	}
+	else
+		task->cl = &touch_codelet;
+	task->cl_arg = (void *) (uintptr_t) i;
+	/* Data dependencies are already there, but make the successor
+	 * relation explicit, like in main/empty_task_chain */
+	if (pred)
+		starpu_task_declare_deps(task, 1, pred);
+	return task;
+}
+
+/* Submit all tasks, paused, so that they get ready only when their predecessor
+ * completes. Return the time to run them all, in us */
+static double run(struct starpu_task **tasks, unsigned ntasks, unsigned *npred, int *pred)
+{
+	double start;
+	unsigned i;
+	int ret;
+
+	starpu_pause();
+	for (i = 0; i < ntasks; i++)
+	{
+		ret = starpu_task_submit(tasks[i]);
+		if (ret == -ENODEV)
+		{
+			fprintf(stderr, "WARNING: No one can execute this task\n");
+			starpu_resume();
+			starpu_task_wait_for_all();
+			starpu_shutdown();
+			exit(STARPU_TEST_SKIPPED);
+		}
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	}
+	start = starpu_timing_now();
+	starpu_resume();
+	starpu_task_wait_for_all();
+
+	*npred = 0;
+	for (i = 0; i < ntasks; i++)
+		if (pred[i] != -1 && workers[i] == workers[pred[i]])
+			(*npred)++;
+
+	return starpu_timing_now() - start;
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+	unsigned i, c, ntasks, ndata, npred;
+	double timing;
+	starpu_data_handle_t *handles;
+	struct starpu_task **tasks;
+	int *pred;
+	char *buffers;
+
+	struct starpu_conf conf;
+	starpu_conf_init(&conf);
+	conf.ncuda = 0;
+	conf.nopencl = 0;
+
+	parse_args(argc, argv, &conf);
+	if (!nchains)
+		nchains = 1;
+	if (!length)
+		length = 1;
+
+	ret = starpu_initialize(&conf, &argc, &argv);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	ntasks = nchains * length;
+	if (ntasks < (1U << depth))
+		ntasks = 1U << depth;
+	workers = malloc(ntasks * sizeof(*workers));
+	tasks = malloc(ntasks * sizeof(*tasks));
+	pred = malloc(ntasks * sizeof(*pred));
+	/* One piece of data per chain, or per node of the tree */
+	ndata = nchains;
+	if (depth && ndata < (1U << depth) - 1)
+		ndata = (1U << depth) - 1;
+	handles = malloc(ndata * sizeof(*handles));
+	buffers = calloc(ndata, size);
+
+	/* Chains: one piece of data per chain */
+	for (c = 0; c < nchains; c++)
+		starpu_vector_data_register(&handles[c], STARPU_MAIN_RAM, (uintptr_t) &buffers[c * size], size, 1);
+	for (c = 0; c < nchains; c++)
+		for (i = 0; i < length; i++)
+		{
+			unsigned n = c * length + i;
+			pred[n] = i ? (int) n - 1 : -1;
+			tasks[n] = create_task(handles[c], NULL, n, i ? tasks[n-1] : NULL);
+		}
+	timing = run(tasks, nchains * length, &npred, pred);
+	fprintf(stderr, "%u chains of %u tasks: %f us per task, %u tasks out of %u ran on the worker of their predecessor\n",
+		nchains, length, timing / (nchains * length), npred, nchains * (length - 1));
+	for (c = 0; c < nchains; c++)
+		starpu_data_unregister(handles[c]);
+
+	/* Binary tree: task n makes tasks 2n+1 and 2n+2 ready, which read
+	 * its data */
+	if (depth)
+	{
+		unsigned ntree = (1U << depth) - 1;
+		for (i = 0; i < ntree; i++)
+			starpu_vector_data_register(&handles[i], STARPU_MAIN_RAM, (uintptr_t) &buffers[i * size], size, 1);
+		for (i = 0; i < ntree; i++)
+		{
+			pred[i] = i ? (int) (i - 1) / 2 : -1;
+			tasks[i] = create_task(handles[i], i ? handles[pred[i]] : NULL, i, i ? tasks[pred[i]] : NULL);
+		}
+		timing = run(tasks, ntree, &npred, pred);
+		fprintf(stderr, "tree of depth %u: %f us per task, %u tasks out of %u ran on the worker of their predecessor\n",
+			depth, timing / ntree, npred, ntree - 1);
+		for (i = 0; i < ntree; i++)
+			starpu_data_unregister(handles[i]);
+	}
+
+	free(buffers);
+	free(handles);
+	free(pred);
+	free(tasks);
+	free(workers);
+	starpu_shutdown();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Measure the time between submitting a single task and the start of its
+ * execution, when all workers are idle and thus sleeping. Run e.g. with and
+ * without STARPU_WORKER_PARKING=0.
+ */
+
+#ifdef STARPU_QUICK_CHECK
+static unsigned niter = 64;
+#else
+static unsigned niter = 1024;
+#endif
+/* Time to let the workers go to sleep between tasks */
+static unsigned idle = 1000; /* us */
+
+static double start_date;
+
+void start_func(void *descr[], void *arg)
+{
+	(void)descr;
+	(void)arg;
+	start_date = starpu_timing_now();
+}
+
+static struct starpu_codelet start_codelet =
+{
+	.cpu_funcs = {start_func},
+	.cpu_funcs_name = {"start_func"},
+	.model = NULL,
+	.nbuffers = 0,
+};
+
+static int compare_doubles(const void *a, const void *b)
+{
+	double da = *(const double *) a, db = *(const double *) b;
+	return (da > db) - (da < db);
+}
+
+static void usage(char **argv)
+{
+	fprintf(stderr, "Usage: %s [-i niter] [-s idle_us] [-p sched_policy] [-h]\n", argv[0]);
+	exit(EXIT_FAILURE);
+}
+
+static void parse_args(int argc, char **argv, struct starpu_conf *conf)
+{
+	int c;
+	while ((c = getopt(argc, argv, "i:s:p:h")) != -1)
+	switch(c)
+	{
+		case 'i':
+			niter = atoi(optarg);
+			break;
+		case 's':
+			idle = atoi(optarg);
+			break;
+		case 'p':
+			conf->sched_policy_name = optarg;
+			break;
+		case 'h':
+			usage(argv);
+			break;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+	unsigned i;
+	double *latencies;
+	double total = 0.;
+
+	struct starpu_conf conf;
+	starpu_conf_init(&conf);
+	conf.ncuda = 0;
+	conf.nopencl = 0;
+
+	parse_args(argc, argv, &conf);
+	if (!niter)
+		niter = 1;
+
+#ifdef STARPU_SIMGRID
+	/* Latencies would not mean anything */
+	return STARPU_TEST_SKIPPED;
+#endif
+
+	ret = starpu_initialize(&conf, &argc, &argv);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	latencies = malloc(niter * sizeof(*latencies));
+
+	for (i = 0; i < niter; i++)
+	{
+		double submit_date;
+		struct starpu_task *task;
+
+		starpu_usleep(idle);
+
+		task = starpu_task_create();
+		task->cl = &start_codelet;
+		task->synchronous = 1;
+		submit_date = starpu_timing_now();
+		ret = starpu_task_submit(task);
+		if (ret == -ENODEV)
+		{
+			fprintf(stderr, "WARNING: No one can execute this task\n");
+			free(latencies);
+			starpu_shutdown();
+			return STARPU_TEST_SKIPPED;
+		}
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+
+		latencies[i] = start_date - submit_date;
+		total += latencies[i];
+	}
+
+	qsort(latencies, niter, sizeof(*latencies), compare_doubles);
+
+	fprintf(stderr, "#iterations : %u\n#idle time : %u usecs\n", niter, idle);
+	fprintf(stderr, "Push to start latency: min %f avg %f median %f max %f usecs\n",
+		latencies[0], total / niter, latencies[niter / 2], latencies[niter - 1]);
+
+	{
+		char *output_dir = getenv("STARPU_BENCH_DIR");
+		char *bench_id = getenv("STARPU_BENCH_ID");
+
+		if (output_dir && bench_id)
+		{
+			char file[1024];
+			FILE *f;
+
+			snprintf(file, sizeof(file), "%s/wakeup_latency.dat", output_dir);
+			f = fopen(file, "a");
+			fprintf(f, "%s\t%f\n", bench_id, latencies[niter / 2]);
+			fclose(f);
+		}
+	}
+
+	free(latencies);
+	starpu_shutdown();
+
+	return EXIT_SUCCESS;
+}
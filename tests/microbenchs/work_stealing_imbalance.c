@@ -0,0 +1,177 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Measure how well the work stealing schedulers balance the load: a task
+ * submits all the tasks from a worker, so they all end up in the queue of that
+ * worker, and the other workers have to steal them.
+ */
+
+#ifdef STARPU_QUICK_CHECK
+static unsigned ntasks = 1000;
+#else
+static unsigned ntasks = 100000;
+#endif
+/* Length of the tasks, in us */
+static unsigned length = 20;
+
+static const char *default_policies[] = { "ws", "lws", "cws", NULL };
+
+void busy_func(void *descr[], void *arg)
+{
+	(void)descr;
+	(void)arg;
+	double start = starpu_timing_now();
+	while (starpu_timing_now() - start < length)
+		;
+}
+
+static struct starpu_codelet busy_codelet =
+{
+	.cpu_funcs = {busy_func},
+	.cpu_funcs_name = {"busy_func"},
+	.model = NULL,
+	.nbuffers = 0,
+};
+
+static int enodev;
+
+void spawn_func(void *descr[], void *arg)
+{
+	(void)descr;
+	(void)arg;
+	unsigned i;
+
+	for (i = 0; i < ntasks; i++)
+	{
+		struct starpu_task *task = starpu_task_create();
+		task->cl = &busy_codelet;
+		int ret = starpu_task_submit(task);
+		if (ret == -ENODEV)
+		{
+			task->destroy = 0;
+			starpu_task_destroy(task);
+			enodev = 1;
+			return;
+		}
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	}
+}
+
+static struct starpu_codelet spawn_codelet =
+{
+	.cpu_funcs = {spawn_func},
+	.cpu_funcs_name = {"spawn_func"},
+	.model = NULL,
+	.nbuffers = 0,
+};
+
+static int run(struct starpu_conf *conf, const char *policy)
+{
+	int ret;
+	double start, end, timing;
+	unsigned nworkers;
+
+	conf->sched_policy_name = policy;
+	ret = starpu_initialize(conf, NULL, NULL);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	nworkers = starpu_cpu_worker_get_count();
+	if (nworkers == 0)
+	{
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+
+	start = starpu_timing_now();
+	ret = starpu_task_insert(&spawn_codelet, 0);
+	if (ret == -ENODEV)
+	{
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+	ret = starpu_task_wait_for_all();
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait_for_all");
+	end = starpu_timing_now();
+
+	starpu_shutdown();
+
+	if (enodev)
+		return STARPU_TEST_SKIPPED;
+
+	timing = end - start;
+	/* Fraction of the time that the workers spent running tasks */
+	printf("%s\t%f\t%f\n", policy, timing/1000000, (double) ntasks * length / (timing * nworkers));
+	return EXIT_SUCCESS;
+}
+
+static void usage(char **argv)
+{
+	fprintf(stderr, "Usage: %s [-i ntasks] [-l length_us] [-p sched_policy] [-h]\n", argv[0]);
+	exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+	int c, ret = EXIT_SUCCESS;
+	const char *policy = NULL;
+	unsigned i;
+	struct starpu_conf conf;
+
+	while ((c = getopt(argc, argv, "i:l:p:h")) != -1)
+	switch(c)
+	{
+		case 'i':
+			ntasks = atoi(optarg);
+			break;
+		case 'l':
+			length = atoi(optarg);
+			break;
+		case 'p':
+			policy = optarg;
+			break;
+		case 'h':
+			usage(argv);
+			break;
+	}
+
+	starpu_conf_init(&conf);
+	starpu_conf_noworker(&conf);
+	conf.ncpus = -1;
+
+	if (getenv("STARPU_SCHED"))
+		/* Only test the policy requested by the environment */
+		policy = getenv("STARPU_SCHED");
+
+	printf("# policy\ttime (s)\tefficiency\n");
+	if (policy)
+		return run(&conf, policy);
+
+	for (i = 0; default_policies[i]; i++)
+	{
+		ret = run(&conf, default_policies[i]);
+		if (ret != EXIT_SUCCESS)
+			break;
+	}
+	return ret;
+}
@@ -0,0 +1,151 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Let CPU workers pop tasks ahead of time (STARPU_CPU_LOOKAHEAD), with both
+ * sequential tasks and parallel tasks which thus wait in the lookahead list
+ * of their first worker, and check that data dependencies are still
+ * respected.
+ */
+
+#if !defined(STARPU_HAVE_SETENV)
+#warning setenv is not defined. Skipping test
+int main(void)
+{
+	return STARPU_TEST_SKIPPED;
+}
+#else
+
+#define NDATA 4
+#define VECTORSIZE 1024
+#ifdef STARPU_QUICK_CHECK
+#define NITER 16
+#else
+#define NITER 128
+#endif
+
+static unsigned vectors[NDATA][VECTORSIZE];
+static unsigned nexecuted;
+
+static void inc_func(void *descr[], void *arg)
+{
+	(void) arg;
+	unsigned *v = (unsigned *) STARPU_VECTOR_GET_PTR(descr[0]);
+	unsigned n = STARPU_VECTOR_GET_NX(descr[0]);
+	unsigned i;
+
+	for (i = 0; i < n; i++)
+		v[i]++;
+}
+
+static struct starpu_codelet inc_cl =
+{
+	.cpu_funcs = { inc_func },
+	.cpu_funcs_name = { "inc_func" },
+	.nbuffers = 1,
+	.modes = { STARPU_RW },
+};
+
+/* Each rank checks its part of the vector */
+static void check_func(void *descr[], void *arg)
+{
+	unsigned expected = (uintptr_t) arg;
+	unsigned *v = (unsigned *) STARPU_VECTOR_GET_PTR(descr[0]);
+	unsigned n = STARPU_VECTOR_GET_NX(descr[0]);
+	int size = starpu_combined_worker_get_size();
+	int rank = starpu_combined_worker_get_rank();
+	unsigned i;
+
+	for (i = rank * n / size; i < (rank + 1) * n / size; i++)
+		STARPU_ASSERT_MSG(v[i] == expected, "got %u instead of %u\n", v[i], expected);
+	if (rank == 0)
+		STARPU_ATOMIC_ADD(&nexecuted, 1);
+}
+
+static struct starpu_codelet check_cl =
+{
+	.type = STARPU_SPMD,
+	.max_parallelism = INT_MAX,
+	.cpu_funcs = { check_func },
+	.cpu_funcs_name = { "check_func" },
+	.nbuffers = 1,
+	.modes = { STARPU_R },
+};
+
+int main(void)
+{
+	starpu_data_handle_t handles[NDATA];
+	struct starpu_conf conf;
+	unsigned i, j, k;
+	int ret;
+
+	setenv("STARPU_CPU_LOOKAHEAD", "4", 1);
+
+	starpu_conf_init(&conf);
+	conf.sched_policy_name = "peager";
+
+	ret = starpu_initialize(&conf, NULL, NULL);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	for (i = 0; i < NDATA; i++)
+		starpu_vector_data_register(&handles[i], STARPU_MAIN_RAM, (uintptr_t) vectors[i], VECTORSIZE, sizeof(vectors[i][0]));
+
+	for (k = 0; k < NITER; k++)
+		for (i = 0; i < NDATA; i++)
+		{
+			/* A few sequential tasks, then a parallel one */
+			for (j = 0; j < 2; j++)
+			{
+				ret = starpu_task_insert(&inc_cl, STARPU_RW, handles[i], 0);
+				if (ret == -ENODEV) goto enodev;
+				STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+			}
+			ret = starpu_task_insert(&check_cl, STARPU_R, handles[i],
+						 STARPU_CL_ARGS_NFREE, (void *) (uintptr_t) (2 * (k + 1)), 0,
+						 0);
+			if (ret == -ENODEV) goto enodev;
+			STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+		}
+
+	ret = starpu_task_wait_for_all();
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait_for_all");
+
+	for (i = 0; i < NDATA; i++)
+		starpu_data_unregister(handles[i]);
+	starpu_shutdown();
+
+	for (i = 0; i < NDATA; i++)
+		for (j = 0; j < VECTORSIZE; j++)
+			STARPU_ASSERT(vectors[i][j] == 2 * NITER);
+	STARPU_ASSERT(nexecuted == NITER * NDATA);
+
+	return EXIT_SUCCESS;
+
+enodev:
+	starpu_task_wait_for_all();
+	for (i = 0; i < NDATA; i++)
+		starpu_data_unregister(handles[i]);
+	fprintf(stderr, "WARNING: No one can execute this task\n");
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
+#endif
@@ -0,0 +1,145 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <math.h>
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Record a small diamond graph with starpu_bound_start, feed the history-based
+ * models of its three task kinds with known durations, and check the bounds
+ * returned by starpu_bound_compute_fast:
+ *
+ *        A (10ms)
+ *       /        \
+ *    B (20ms)   C (30ms)
+ *       \        /
+ *        D (10ms)
+ *
+ * A and D are of the same kind. The area bound is the total work, 70ms,
+ * divided by the number of workers, and the critical path is A-C-D, 50ms.
+ */
+
+static void func(void *descr[], void *arg)
+{
+	(void) descr;
+	(void) arg;
+}
+
+static struct starpu_perfmodel models[3] =
+{
+	{ .type = STARPU_HISTORY_BASED, .symbol = "bound_fast_10" },
+	{ .type = STARPU_HISTORY_BASED, .symbol = "bound_fast_20" },
+	{ .type = STARPU_HISTORY_BASED, .symbol = "bound_fast_30" },
+};
+
+/* In ms */
+static double durations[3] = { 10., 20., 30. };
+
+static struct starpu_codelet cls[3] =
+{
+	{ .cpu_funcs = { func }, .where = STARPU_CPU, .nbuffers = 0, .model = &models[0] },
+	{ .cpu_funcs = { func }, .where = STARPU_CPU, .nbuffers = 0, .model = &models[1] },
+	{ .cpu_funcs = { func }, .where = STARPU_CPU, .nbuffers = 0, .model = &models[2] },
+};
+
+/* Kind of each task of the graph */
+static unsigned kinds[4] = { 0, 1, 2, 0 };
+
+int main(void)
+{
+	struct starpu_task *start, *tasks[4];
+	struct starpu_task task;
+	struct starpu_conf conf;
+	double area, critical_path, kinds_bound;
+	double expected_area;
+	unsigned i;
+	int worker, ret;
+
+#if defined(STARPU_HAVE_SETENV)
+	/* Do not let the executions below recalibrate the models */
+	setenv("STARPU_CALIBRATE", "0", 1);
+#endif
+
+	starpu_conf_init(&conf);
+	starpu_conf_noworker(&conf);
+	conf.ncpus = -1;
+
+	ret = starpu_initialize(&conf, NULL, NULL);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	if (starpu_worker_get_count() == 0)
+	{
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+
+	/* Calibrate the models with constant durations */
+	for (i = 0; i < 3; i++)
+	{
+		starpu_task_init(&task);
+		task.cl = &cls[i];
+		for (worker = 0; worker < (int) starpu_worker_get_count(); worker++)
+		{
+			struct starpu_perfmodel_arch *arch = starpu_worker_get_perf_archtype(worker, STARPU_NMAX_SCHED_CTXS);
+			starpu_perfmodel_update_history_n(&models[i], &task, arch, 0, 0, durations[i] * 1000., 10);
+		}
+		starpu_task_clean(&task);
+	}
+
+	/* Hold the graph back until the bounds are computed */
+	start = starpu_task_create();
+	start->detach = 0;
+
+	starpu_bound_start(1, 0);
+
+	for (i = 0; i < 4; i++)
+	{
+		tasks[i] = starpu_task_create();
+		tasks[i]->cl = &cls[kinds[i]];
+	}
+	starpu_task_declare_deps(tasks[0], 1, start);
+	starpu_task_declare_deps(tasks[1], 1, tasks[0]);
+	starpu_task_declare_deps(tasks[2], 1, tasks[0]);
+	starpu_task_declare_deps(tasks[3], 2, tasks[1], tasks[2]);
+
+	for (i = 0; i < 4; i++)
+	{
+		ret = starpu_task_submit(tasks[i]);
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	}
+
+	starpu_bound_stop();
+	starpu_bound_compute_fast(&area, &critical_path, &kinds_bound);
+
+	ret = starpu_task_submit(start);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	ret = starpu_task_wait(start);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait");
+	starpu_task_wait_for_all();
+
+	expected_area = 70. / starpu_worker_get_count();
+	FPRINTF(stderr, "area %f ms, critical path %f ms, kinds %f ms\n", area, critical_path, kinds_bound);
+
+	starpu_shutdown();
+
+	STARPU_ASSERT_MSG(fabs(area - expected_area) < 1e-6, "area bound is %f instead of %f\n", area, expected_area);
+	STARPU_ASSERT_MSG(fabs(critical_path - 50.) < 1e-6, "critical path is %f instead of %f\n", critical_path, 50.);
+	STARPU_ASSERT_MSG(kinds_bound >= area - 1e-6 && kinds_bound >= critical_path - 1e-6, "kinds bound %f is below the other bounds\n", kinds_bound);
+
+	return EXIT_SUCCESS;
+}
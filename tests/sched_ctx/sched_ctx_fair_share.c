@@ -0,0 +1,126 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Two contexts with weights 3 and 1 share the same worker: while both have
+ * ready tasks, the first one has to get about three quarters of the worker
+ * time.
+ */
+
+#define NTASKS 40
+#define TASK_LENGTH 1000. /* us */
+
+static unsigned ctx[2];
+static int executed[2];
+static double consumed[2];
+
+void func(void *buffers[], void *args)
+{
+	int i = (int)(uintptr_t) args;
+	(void) buffers;
+	double start = starpu_timing_now();
+	while (starpu_timing_now() - start < TASK_LENGTH)
+		;
+	if (++executed[i] == NTASKS && !consumed[0])
+	{
+		/* One of the contexts is done, look at how the worker was shared
+		 * so far */
+		consumed[0] = starpu_sched_ctx_get_fair_share_consumed(ctx[0]);
+		consumed[1] = starpu_sched_ctx_get_fair_share_consumed(ctx[1]);
+	}
+}
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = {func},
+	.cpu_funcs_name = {"func"},
+	.nbuffers = 0
+};
+
+int main(void)
+{
+	int ret;
+	int i;
+	double ratio;
+	int workerid;
+	struct starpu_conf conf;
+
+#ifdef STARPU_SIMGRID
+	/* Execution times would all be zero */
+	return STARPU_TEST_SKIPPED;
+#endif
+
+	starpu_conf_init(&conf);
+	starpu_conf_noworker(&conf);
+	conf.ncpus = 1;
+	ret = starpu_initialize(&conf, NULL, NULL);
+	if (ret == -ENODEV)
+		return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	if (starpu_cpu_worker_get_count() != 1)
+	{
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+	starpu_worker_get_ids_by_type(STARPU_CPU_WORKER, &workerid, 1);
+
+	ctx[0] = starpu_sched_ctx_create(&workerid, 1, "heavy", STARPU_SCHED_CTX_POLICY_NAME, "eager", STARPU_SCHED_CTX_FAIR_SHARE_WEIGHT, 3., 0);
+	ctx[1] = starpu_sched_ctx_create(&workerid, 1, "light", STARPU_SCHED_CTX_POLICY_NAME, "eager", 0);
+	starpu_sched_ctx_set_fair_share_weight(ctx[1], 1.);
+	STARPU_ASSERT(starpu_sched_ctx_get_fair_share_weight(ctx[0]) == 3.);
+
+	/* Let both contexts fill up before the worker starts */
+	starpu_pause();
+	for (i = 0; i < 2 * NTASKS; i++)
+	{
+		struct starpu_task *task = starpu_task_create();
+		task->cl = &cl;
+		task->cl_arg = (void *)(uintptr_t) (i % 2);
+		ret = starpu_task_submit_to_ctx(task, ctx[i % 2]);
+		if (ret == -ENODEV)
+		{
+			task->destroy = 0;
+			starpu_task_destroy(task);
+			starpu_resume();
+			goto enodev;
+		}
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit_to_ctx");
+	}
+	starpu_resume();
+	starpu_task_wait_for_all();
+
+	STARPU_ASSERT(executed[0] == NTASKS && executed[1] == NTASKS);
+	ratio = consumed[0] / consumed[1];
+	FPRINTF(stderr, "contexts had consumed %f and %f us, ratio %f\n", consumed[0], consumed[1], ratio);
+
+	starpu_sched_ctx_delete(ctx[0]);
+	starpu_sched_ctx_delete(ctx[1]);
+	starpu_shutdown();
+
+	/* 3 expected, leave some room for the task being executed and for
+	 * timing noise */
+	return (ratio >= 1.5 && ratio <= 6.) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+enodev:
+	starpu_sched_ctx_delete(ctx[0]);
+	starpu_sched_ctx_delete(ctx[1]);
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
@@ -0,0 +1,136 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <starpu.h>
+#include <sched_policies/heteroprio.h>
+#include "../helper.h"
+
+/*
+ * Feed the online tuning of autoheteroprio with timings and scores which
+ * only vary by a few percents, less than the hysteresis margin, and check
+ * that the order of the priorities and the base arch of the buckets stay
+ * stable, that slow factors never go below 1, and that real changes are
+ * still taken into account.
+ */
+
+#define HYSTERESIS 0.1
+#define NOISE 0.03
+#define NPRIOS 5
+#ifdef STARPU_QUICK_CHECK
+#define NITER 100
+#else
+#define NITER 10000
+#endif
+
+static double noisy(double value)
+{
+	return value * (1. + NOISE * (2. * starpu_drand48() - 1.));
+}
+
+/* Re-sort the scores, starting from their last order, as autoheteroprio does */
+static void sort(struct _starpu_heteroprio_score *scores, const double *values)
+{
+	unsigned p;
+
+	for (p = 0; p < NPRIOS; p++)
+		scores[p].score = noisy(values[scores[p].index]);
+	_starpu_heteroprio_sort_scores(scores, NPRIOS, HYSTERESIS);
+	for (p = 0; p < NPRIOS; p++)
+		scores[p].last_rank = p + 1;
+}
+
+static void check_order(void)
+{
+	struct _starpu_heteroprio_score scores[NPRIOS];
+	double values[NPRIOS];
+	unsigned p, i;
+
+	for (p = 0; p < NPRIOS; p++)
+	{
+		values[p] = 100. * (p + 1);
+		scores[p].index = p;
+		scores[p].last_rank = 0;
+	}
+
+	/* The first order is just by decreasing score */
+	sort(scores, values);
+	for (p = 0; p < NPRIOS; p++)
+		STARPU_ASSERT_MSG(scores[p].index == NPRIOS - 1 - p, "priority %u is at rank %u\n", scores[p].index, p);
+
+	/* Bring the two best priorities close to each other, the noise
+	 * should not make them swap back and forth */
+	values[NPRIOS - 2] = values[NPRIOS - 1] * 0.99;
+	for (i = 0; i < NITER; i++)
+	{
+		sort(scores, values);
+		for (p = 0; p < NPRIOS; p++)
+			STARPU_ASSERT_MSG(scores[p].index == NPRIOS - 1 - p, "iteration %u: priority %u is at rank %u\n", i, scores[p].index, p);
+	}
+
+	/* But a priority which really becomes better does overtake */
+	values[0] = values[NPRIOS - 1] * 2.;
+	sort(scores, values);
+	STARPU_ASSERT_MSG(scores[0].index == 0, "priority 0 did not overtake, priority %u is first\n", scores[0].index);
+}
+
+static void check_slow_factors(double cpu_time, double cuda_time, unsigned expected_base)
+{
+	unsigned valid_archs[STARPU_NARCH] = {0};
+	double arch_times[STARPU_NARCH] = {0.};
+	float slow_factors[STARPU_NARCH] = {0.};
+	unsigned base = STARPU_CPU_WORKER, new_base, other, i;
+	float first_factor = 0.;
+
+	valid_archs[STARPU_CPU_WORKER] = 1;
+	valid_archs[STARPU_CUDA_WORKER] = 1;
+
+	for (i = 0; i < NITER; i++)
+	{
+		arch_times[STARPU_CPU_WORKER] = i ? noisy(cpu_time) : cpu_time;
+		arch_times[STARPU_CUDA_WORKER] = i ? noisy(cuda_time) : cuda_time;
+		new_base = _starpu_heteroprio_update_slow_factors(valid_archs, arch_times, base, slow_factors, HYSTERESIS);
+		if (new_base != base)
+		{
+			/* Only the first estimation may change the base arch */
+			STARPU_ASSERT_MSG(i == 0, "iteration %u: the base arch changed\n", i);
+			base = new_base;
+			slow_factors[base] = 0.;
+		}
+		other = base == STARPU_CPU_WORKER ? STARPU_CUDA_WORKER : STARPU_CPU_WORKER;
+
+		STARPU_ASSERT_MSG(slow_factors[other] >= 1., "iteration %u: slow factor %f is below 1\n", i, slow_factors[other]);
+		if (i == 0)
+			first_factor = slow_factors[other];
+		else
+			STARPU_ASSERT_MSG(slow_factors[other] == first_factor, "iteration %u: slow factor changed from %f to %f\n", i, first_factor, slow_factors[other]);
+	}
+	STARPU_ASSERT_MSG(base == expected_base, "base arch is %u instead of %u\n", base, expected_base);
+}
+
+int main(void)
+{
+	starpu_srand48(0);
+
+	check_order();
+
+	/* Clearly faster GPU */
+	check_slow_factors(100., 10., STARPU_CUDA_WORKER);
+	/* Slightly faster GPU, but not by enough to become the base arch,
+	 * it is then considered as fast as the CPUs */
+	check_slow_factors(10.2, 10., STARPU_CPU_WORKER);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,195 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * With the cache-affinity policy, submit several tasks reading each piece of
+ * data, and check that the tasks which share data mostly run on workers which
+ * share a cache. This needs at least two last level caches, e.g. with
+ * HWLOC_SYNTHETIC="pack:2 l3:1(size=4MB) core:1 pu:1".
+ */
+
+#if !defined(STARPU_HAVE_HWLOC) || !defined(STARPU_HAVE_SETENV)
+#warning hwloc or setenv is not available. Skipping test
+int main(void)
+{
+	return STARPU_TEST_SKIPPED;
+}
+#else
+
+#include <hwloc.h>
+
+#define NDATA_PER_CACHE 2
+#ifdef STARPU_QUICK_CHECK
+#define NTASKS_PER_DATA 16
+#else
+#define NTASKS_PER_DATA 64
+#endif
+#define VECTORSIZE 4096
+/* Tasks stolen by idle workers at the end run on another cache */
+#define MIN_RATIO 0.75
+
+static int task_worker[STARPU_NMAXWORKERS * NDATA_PER_CACHE * NTASKS_PER_DATA];
+
+static void func(void *descr[], void *arg)
+{
+	unsigned *v = (unsigned *) STARPU_VECTOR_GET_PTR(descr[0]);
+	unsigned n = STARPU_VECTOR_GET_NX(descr[0]);
+	unsigned i, sum = 0;
+	double start = starpu_timing_now();
+
+	/* Take some time, so that the queues do not get drained by a
+	 * single worker */
+	while (starpu_timing_now() - start < 500.)
+		for (i = 0; i < n; i++)
+			sum += v[i];
+	STARPU_ASSERT(sum == 0);
+
+	task_worker[(uintptr_t) arg] = starpu_worker_get_id();
+}
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = {func},
+	.cpu_funcs_name = {"func"},
+	.where = STARPU_CPU,
+	.nbuffers = 1,
+	.modes = {STARPU_R},
+};
+
+/* The last level data cache of the worker, as the policy does */
+static hwloc_obj_t worker_cache(int workerid)
+{
+	hwloc_obj_t obj, cache = NULL;
+
+	for (obj = starpu_worker_get_hwloc_obj(workerid); obj; obj = obj->parent)
+#if HWLOC_API_VERSION >= 0x00020000
+		if (hwloc_obj_type_is_dcache(obj->type))
+#else
+		if (obj->type == HWLOC_OBJ_CACHE && obj->attr->cache.type != HWLOC_OBJ_CACHE_INSTRUCTION)
+#endif
+			cache = obj;
+	return cache;
+}
+
+int main(void)
+{
+	hwloc_obj_t caches[STARPU_NMAXWORKERS];
+	int cache_of_worker[STARPU_NMAXWORKERS];
+	starpu_data_handle_t handles[STARPU_NMAXWORKERS * NDATA_PER_CACHE];
+	static unsigned vectors[STARPU_NMAXWORKERS * NDATA_PER_CACHE][VECTORSIZE];
+	struct starpu_conf conf;
+	unsigned ncaches = 0, ndata, nworkers, ngrouped = 0;
+	unsigned d, i, j, c;
+	int worker, ret;
+
+	/* Group on the last level */
+	unsetenv("STARPU_SCHED_CACHE_LEVEL");
+
+	starpu_conf_init(&conf);
+	starpu_conf_noworker(&conf);
+	conf.ncpus = -1;
+	conf.sched_policy_name = "cache-affinity";
+	ret = starpu_initialize(&conf, NULL, NULL);
+	if (ret == -ENODEV)
+		return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	nworkers = starpu_worker_get_count();
+	for (worker = 0; worker < (int) nworkers; worker++)
+	{
+		hwloc_obj_t cache = worker_cache(worker);
+		cache_of_worker[worker] = -1;
+		if (!cache || !cache->attr->cache.size || cache->attr->cache.size < sizeof(vectors[0]))
+			continue;
+		for (c = 0; c < ncaches; c++)
+			if (caches[c] == cache)
+				break;
+		if (c == ncaches)
+			caches[ncaches++] = cache;
+		cache_of_worker[worker] = c;
+	}
+	if (strcmp(starpu_sched_get_sched_policy()->policy_name, "cache-affinity") || ncaches < 2)
+	{
+		/* Overridden by the environment, or all workers share the
+		 * same cache anyway */
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+
+	ndata = ncaches * NDATA_PER_CACHE;
+	for (d = 0; d < ndata; d++)
+		starpu_vector_data_register(&handles[d], STARPU_MAIN_RAM, (uintptr_t) vectors[d], VECTORSIZE, sizeof(vectors[d][0]));
+
+	/* Queue all the tasks before letting workers run them. Rotate the
+	 * order in each round, so that distributing tasks round-robin does not
+	 * group them by data by chance */
+	starpu_pause();
+	for (i = 0; i < NTASKS_PER_DATA; i++)
+		for (j = 0; j < ndata; j++)
+		{
+			d = (i + j) % ndata;
+			ret = starpu_task_insert(&cl, STARPU_R, handles[d],
+						 STARPU_CL_ARGS_NFREE, (void*)(uintptr_t) (d * NTASKS_PER_DATA + i), (size_t) 0,
+						 0);
+			if (ret == -ENODEV) goto enodev;
+			STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+		}
+	starpu_resume();
+
+	ret = starpu_task_wait_for_all();
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait_for_all");
+
+	for (d = 0; d < ndata; d++)
+		starpu_data_unregister(handles[d]);
+	starpu_shutdown();
+
+	/* For each piece of data, count the tasks which ran on the cache
+	 * where most of them ran */
+	for (d = 0; d < ndata; d++)
+	{
+		unsigned count[STARPU_NMAXWORKERS] = { 0 };
+		unsigned best = 0;
+
+		for (i = 0; i < NTASKS_PER_DATA; i++)
+		{
+			int cache = cache_of_worker[task_worker[d * NTASKS_PER_DATA + i]];
+			if (cache >= 0)
+				count[cache]++;
+		}
+		for (c = 0; c < ncaches; c++)
+			if (count[c] > best)
+				best = count[c];
+		FPRINTF(stderr, "data %u: %u tasks out of %u ran on the same cache\n", d, best, NTASKS_PER_DATA);
+		ngrouped += best;
+	}
+
+	STARPU_ASSERT_MSG(ngrouped >= MIN_RATIO * ndata * NTASKS_PER_DATA, "only %u tasks out of %u ran on the cache of the other tasks reading the same data\n", ngrouped, ndata * NTASKS_PER_DATA);
+
+	return EXIT_SUCCESS;
+
+enodev:
+	starpu_resume();
+	starpu_task_wait_for_all();
+	for (d = 0; d < ndata; d++)
+		starpu_data_unregister(handles[d]);
+	fprintf(stderr, "WARNING: No one can execute this task\n");
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
+#endif
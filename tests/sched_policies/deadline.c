@@ -0,0 +1,143 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <starpu.h>
+#include <starpu_scheduler.h>
+#include "../helper.h"
+
+/*
+ * Tasks with a deadline must be executed before the batch tasks submitted
+ * before them, even with a higher priority, and in the order of their
+ * deadlines.
+ */
+
+#define NBATCH 10
+#define NDEADLINE 10
+
+static int order[NBATCH + NDEADLINE];
+static int executed;
+static volatile int blocker_started, blocker_release;
+
+void func(void *buffers[], void *args)
+{
+	(void) buffers;
+	order[executed++] = (int)(uintptr_t) args;
+}
+
+/* Keep the worker busy while the other tasks are being submitted */
+void blocker_func(void *buffers[], void *args)
+{
+	(void) buffers;
+	(void) args;
+	blocker_started = 1;
+	while (!blocker_release)
+		STARPU_SYNCHRONIZE();
+}
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = {func},
+	.cpu_funcs_name = {"func"},
+	.flags = STARPU_CODELET_SIMGRID_EXECUTE,
+	.nbuffers = 0
+};
+
+static struct starpu_codelet blocker_cl =
+{
+	.cpu_funcs = {blocker_func},
+	.cpu_funcs_name = {"blocker_func"},
+	.flags = STARPU_CODELET_SIMGRID_EXECUTE,
+	.nbuffers = 0
+};
+
+int main(void)
+{
+	int ret;
+	int i;
+	double now;
+	struct starpu_conf conf;
+
+#ifdef STARPU_SIMGRID
+	/* The blocker task would never let the simulation progress */
+	return STARPU_TEST_SKIPPED;
+#endif
+
+	starpu_conf_init(&conf);
+	starpu_conf_noworker(&conf);
+	/* Only one worker, to get a deterministic order */
+	conf.ncpus = 1;
+	conf.sched_policy_name = "modular-deadline";
+	ret = starpu_initialize(&conf, NULL, NULL);
+	if (ret == -ENODEV)
+		return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+	if (strcmp(starpu_sched_get_sched_policy()->policy_name, "modular-deadline") || starpu_worker_get_count() != 1)
+	{
+		/* Overridden by the environment */
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+
+	ret = starpu_task_insert(&blocker_cl, 0);
+	if (ret == -ENODEV) goto enodev;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+	while (!blocker_started)
+		STARPU_SYNCHRONIZE();
+
+	for (i = 0; i < NBATCH; i++)
+	{
+		ret = starpu_task_insert(&cl,
+					 STARPU_CL_ARGS_NFREE, (void*)(uintptr_t) i, (size_t) 0,
+					 STARPU_PRIORITY, STARPU_MAX_PRIO,
+					 0);
+		if (ret == -ENODEV) goto enodev;
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+	}
+
+	/* Deadlines are given in decreasing order */
+	now = starpu_timing_now();
+	for (i = 0; i < NDEADLINE; i++)
+	{
+		ret = starpu_task_insert(&cl,
+					 STARPU_CL_ARGS_NFREE, (void*)(uintptr_t) (NBATCH + i), (size_t) 0,
+					 STARPU_TASK_DEADLINE, now + 3600e6 - i,
+					 0);
+		if (ret == -ENODEV) goto enodev;
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+	}
+
+	blocker_release = 1;
+	starpu_task_wait_for_all();
+	starpu_shutdown();
+
+	STARPU_ASSERT(executed == NBATCH + NDEADLINE);
+	for (i = 0; i < NDEADLINE; i++)
+	{
+		if (order[i] != NBATCH + NDEADLINE - 1 - i)
+		{
+			FPRINTF(stderr, "task %d was executed at position %d\n", order[i], i);
+			return EXIT_FAILURE;
+		}
+	}
+	for (i = 0; i < NBATCH; i++)
+		STARPU_ASSERT(order[NDEADLINE + i] == i);
+
+	return EXIT_SUCCESS;
+
+enodev:
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
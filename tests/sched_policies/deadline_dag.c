@@ -0,0 +1,181 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <starpu.h>
+#include <starpu_scheduler.h>
+#include "../helper.h"
+
+/*
+ * With the critical path information, the laxity of a task with a deadline
+ * put on a whole DAG accounts for its successors: the head of a long chain
+ * has to run before a single task whose deadline is a bit earlier.
+ */
+
+#if !defined(STARPU_HAVE_SETENV)
+#warning setenv is not defined. Skipping test
+int main(void)
+{
+	return STARPU_TEST_SKIPPED;
+}
+#else
+
+#define NCHAIN 5
+/* In us */
+#define LENGTH 10000.
+
+static int order[NCHAIN + 2];
+static int executed;
+static volatile int blocker_started, blocker_release;
+
+void func(void *buffers[], void *args)
+{
+	(void) buffers;
+	order[executed++] = (int)(uintptr_t) args;
+}
+
+/* Keep the worker busy while the other tasks are being submitted */
+void blocker_func(void *buffers[], void *args)
+{
+	(void) buffers;
+	(void) args;
+	blocker_started = 1;
+	while (!blocker_release)
+		STARPU_SYNCHRONIZE();
+}
+
+static struct starpu_perfmodel model =
+{
+	.type = STARPU_HISTORY_BASED,
+	.symbol = "deadline_dag"
+};
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = {func},
+	.cpu_funcs_name = {"func"},
+	.where = STARPU_CPU,
+	.model = &model,
+	.nbuffers = 0
+};
+
+static struct starpu_codelet blocker_cl =
+{
+	.cpu_funcs = {blocker_func},
+	.cpu_funcs_name = {"blocker_func"},
+	.nbuffers = 0
+};
+
+int main(void)
+{
+	struct starpu_task *start, *chain[NCHAIN], *single;
+	struct starpu_task task;
+	struct starpu_conf conf;
+	double deadline;
+	int ret;
+	int i;
+
+#ifdef STARPU_SIMGRID
+	/* The blocker task would never let the simulation progress */
+	return STARPU_TEST_SKIPPED;
+#endif
+
+	setenv("STARPU_CRITICAL_PATH", "1", 1);
+	/* Do not let the executions below recalibrate the model */
+	setenv("STARPU_CALIBRATE", "0", 1);
+
+	starpu_conf_init(&conf);
+	starpu_conf_noworker(&conf);
+	/* Only one worker, to get a deterministic order */
+	conf.ncpus = 1;
+	conf.sched_policy_name = "modular-deadline";
+	ret = starpu_initialize(&conf, NULL, NULL);
+	if (ret == -ENODEV)
+		return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+	if (strcmp(starpu_sched_get_sched_policy()->policy_name, "modular-deadline") || starpu_worker_get_count() != 1)
+	{
+		/* Overridden by the environment */
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+
+	/* All tasks are expected to take the same time */
+	starpu_task_init(&task);
+	task.cl = &cl;
+	starpu_perfmodel_update_history_n(&model, &task, starpu_worker_get_perf_archtype(0, STARPU_NMAX_SCHED_CTXS), 0, 0, LENGTH, 10);
+	starpu_task_clean(&task);
+
+	ret = starpu_task_insert(&blocker_cl, 0);
+	if (ret == -ENODEV) goto enodev;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+	while (!blocker_started)
+		STARPU_SYNCHRONIZE();
+
+	/* Hold the chain back until it is completely submitted, so that the
+	 * critical path is known when its head is pushed */
+	start = starpu_task_create();
+	start->detach = 0;
+
+	/* The chain has a later deadline, but needs NCHAIN times as long */
+	deadline = starpu_timing_now() + 3600e6;
+	for (i = 0; i < NCHAIN; i++)
+	{
+		chain[i] = starpu_task_create();
+		chain[i]->cl = &cl;
+		chain[i]->cl_arg = (void*)(uintptr_t) i;
+		chain[i]->deadline = deadline + 2 * LENGTH;
+		starpu_task_declare_deps(chain[i], 1, i ? chain[i-1] : start);
+	}
+	for (i = 0; i < NCHAIN; i++)
+	{
+		ret = starpu_task_submit(chain[i]);
+		if (ret == -ENODEV) goto enodev;
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	}
+
+	single = starpu_task_create();
+	single->cl = &cl;
+	single->cl_arg = (void*)(uintptr_t) NCHAIN;
+	single->deadline = deadline;
+	ret = starpu_task_submit(single);
+	if (ret == -ENODEV) goto enodev;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+
+	ret = starpu_task_submit(start);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	ret = starpu_task_wait(start);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait");
+
+	blocker_release = 1;
+	starpu_task_wait_for_all();
+	starpu_shutdown();
+
+	STARPU_ASSERT(executed == NCHAIN + 1);
+	if (order[0] != 0)
+	{
+		FPRINTF(stderr, "task %d was executed before the head of the chain\n", order[0]);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+
+enodev:
+	blocker_release = 1;
+	starpu_task_wait_for_all();
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
+#endif
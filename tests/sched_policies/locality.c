@@ -0,0 +1,143 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Run tasks through the locality components of the modular-numa scheduler.
+ * Tasks submitted from the main thread are spread over the hierarchy, while
+ * the tasks submitted from callbacks are pushed to the queue of the worker
+ * which submits them, so that the other workers have to steal them.
+ */
+
+#ifdef STARPU_QUICK_CHECK
+#define NDATA 4
+#define NTASKS 64
+#define NCHILDREN 4
+#else
+#define NDATA 16
+#define NTASKS 512
+#define NCHILDREN 16
+#endif
+
+static unsigned counters[NDATA];
+static unsigned nexecuted;
+static unsigned executed_by[STARPU_NMAXWORKERS];
+static starpu_data_handle_t handles[NDATA];
+
+static void inc_func(void *descr[], void *arg)
+{
+	(void) arg;
+	unsigned *x = (unsigned *) STARPU_VARIABLE_GET_PTR(descr[0]);
+	(*x)++;
+	STARPU_ATOMIC_ADD(&nexecuted, 1);
+	STARPU_ATOMIC_ADD(&executed_by[starpu_worker_get_id_check()], 1);
+}
+
+static void read_func(void *descr[], void *arg)
+{
+	(void) descr;
+	(void) arg;
+	STARPU_ATOMIC_ADD(&nexecuted, 1);
+	STARPU_ATOMIC_ADD(&executed_by[starpu_worker_get_id_check()], 1);
+}
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = { inc_func },
+	.cpu_funcs_name = { "inc_func" },
+	.nbuffers = 1,
+	.modes = { STARPU_RW },
+};
+
+static struct starpu_codelet cl_r =
+{
+	.cpu_funcs = { read_func },
+	.cpu_funcs_name = { "read_func" },
+	.nbuffers = 1,
+	.modes = { STARPU_R },
+};
+
+/* Submit tasks from the worker, which the locality component keeps close */
+static void callback(void *arg)
+{
+	unsigned i = (uintptr_t) arg;
+	unsigned j;
+	int ret;
+
+	for (j = 0; j < NCHILDREN; j++)
+	{
+		ret = starpu_task_insert(&cl_r, STARPU_R, handles[(i + 1) % NDATA], 0);
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+	}
+}
+
+int main(void)
+{
+	struct starpu_conf conf;
+	unsigned i, nworkers = 0;
+	int ret;
+
+	starpu_conf_init(&conf);
+	conf.sched_policy_name = "modular-numa";
+
+	ret = starpu_initialize(&conf, NULL, NULL);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	if (starpu_cpu_worker_get_count() == 0)
+	{
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+
+	for (i = 0; i < NDATA; i++)
+		starpu_variable_data_register(&handles[i], STARPU_MAIN_RAM, (uintptr_t) &counters[i], sizeof(counters[i]));
+
+	for (i = 0; i < NTASKS; i++)
+	{
+		ret = starpu_task_insert(&cl, STARPU_RW, handles[i % NDATA],
+					 STARPU_CALLBACK_WITH_ARG_NFREE, callback, (void *) (uintptr_t) i,
+					 0);
+		if (ret == -ENODEV) goto enodev;
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_insert");
+	}
+
+	starpu_task_wait_for_all();
+
+	for (i = 0; i < NDATA; i++)
+		starpu_data_unregister(handles[i]);
+
+	for (i = 0; i < NDATA; i++)
+		STARPU_ASSERT_MSG(counters[i] == NTASKS / NDATA, "data %u was modified %u times instead of %u\n", i, counters[i], NTASKS / NDATA);
+	STARPU_ASSERT_MSG(nexecuted == NTASKS * (1 + NCHILDREN), "%u tasks were executed instead of %u\n", nexecuted, NTASKS * (1 + NCHILDREN));
+
+	for (i = 0; i < starpu_worker_get_count(); i++)
+		if (executed_by[i])
+			nworkers++;
+	FPRINTF(stderr, "%u workers executed tasks\n", nworkers);
+
+	starpu_shutdown();
+	return EXIT_SUCCESS;
+
+enodev:
+	for (i = 0; i < NDATA; i++)
+		starpu_data_unregister(handles[i]);
+	fprintf(stderr, "WARNING: No one can execute this task\n");
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
@@ -0,0 +1,134 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <math.h>
+#include <starpu.h>
+#include <common/graph.h>
+#include "../helper.h"
+
+/*
+ * Submit a small diamond graph to dmdal and check the expected lengths and
+ * optimistic cost table it records:
+ *
+ *        A (10)
+ *       /      \
+ *    B (20)   C (30)
+ *       \      /
+ *        D (5)
+ *
+ * With only one class of workers, the optimistic cost of a task is the
+ * length of the longest path after it: 35 for A, 5 for B and C, 0 for D.
+ */
+
+static double lengths[] = { 10., 20., 30., 5. };
+static double octs[] = { 35., 5., 5., 0. };
+
+static void func(void *descr[], void *arg)
+{
+	(void) descr;
+	(void) arg;
+}
+
+static double cost_function(struct starpu_task *task, struct starpu_perfmodel_arch *arch, unsigned nimpl)
+{
+	(void) arch;
+	(void) nimpl;
+	return *(double *) task->cl_arg;
+}
+
+static struct starpu_perfmodel model =
+{
+	.type = STARPU_PER_ARCH,
+	.arch_cost_function = cost_function,
+};
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = { func },
+	.cpu_funcs_name = { "func" },
+	.where = STARPU_CPU,
+	.nbuffers = 0,
+	.model = &model,
+};
+
+int main(void)
+{
+	struct starpu_task *start, *tasks[4];
+	struct starpu_conf conf;
+	double length, oct;
+	unsigned i;
+	int ret;
+
+	starpu_conf_init(&conf);
+	starpu_conf_noworker(&conf);
+	conf.ncpus = -1;
+	conf.sched_policy_name = "dmdal";
+
+	ret = starpu_initialize(&conf, NULL, NULL);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	if (_starpu_graph_lookahead_nclasses() != 1)
+	{
+		/* Transfers between memory nodes would come into play */
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+
+	/* Hold the graph back until we have checked it */
+	start = starpu_task_create();
+	start->detach = 0;
+
+	for (i = 0; i < 4; i++)
+	{
+		tasks[i] = starpu_task_create();
+		tasks[i]->cl = &cl;
+		tasks[i]->cl_arg = &lengths[i];
+		tasks[i]->detach = 0;
+	}
+	starpu_task_declare_deps(tasks[0], 1, start);
+	starpu_task_declare_deps(tasks[1], 1, tasks[0]);
+	starpu_task_declare_deps(tasks[2], 1, tasks[0]);
+	starpu_task_declare_deps(tasks[3], 2, tasks[1], tasks[2]);
+
+	for (i = 0; i < 4; i++)
+	{
+		ret = starpu_task_submit(tasks[i]);
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	}
+
+	for (i = 0; i < 4; i++)
+	{
+		ret = _starpu_graph_lookahead_task_costs(tasks[i], &length, &oct);
+		STARPU_ASSERT_MSG(ret, "no lookahead information for task %u\n", i);
+		FPRINTF(stderr, "task %c: length %f oct %f\n", 'A' + i, length, oct);
+		STARPU_ASSERT_MSG(fabs(length - lengths[i]) < 1e-6, "task %c has length %f instead of %f\n", 'A' + i, length, lengths[i]);
+		STARPU_ASSERT_MSG(fabs(oct - octs[i]) < 1e-6, "task %c has optimistic cost %f instead of %f\n", 'A' + i, oct, octs[i]);
+	}
+
+	ret = starpu_task_submit(start);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	ret = starpu_task_wait(start);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait");
+	for (i = 0; i < 4; i++)
+	{
+		ret = starpu_task_wait(tasks[i]);
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait");
+	}
+
+	starpu_shutdown();
+	return EXIT_SUCCESS;
+}
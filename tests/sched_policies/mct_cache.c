@@ -0,0 +1,174 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <math.h>
+#include <starpu.h>
+#include <starpu_scheduler.h>
+#include <starpu_sched_component.h>
+#include "../helper.h"
+
+/*
+ * With the prediction cache of the mct helper (STARPU_SCHED_MCT_CACHE),
+ * check that tasks which look the same get the same prediction, and that
+ * the prediction follows the performance model when it gets recalibrated.
+ * The modular-heft policies recompute the prediction below the mct component
+ * to pick the best implementation, so use an mct tree without it.
+ */
+
+#if !defined(STARPU_HAVE_SETENV)
+#warning setenv is not defined. Skipping test
+int main(void)
+{
+	return STARPU_TEST_SKIPPED;
+}
+#else
+
+/* In us. The second length is close enough to the first one for the model
+ * not to consider it as an outlier, and the model may have been saved by
+ * previous runs, so only check that the prediction increases */
+#define LENGTH1 1000.
+#define LENGTH2 1400.
+
+static void func(void *descr[], void *arg)
+{
+	(void) descr;
+	(void) arg;
+}
+
+static struct starpu_perfmodel model =
+{
+	.type = STARPU_HISTORY_BASED,
+	.symbol = "mct_cache"
+};
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = {func},
+	.cpu_funcs_name = {"func"},
+	.where = STARPU_CPU,
+	.model = &model,
+	.nbuffers = 0
+};
+
+static void init_mct_policy(unsigned sched_ctx_id)
+{
+	starpu_sched_component_initialize_simple_scheduler((starpu_sched_component_create_t) starpu_sched_component_mct_create, NULL,
+			STARPU_SCHED_SIMPLE_DECIDE_WORKERS |
+			STARPU_SCHED_SIMPLE_DECIDE_ALWAYS |
+			STARPU_SCHED_SIMPLE_PERFMODEL |
+			STARPU_SCHED_SIMPLE_FIFOS_BELOW, sched_ctx_id);
+}
+
+static struct starpu_sched_policy mct_policy =
+{
+	.init_sched = init_mct_policy,
+	.deinit_sched = starpu_sched_tree_deinitialize,
+	.add_workers = starpu_sched_tree_add_workers,
+	.remove_workers = starpu_sched_tree_remove_workers,
+	.push_task = starpu_sched_tree_push_task,
+	.pop_task = starpu_sched_tree_pop_task,
+	.pre_exec_hook = starpu_sched_component_worker_pre_exec_hook,
+	.post_exec_hook = starpu_sched_component_worker_post_exec_hook,
+	.policy_name = "mct-cache",
+	.policy_description = "mct modular policy without implementation selection",
+};
+
+static void calibrate(double length)
+{
+	struct starpu_task task;
+	int worker;
+
+	starpu_task_init(&task);
+	task.cl = &cl;
+	for (worker = 0; worker < (int) starpu_worker_get_count(); worker++)
+		starpu_perfmodel_update_history_n(&model, &task, starpu_worker_get_perf_archtype(worker, STARPU_NMAX_SCHED_CTXS), 0, 0, length, 10);
+	starpu_task_clean(&task);
+}
+
+/* Run a task and return the length which the scheduler predicted for it */
+static double predict(void)
+{
+	struct starpu_task *task = starpu_task_create();
+	double predicted;
+	int ret;
+
+	task->cl = &cl;
+	task->detach = 0;
+	task->destroy = 0;
+	ret = starpu_task_submit(task);
+	if (ret == -ENODEV)
+	{
+		starpu_task_destroy(task);
+		return NAN;
+	}
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	ret = starpu_task_wait(task);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait");
+	predicted = task->predicted;
+	starpu_task_destroy(task);
+	return predicted;
+}
+
+int main(void)
+{
+	struct starpu_conf conf;
+	double first, second, recalibrated;
+	int ret;
+
+	setenv("STARPU_SCHED_MCT_CACHE", "1", 1);
+	/* Do not let the executions below recalibrate the model */
+	setenv("STARPU_CALIBRATE", "0", 1);
+
+	starpu_conf_init(&conf);
+	starpu_conf_noworker(&conf);
+	conf.ncpus = -1;
+	conf.sched_policy = &mct_policy;
+	ret = starpu_initialize(&conf, NULL, NULL);
+	if (ret == -ENODEV)
+		return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+	if (strcmp(starpu_sched_get_sched_policy()->policy_name, "mct-cache") || starpu_worker_get_count() == 0)
+	{
+		/* Overridden by the environment */
+		starpu_shutdown();
+		return STARPU_TEST_SKIPPED;
+	}
+
+	calibrate(LENGTH1);
+	first = predict();
+	if (isnan(first))
+		goto enodev;
+	/* This one comes from the cache */
+	second = predict();
+
+	/* Recalibrating the model has to invalidate the cache */
+	calibrate(LENGTH2);
+	recalibrated = predict();
+
+	starpu_shutdown();
+
+	FPRINTF(stderr, "predicted %f us, then %f us, and %f us after recalibration\n", first, second, recalibrated);
+	STARPU_ASSERT_MSG(first >= LENGTH1 && first < LENGTH2, "predicted %f instead of a length between %f and %f\n", first, LENGTH1, LENGTH2);
+	STARPU_ASSERT_MSG(second == first, "predicted %f the second time instead of %f\n", second, first);
+	STARPU_ASSERT_MSG(recalibrated > first, "predicted %f after recalibration, the cache was not invalidated\n", recalibrated);
+
+	return EXIT_SUCCESS;
+
+enodev:
+	starpu_shutdown();
+	return STARPU_TEST_SKIPPED;
+}
+#endif
@@ -0,0 +1,199 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+#include <stdlib.h>
+#include <starpu.h>
+#include "../helper.h"
+
+/*
+ * Use the sharded queue above the decision component of modular schedulers
+ * (STARPU_SCHED_SHARDED_ABOVE), submit tasks with various priorities from
+ * several threads and from callbacks, and check that they all get executed.
+ * Some tasks can only run on CPUs, check that they are not handed to other
+ * workers on heterogeneous machines.
+ */
+
+#if !defined(STARPU_HAVE_SETENV)
+#warning setenv is not defined. Skipping test
+int main(void)
+{
+	return STARPU_TEST_SKIPPED;
+}
+#else
+
+#define NTHREADS 4
+#ifdef STARPU_QUICK_CHECK
+#define NTASKS 256
+#else
+#define NTASKS 4096
+#endif
+
+static unsigned nexecuted;
+
+static void func(void *descr[], void *arg)
+{
+	(void) descr;
+	(void) arg;
+	STARPU_ATOMIC_ADD(&nexecuted, 1);
+}
+
+static double cost_function(struct starpu_task *task, struct starpu_perfmodel_arch *arch, unsigned nimpl)
+{
+	(void) task;
+	(void) arch;
+	(void) nimpl;
+	return 1.;
+}
+
+static struct starpu_perfmodel model =
+{
+	.type = STARPU_PER_ARCH,
+	.arch_cost_function = cost_function,
+};
+
+static void cpu_func(void *descr[], void *arg)
+{
+	(void) descr;
+	(void) arg;
+	STARPU_ASSERT(starpu_worker_get_type(starpu_worker_get_id_check()) == STARPU_CPU_WORKER);
+	STARPU_ATOMIC_ADD(&nexecuted, 1);
+}
+
+static struct starpu_codelet cl =
+{
+	.cpu_funcs = { func },
+	.cuda_funcs = { func },
+	.opencl_funcs = { func },
+	.cpu_funcs_name = { "func" },
+	.nbuffers = 0,
+	.model = &model,
+};
+
+static struct starpu_codelet cpu_cl =
+{
+	.cpu_funcs = { cpu_func },
+	.cpu_funcs_name = { "cpu_func" },
+	.where = STARPU_CPU,
+	.nbuffers = 0,
+	.model = &model,
+};
+
+static int submit(struct starpu_codelet *codelet, int prio, void (*callback)(void *))
+{
+	struct starpu_task *task = starpu_task_create();
+	int ret;
+
+	task->cl = codelet;
+	task->priority = prio;
+	task->callback_func = callback;
+	ret = starpu_task_submit(task);
+	if (ret == -ENODEV)
+	{
+		task->destroy = 0;
+		starpu_task_destroy(task);
+	}
+	return ret;
+}
+
+/* Also push from the workers */
+static void callback(void *arg)
+{
+	int ret;
+	(void) arg;
+	ret = submit(&cl, STARPU_MAX_PRIO, NULL);
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+}
+
+static int enodev;
+
+static void *submitter(void *arg)
+{
+	unsigned t = (uintptr_t) arg;
+	unsigned i;
+	/* Use a few priorities, policies may support huge ranges */
+	long long nprios = (long long) STARPU_MAX_PRIO - STARPU_MIN_PRIO + 1;
+	if (nprios > 5)
+		nprios = 5;
+
+	for (i = 0; i < NTASKS; i++)
+	{
+		int prio = STARPU_MIN_PRIO + (int) ((t + i) % nprios);
+		int ret = submit(i % 3 == 0 ? &cpu_cl : &cl, prio, i % 16 == 0 ? callback : NULL);
+		if (ret == -ENODEV)
+		{
+			enodev = 1;
+			break;
+		}
+		STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_submit");
+	}
+	return NULL;
+}
+
+static int run(const char *policy)
+{
+	starpu_pthread_t threads[NTHREADS];
+	struct starpu_conf conf;
+	unsigned t, expected;
+	int ret;
+
+	starpu_conf_init(&conf);
+	conf.sched_policy_name = policy;
+
+	ret = starpu_initialize(&conf, NULL, NULL);
+	if (ret == -ENODEV) return STARPU_TEST_SKIPPED;
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_init");
+
+	nexecuted = 0;
+	for (t = 0; t < NTHREADS; t++)
+		STARPU_PTHREAD_CREATE(&threads[t], NULL, submitter, (void *)(uintptr_t) t);
+	for (t = 0; t < NTHREADS; t++)
+		STARPU_PTHREAD_JOIN(threads[t], NULL);
+
+	ret = starpu_task_wait_for_all();
+	STARPU_CHECK_RETURN_VALUE(ret, "starpu_task_wait_for_all");
+	starpu_shutdown();
+
+	if (enodev)
+		return STARPU_TEST_SKIPPED;
+
+	expected = NTHREADS * (NTASKS + NTASKS / 16);
+	FPRINTF(stderr, "%s: %u tasks executed out of %u\n", policy, nexecuted, expected);
+	return nexecuted == expected ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(void)
+{
+	static const char *policies[] = { "modular-eager", "modular-prio", "modular-heft", "modular-heft-prio" };
+	unsigned i;
+	int ret;
+
+	setenv("STARPU_SCHED_SHARDED_ABOVE", "3", 1);
+
+	for (i = 0; i < sizeof(policies) / sizeof(policies[0]); i++)
+	{
+		ret = run(policies[i]);
+		if (ret == STARPU_TEST_SKIPPED)
+		{
+			fprintf(stderr, "WARNING: No one can execute this task\n");
+			return STARPU_TEST_SKIPPED;
+		}
+		if (ret != EXIT_SUCCESS)
+			return ret;
+	}
+
+	return EXIT_SUCCESS;
+}
+#endif
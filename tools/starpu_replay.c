@@ -17,7 +17,9 @@
 
 /*
  * This reads a tasks.rec file and replays the recorded task graph.
- * Currently, this version is done to run with simgrid.
+ * This is meant to be run with simgrid, or with --sim to only get a quick
+ * estimation from a simple discrete-event simulation of the task graph (see
+ * starpu_replay_sim.c).
  *
  * For further information, contact erwan.leria@inria.fr
  */
@@ -50,6 +52,13 @@ static int static_workerid;
 extern void schedRecInit(const char * filename);
 extern void applySchedRec(struct starpu_task * starpu_task, long submit_order);
 
+/* See starpu_replay_sim.c */
+extern void replay_sim_usage(void);
+extern int replay_sim_parse_arg(int argc, char **argv, unsigned *i);
+extern void replay_sim_add_task(struct starpu_task *task, long submit_order, const double length[STARPU_NARCH], unsigned ndeps, struct starpu_task **deps);
+extern void replay_sim_run(double total_flops);
+static int simulate;
+
 /* Enum for normal and "wontuse" tasks */
 enum task_type {NormalTask, WontUseTask};
 
@@ -664,13 +673,70 @@ int submit_tasks(void)
 }
 
 
+/* Expected length of the task on one worker of each type */
+static void task_lengths(struct starpu_task *task, double length[STARPU_NARCH])
+{
+	struct task_arg *arg = task->cl_arg;
+	enum starpu_worker_archtype type;
+
+	for (type = 0; type < STARPU_NARCH; type++)
+	{
+		struct starpu_perfmodel_device device = { .type = type, .devid = 0, .ncores = 1 };
+		int comb = starpu_perfmodel_arch_comb_get(1, &device);
+
+		length[type] = NAN;
+		if (arg && comb != -1 && comb < (int) arg->narch)
+		{
+			double val = arg->perf[comb];
+			if (!(val == 0 || isnan(val)))
+				length[type] = val;
+		}
+	}
+}
+
+/* Function that simulates all the tasks instead of submitting them (used with --sim) */
+void simulate_tasks(void)
+{
+	struct starpu_rbtree_node * currentNode = starpu_rbtree_first(&tree);
+
+	while (currentNode != NULL)
+	{
+		struct task * currentTask = (struct task *) currentNode;
+
+		if (currentTask->type == NormalTask)
+		{
+			struct starpu_task * taskdeps[currentTask->ndependson ? currentTask->ndependson : 1];
+			double length[STARPU_NARCH];
+			unsigned i, j = 0;
+
+			for (i = 0; i < currentTask->ndependson; i++)
+			{
+				struct task * taskdep;
+
+				HASH_FIND(hh, tasks, &currentTask->deps[i], sizeof(jobid), taskdep);
+				if (taskdep)
+					taskdeps[j++] = &taskdep->task;
+			}
+
+			task_lengths(&currentTask->task, length);
+			replay_sim_add_task(&currentTask->task, currentTask->submit_order, length, j, taskdeps);
+		}
+
+		currentNode = starpu_rbtree_next(currentNode);
+	}
+
+	replay_sim_run(total_flops);
+}
+
+
 /* * * * * * * * * * * * * * * */
 /* * * * * * MAIN * * * * * * */
 /* * * * * * * * * * * * * * */
 
 static void usage(const char *program)
 {
-	fprintf(stderr,"Usage: %s [--static-workerid] tasks.rec [sched.rec]\n", program);
+	fprintf(stderr,"Usage: %s [--static-workerid] [--sim [simulation options]] tasks.rec [sched.rec]\n", program);
+	replay_sim_usage();
 	exit(EXIT_FAILURE);
 }
 
@@ -702,6 +768,14 @@ int main(int argc, char **argv)
 		{
 			static_workerid = 1;
 		}
+		else if (!strcmp(argv[i], "--sim"))
+		{
+			simulate = 1;
+		}
+		else if (replay_sim_parse_arg(argc, argv, &i))
+		{
+			simulate = 1;
+		}
 		else
 		{
 			if (!tasks_rec)
@@ -742,6 +816,9 @@ int main(int argc, char **argv)
 		if (!fgets(s, s_allocated, rec))
 		{
 			fprintf(stderr, " done.\n");
+			if (simulate)
+				goto eof;
+
 			int submitted = submit_tasks();
 
 			if (submitted == -1)
@@ -760,6 +837,9 @@ int main(int argc, char **argv)
 			if (!fgets(s + s_allocated-1, s_allocated+1, rec))
 			{
 				fprintf(stderr, "\n");
+				if (simulate)
+					goto eof;
+
 				int submitted = submit_tasks();
 
 				if (submitted == -1)
@@ -1138,13 +1218,18 @@ int main(int argc, char **argv)
 
 eof:
 
-	starpu_task_wait_for_all();
-	fprintf(stderr, " done.\n");
+	if (simulate)
+		simulate_tasks();
+	else
+	{
+		starpu_task_wait_for_all();
+		fprintf(stderr, " done.\n");
 
-	printf("%g ms", (starpu_timing_now() - start) / 1000.);
-	if (total_flops != 0.)
-		printf("\t%g GF/s", (total_flops / (starpu_timing_now() - start)) / 1000.);
-	printf("\n");
+		printf("%g ms", (starpu_timing_now() - start) / 1000.);
+		if (total_flops != 0.)
+			printf("\t%g GF/s", (total_flops / (starpu_timing_now() - start)) / 1000.);
+		printf("\n");
+	}
 
 	/* FREE allocated memory */
 
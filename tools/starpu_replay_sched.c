@@ -45,6 +45,9 @@
 
 #define CPY(src, dst, n) memcpy(dst, src, n * sizeof(*dst))
 
+/* Number of 32bit words needed for a bitmap of workers */
+#define NWORKERS_WORDS ((STARPU_NMAXWORKERS+31)/32)
+
 #if 0
 #define debug(fmt, ...) fprintf(stderr, fmt, ##__VA_ARGS__)
 #else
@@ -57,7 +60,7 @@ static int eosw;
 static unsigned workerorder;
 static int memnode;
 /* FIXME: MAXs */
-static uint32_t workers[STARPU_NMAXWORKERS/32];
+static uint32_t workers[NWORKERS_WORDS];
 static unsigned nworkers;
 static unsigned dependson[STARPU_NMAXBUFS];
 static unsigned ndependson;
@@ -91,7 +94,7 @@ static struct task
 	/* For real tasks */
 	int eosw;
 	unsigned workerorder;
-	uint32_t workers[STARPU_NMAXWORKERS/32];
+	uint32_t workers[NWORKERS_WORDS];
 	unsigned nworkers;
 
 	/* For prefetch tasks */
@@ -163,7 +166,7 @@ static void checkField(char * s)
 		{
 			int k = strtol(token, NULL, 10);
 			STARPU_ASSERT_MSG(k < STARPU_NMAXWORKERS, "%d is bigger than maximum %d\n", k, STARPU_NMAXWORKERS);
-			workers[k/(sizeof(*workers)*8)] |= (1 << (k%(sizeof(*workers)*8)));
+			workers[k/(sizeof(*workers)*8)] |= (1U << (k%(sizeof(*workers)*8)));
 			i++;
 			token = strtok(NULL, delim);
 		}
@@ -310,7 +313,7 @@ void schedRecInit(const char * filename)
 				/* A new task to mangle, record what needs to be done */
 				task->eosw = eosw;
 				task->workerorder = workerorder;
-				CPY(workers, task->workers, STARPU_NMAXWORKERS/32);
+				CPY(workers, task->workers, NWORKERS_WORDS);
 				task->nworkers = nworkers;
 				STARPU_ASSERT(nparams == 0);
 
@@ -425,8 +428,8 @@ void applySchedRec(struct starpu_task *starpu_task, unsigned long submit_order)
 	{
 		debug("%u workers %x\n", task->nworkers, task->workers[0]);
 		starpu_task->workerids_len = sizeof(task->workers) / sizeof(task->workers[0]);
-		_STARPU_MALLOC(starpu_task->workerids, task->nworkers * sizeof(*starpu_task->workerids));
-		CPY(task->workers, starpu_task->workerids, STARPU_NMAXWORKERS/32);
+		_STARPU_MALLOC(starpu_task->workerids, sizeof(task->workers));
+		CPY(task->workers, starpu_task->workerids, NWORKERS_WORDS);
 	}
 
 	if (task->ndependson)
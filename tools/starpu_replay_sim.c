@@ -0,0 +1,771 @@
+/* StarPU --- Runtime system for heterogeneous multicore architectures.
+ *
+ * Copyright (C) 2023  Université de Bordeaux, CNRS (LaBRI UMR 5800), Inria
+ *
+ * StarPU is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * StarPU is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU Lesser General Public License in COPYING.LGPL for more details.
+ */
+
+/*
+ * This simulates the execution of the task graph read by starpu_replay on a
+ * hypothetical machine, without SimGrid and without actually running the
+ * tasks: this is a mere discrete-event simulation, which thus runs in a matter
+ * of seconds even for big graphs.
+ *
+ * The machine is made of CPU workers sharing the main memory, and of
+ * accelerators of a given type, each having its own memory, connected to the
+ * main memory through their own link.  Task durations are taken from the
+ * performance models, and transfer durations from the bus performance model
+ * (or from the bandwidth and latency given on the command line). Memory
+ * capacity is not taken into account.
+ *
+ * A few classical scheduling heuristics are modelled after the StarPU
+ * policies of the same name:
+ *
+ * - eager: central FIFO queue
+ * - prio: central priority queue
+ * - random: random assignment at release, weighted by worker speed
+ * - dmda: assignment at release to the worker which minimizes the expected
+ *   termination time, including data transfers
+ * - dmdas: like dmda, but with the worker queues sorted by priority
+ */
+
+#include <starpu.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <float.h>
+
+#include <common/uthash.h>
+#include <common/utils.h>
+
+#define SIM_MAXACCELS 63
+
+/* Default link characteristics when there is no accelerator on the current
+ * machine to get them from the bus performance model */
+#define SIM_DEFAULT_BANDWIDTH 10000. /* MB/s */
+#define SIM_DEFAULT_LATENCY 10. /* µs */
+
+enum sim_policy
+{
+	SIM_EAGER,
+	SIM_PRIO,
+	SIM_RANDOM,
+	SIM_DMDA,
+	SIM_DMDAS,
+};
+
+static const char *sim_policy_names[] =
+{
+	[SIM_EAGER] = "eager",
+	[SIM_PRIO] = "prio",
+	[SIM_RANDOM] = "random",
+	[SIM_DMDA] = "dmda",
+	[SIM_DMDAS] = "dmdas",
+};
+
+/* Parameters of the simulated machine */
+static int sim_ncpus = -1;
+static int sim_naccels = -1;
+static enum starpu_worker_archtype sim_accel_type = STARPU_CUDA_WORKER;
+static double sim_bandwidth = -1.;
+static double sim_latency = -1.;
+static const char *sim_sched = NULL;
+static enum sim_policy sim_policy;
+
+struct sim_data
+{
+	UT_hash_handle hh;
+	starpu_data_handle_t handle;
+	size_t size;
+	/* Bitmap of the memory nodes which hold a valid copy, node 0 is the
+	 * main memory, node i+1 is the memory of accelerator i */
+	uint64_t valid;
+};
+
+struct sim_task
+{
+	UT_hash_handle hh;
+	struct starpu_task *task;
+	long submit_order;
+	/* Expected length on each type of worker, NAN if it can not run there */
+	double length[STARPU_NARCH];
+	unsigned nbuffers;
+	struct sim_data **data;
+	enum starpu_data_access_mode *modes;
+
+	struct sim_task **succs;
+	unsigned nsuccs;
+	unsigned alloc_succs;
+	/* Number of dependencies not released yet */
+	unsigned ndeps;
+
+	/* Order of release, for FIFO ordering */
+	unsigned long release_order;
+	/* Whether it was already popped from one of the queues */
+	int taken;
+};
+
+/* Binary heap of tasks, ordered by priority then release order, or of events,
+ * ordered by date. */
+struct sim_heap_entry
+{
+	double key;
+	unsigned long order;
+	void *ptr;
+};
+
+struct sim_heap
+{
+	struct sim_heap_entry *entries;
+	unsigned n;
+	unsigned alloc;
+};
+
+struct sim_worker
+{
+	enum starpu_worker_archtype type;
+	/* Memory node */
+	unsigned node;
+	/* Queue of tasks assigned to this worker, for dmda & random */
+	struct sim_heap queue;
+	/* Expected termination of the tasks queued on this worker, for dmda */
+	double expected_end;
+	/* Whether it is currently running a task */
+	int busy;
+	double busy_time;
+	unsigned long ntasks;
+};
+
+static struct sim_task *sim_tasks;
+static struct sim_data *sim_data;
+static unsigned long sim_ntasks;
+
+static struct sim_worker *sim_workers;
+static unsigned sim_nworkers;
+/* Per worker type queues, for eager & prio */
+static struct sim_heap sim_type_queues[STARPU_NARCH];
+/* Date at which the link of each accelerator becomes available */
+static double sim_link_available[SIM_MAXACCELS];
+/* Completion events */
+static struct sim_heap sim_events;
+
+static double sim_now;
+static unsigned long sim_release_order;
+static double sim_transferred;
+
+/*
+ * Heaps
+ */
+
+static int sim_heap_before(struct sim_heap_entry *a, struct sim_heap_entry *b)
+{
+	if (a->key != b->key)
+		return a->key < b->key;
+	return a->order < b->order;
+}
+
+static void sim_heap_push(struct sim_heap *heap, double key, unsigned long order, void *ptr)
+{
+	unsigned i;
+
+	if (heap->n == heap->alloc)
+	{
+		heap->alloc = heap->alloc ? heap->alloc * 2 : 16;
+		_STARPU_REALLOC(heap->entries, heap->alloc * sizeof(*heap->entries));
+	}
+
+	i = heap->n++;
+	heap->entries[i].key = key;
+	heap->entries[i].order = order;
+	heap->entries[i].ptr = ptr;
+
+	while (i > 0)
+	{
+		unsigned parent = (i - 1) / 2;
+		struct sim_heap_entry tmp;
+		if (!sim_heap_before(&heap->entries[i], &heap->entries[parent]))
+			break;
+		tmp = heap->entries[i];
+		heap->entries[i] = heap->entries[parent];
+		heap->entries[parent] = tmp;
+		i = parent;
+	}
+}
+
+static void *sim_heap_pop(struct sim_heap *heap, double *key)
+{
+	unsigned i = 0;
+	void *ptr;
+
+	if (!heap->n)
+		return NULL;
+
+	ptr = heap->entries[0].ptr;
+	if (key)
+		*key = heap->entries[0].key;
+	heap->entries[0] = heap->entries[--heap->n];
+
+	while (1)
+	{
+		unsigned left = 2 * i + 1, right = left + 1, smallest = i;
+		struct sim_heap_entry tmp;
+		if (left < heap->n && sim_heap_before(&heap->entries[left], &heap->entries[smallest]))
+			smallest = left;
+		if (right < heap->n && sim_heap_before(&heap->entries[right], &heap->entries[smallest]))
+			smallest = right;
+		if (smallest == i)
+			break;
+		tmp = heap->entries[i];
+		heap->entries[i] = heap->entries[smallest];
+		heap->entries[smallest] = tmp;
+		i = smallest;
+	}
+
+	return ptr;
+}
+
+/*
+ * Command line
+ */
+
+/* The driver of the simulated accelerators is not necessarily built in, so we
+ * can not rely on starpu_worker_get_type_as_string() */
+static const char *sim_type_name(enum starpu_worker_archtype type)
+{
+	switch (type)
+	{
+		case STARPU_CPU_WORKER: return "CPU";
+		case STARPU_CUDA_WORKER: return "CUDA";
+		case STARPU_OPENCL_WORKER: return "OpenCL";
+		case STARPU_HIP_WORKER: return "HIP";
+		default: return "unknown";
+	}
+}
+
+static enum starpu_worker_archtype sim_parse_type(const char *name)
+{
+	if (!strcasecmp(name, "cuda"))
+		return STARPU_CUDA_WORKER;
+	if (!strcasecmp(name, "opencl"))
+		return STARPU_OPENCL_WORKER;
+	if (!strcasecmp(name, "hip"))
+		return STARPU_HIP_WORKER;
+	fprintf(stderr, "Unknown accelerator type %s, use cuda, opencl or hip\n", name);
+	exit(EXIT_FAILURE);
+}
+
+void replay_sim_usage(void)
+{
+	fprintf(stderr, "Simulation options, to simulate the execution without SimGrid:\n");
+	fprintf(stderr, "   --sim                 simulate the execution instead of running it\n");
+	fprintf(stderr, "   --sim-ncpus <n>       number of CPU workers (default: as on this machine)\n");
+	fprintf(stderr, "   --sim-naccels <n>     number of accelerators (default: as on this machine)\n");
+	fprintf(stderr, "   --sim-accel <type>    type of accelerators: cuda, opencl or hip (default: cuda)\n");
+	fprintf(stderr, "   --sim-bandwidth <MB/s> bandwidth of the accelerator links (default: from the bus model)\n");
+	fprintf(stderr, "   --sim-latency <us>    latency of the accelerator links (default: from the bus model)\n");
+	fprintf(stderr, "   --sim-sched <policy>  eager, prio, random, dmda or dmdas (default: STARPU_SCHED, or dmda)\n");
+}
+
+/* Parse simulation options, return 1 if argv[*i] was one of them */
+int replay_sim_parse_arg(int argc, char **argv, unsigned *i)
+{
+	const char *arg = argv[*i];
+
+	if (strncmp(arg, "--sim-", 6))
+		return 0;
+
+	if (*i + 1 >= (unsigned) argc)
+	{
+		fprintf(stderr, "Missing value for option %s\n", arg);
+		exit(EXIT_FAILURE);
+	}
+	(*i)++;
+
+	if (!strcmp(arg, "--sim-ncpus"))
+		sim_ncpus = atoi(argv[*i]);
+	else if (!strcmp(arg, "--sim-naccels"))
+		sim_naccels = atoi(argv[*i]);
+	else if (!strcmp(arg, "--sim-accel"))
+		sim_accel_type = sim_parse_type(argv[*i]);
+	else if (!strcmp(arg, "--sim-bandwidth"))
+		sim_bandwidth = atof(argv[*i]);
+	else if (!strcmp(arg, "--sim-latency"))
+		sim_latency = atof(argv[*i]);
+	else if (!strcmp(arg, "--sim-sched"))
+		sim_sched = argv[*i];
+	else
+	{
+		fprintf(stderr, "Unknown option %s\n", arg);
+		replay_sim_usage();
+		exit(EXIT_FAILURE);
+	}
+	return 1;
+}
+
+/*
+ * Graph construction
+ */
+
+static struct sim_task *sim_get_task(struct starpu_task *task)
+{
+	struct sim_task *sim_task;
+	HASH_FIND_PTR(sim_tasks, &task, sim_task);
+	return sim_task;
+}
+
+static struct sim_data *sim_get_data(starpu_data_handle_t handle, enum starpu_data_access_mode mode)
+{
+	struct sim_data *data;
+	HASH_FIND_PTR(sim_data, &handle, data);
+	if (!data)
+	{
+		_STARPU_CALLOC(data, 1, sizeof(*data));
+		data->handle = handle;
+		data->size = starpu_data_get_size(handle);
+		/* Data which is read first is initially in main memory */
+		data->valid = (mode & STARPU_R) ? 1 : 0;
+		HASH_ADD_PTR(sim_data, handle, data);
+	}
+	return data;
+}
+
+/* Add a task to the simulated graph, in submission order, with its expected
+ * length on each type of worker, and the tasks it depends on */
+void replay_sim_add_task(struct starpu_task *task, long submit_order, const double length[STARPU_NARCH], unsigned ndeps, struct starpu_task **deps)
+{
+	struct sim_task *sim_task;
+	unsigned i;
+
+	_STARPU_CALLOC(sim_task, 1, sizeof(*sim_task));
+	sim_task->task = task;
+	sim_task->submit_order = submit_order;
+	memcpy(sim_task->length, length, sizeof(sim_task->length));
+
+	if (task->cl)
+	{
+		sim_task->nbuffers = STARPU_TASK_GET_NBUFFERS(task);
+		_STARPU_MALLOC(sim_task->data, sim_task->nbuffers * sizeof(*sim_task->data));
+		_STARPU_MALLOC(sim_task->modes, sim_task->nbuffers * sizeof(*sim_task->modes));
+		for (i = 0; i < sim_task->nbuffers; i++)
+		{
+			sim_task->modes[i] = STARPU_TASK_GET_MODE(task, i);
+			sim_task->data[i] = sim_get_data(STARPU_TASK_GET_HANDLE(task, i), sim_task->modes[i]);
+		}
+	}
+
+	for (i = 0; i < ndeps; i++)
+	{
+		struct sim_task *dep = sim_get_task(deps[i]);
+		if (!dep)
+			/* Not part of the simulation */
+			continue;
+		if (dep->nsuccs == dep->alloc_succs)
+		{
+			dep->alloc_succs = dep->alloc_succs ? dep->alloc_succs * 2 : 4;
+			_STARPU_REALLOC(dep->succs, dep->alloc_succs * sizeof(*dep->succs));
+		}
+		dep->succs[dep->nsuccs++] = sim_task;
+		sim_task->ndeps++;
+	}
+
+	HASH_ADD_PTR(sim_tasks, task, sim_task);
+	sim_ntasks++;
+}
+
+/*
+ * Machine
+ */
+
+static void sim_init_machine(void)
+{
+	unsigned i, node, n;
+
+	if (sim_ncpus < 0)
+		sim_ncpus = starpu_cpu_worker_get_count();
+	if (sim_naccels < 0)
+		sim_naccels = starpu_worker_get_count_by_type(sim_accel_type);
+	if (sim_naccels < 0)
+		sim_naccels = 0;
+	STARPU_ASSERT_MSG(sim_naccels <= SIM_MAXACCELS, "at most %d accelerators can be simulated", SIM_MAXACCELS);
+	STARPU_ASSERT_MSG(sim_ncpus + sim_naccels > 0, "the simulated machine has no worker");
+
+	if (sim_bandwidth < 0. || sim_latency < 0.)
+	{
+		/* Take the link characteristics from the bus performance model
+		 * of the first accelerator of this type, if any */
+		double bandwidth = SIM_DEFAULT_BANDWIDTH, latency = SIM_DEFAULT_LATENCY;
+		if (starpu_worker_get_count_by_type(sim_accel_type) > 0)
+		{
+			enum starpu_node_kind kind = starpu_worker_get_memory_node_kind(sim_accel_type);
+			n = starpu_memory_nodes_get_count();
+			for (node = 0; node < n; node++)
+				if (starpu_node_get_kind(node) == kind)
+				{
+					bandwidth = starpu_transfer_bandwidth(STARPU_MAIN_RAM, node);
+					latency = starpu_transfer_latency(STARPU_MAIN_RAM, node);
+					break;
+				}
+		}
+		if (sim_bandwidth < 0.)
+			sim_bandwidth = bandwidth;
+		if (sim_latency < 0.)
+			sim_latency = latency;
+	}
+
+	if (!sim_sched)
+		sim_sched = starpu_getenv("STARPU_SCHED");
+	if (!sim_sched)
+		sim_sched = "dmda";
+	for (i = 0; i < sizeof(sim_policy_names)/sizeof(sim_policy_names[0]); i++)
+		if (!strcmp(sim_sched, sim_policy_names[i]))
+			break;
+	if (i == sizeof(sim_policy_names)/sizeof(sim_policy_names[0]))
+	{
+		fprintf(stderr, "Scheduling policy %s can not be simulated, use eager, prio, random, dmda or dmdas\n", sim_sched);
+		exit(EXIT_FAILURE);
+	}
+	sim_policy = i;
+
+	sim_nworkers = sim_ncpus + sim_naccels;
+	_STARPU_CALLOC(sim_workers, sim_nworkers, sizeof(*sim_workers));
+	for (i = 0; i < sim_nworkers; i++)
+	{
+		if (i < (unsigned) sim_ncpus)
+		{
+			sim_workers[i].type = STARPU_CPU_WORKER;
+			sim_workers[i].node = 0;
+		}
+		else
+		{
+			sim_workers[i].type = sim_accel_type;
+			sim_workers[i].node = i - sim_ncpus + 1;
+		}
+	}
+
+	fprintf(stderr, "Simulating %d CPU(s) and %d %s accelerator(s) (%g MB/s, %g us) with policy %s\n",
+		sim_ncpus, sim_naccels, sim_type_name(sim_accel_type),
+		sim_bandwidth, sim_latency, sim_sched);
+}
+
+static int sim_can_execute(struct sim_task *task, enum starpu_worker_archtype type)
+{
+	return !isnan(task->length[type]);
+}
+
+/*
+ * Data transfers
+ */
+
+/* Expected time to transfer data to node, not taking link contention into
+ * account */
+static double sim_transfer_time(struct sim_data *data, unsigned node)
+{
+	double hop = sim_latency + data->size / sim_bandwidth;
+
+	if (data->valid & (1ULL << node) || !data->valid)
+		return 0.;
+	if (node == 0 || data->valid & 1)
+		/* One hop */
+		return hop;
+	/* Through main memory */
+	return 2 * hop;
+}
+
+/* Transfer data on the link of accelerator node, starting no earlier than
+ * date, and return the termination date */
+static double sim_link_transfer(unsigned node, struct sim_data *data, double date)
+{
+	double *available = &sim_link_available[node - 1];
+	if (*available > date)
+		date = *available;
+	date += sim_latency + data->size / sim_bandwidth;
+	*available = date;
+	sim_transferred += data->size;
+	return date;
+}
+
+/* Fetch data on node, starting at date, and return the termination date */
+static double sim_fetch(struct sim_data *data, unsigned node, double date)
+{
+	unsigned src;
+
+	if (data->valid & (1ULL << node) || !data->valid)
+		return date;
+
+	if (!(data->valid & 1))
+	{
+		/* First bring it back to main memory */
+		for (src = 1; !(data->valid & (1ULL << src)); src++)
+			;
+		date = sim_link_transfer(src, data, date);
+		data->valid |= 1;
+	}
+	if (node != 0)
+		date = sim_link_transfer(node, data, date);
+	data->valid |= 1ULL << node;
+	return date;
+}
+
+/*
+ * Scheduling
+ */
+
+static double sim_task_priority_key(struct sim_task *task)
+{
+	/* Heaps are min-heaps, higher priorities go first */
+	return -(double) task->task->priority;
+}
+
+/* The task was released at sim_now, push it to the scheduler */
+static void sim_push(struct sim_task *task)
+{
+	unsigned i, best = 0;
+	enum starpu_worker_archtype type;
+
+	task->release_order = sim_release_order++;
+
+	switch (sim_policy)
+	{
+		case SIM_EAGER:
+		case SIM_PRIO:
+			for (type = 0; type < STARPU_NARCH; type++)
+				if (sim_can_execute(task, type))
+					sim_heap_push(&sim_type_queues[type],
+						      sim_policy == SIM_PRIO ? sim_task_priority_key(task) : 0.,
+						      task->release_order, task);
+			return;
+
+		case SIM_RANDOM:
+		{
+			double total = 0., r;
+			for (i = 0; i < sim_nworkers; i++)
+				if (sim_can_execute(task, sim_workers[i].type))
+					total += 1. / task->length[sim_workers[i].type];
+			r = starpu_drand48() * total;
+			for (i = 0; i < sim_nworkers; i++)
+				if (sim_can_execute(task, sim_workers[i].type))
+				{
+					best = i;
+					r -= 1. / task->length[sim_workers[i].type];
+					if (r <= 0.)
+						break;
+				}
+			sim_heap_push(&sim_workers[best].queue, 0., task->release_order, task);
+			return;
+		}
+
+		case SIM_DMDA:
+		case SIM_DMDAS:
+		{
+			double best_end = DBL_MAX;
+			for (i = 0; i < sim_nworkers; i++)
+			{
+				struct sim_worker *worker = &sim_workers[i];
+				double end = worker->expected_end > sim_now ? worker->expected_end : sim_now;
+				unsigned j;
+
+				if (!sim_can_execute(task, worker->type))
+					continue;
+				for (j = 0; j < task->nbuffers; j++)
+					if (task->modes[j] & STARPU_R)
+						end += sim_transfer_time(task->data[j], worker->node);
+				end += task->length[worker->type];
+				if (end < best_end)
+				{
+					best_end = end;
+					best = i;
+				}
+			}
+			sim_workers[best].expected_end = best_end;
+			sim_heap_push(&sim_workers[best].queue,
+				      sim_policy == SIM_DMDAS ? sim_task_priority_key(task) : 0.,
+				      task->release_order, task);
+			return;
+		}
+	}
+}
+
+static struct sim_task *sim_pop(struct sim_worker *worker)
+{
+	struct sim_task *task;
+
+	if (sim_policy == SIM_EAGER || sim_policy == SIM_PRIO)
+	{
+		/* Tasks are queued for all the worker types able to run them */
+		while ((task = sim_heap_pop(&sim_type_queues[worker->type], NULL)) && task->taken)
+			;
+	}
+	else
+		task = sim_heap_pop(&worker->queue, NULL);
+
+	if (task)
+		task->taken = 1;
+	return task;
+}
+
+/* Start task on worker at sim_now */
+static void sim_start(struct sim_worker *worker, struct sim_task *task)
+{
+	double start = sim_now, end;
+	unsigned i;
+
+	for (i = 0; i < task->nbuffers; i++)
+	{
+		if (task->modes[i] & STARPU_R)
+		{
+			double fetched = sim_fetch(task->data[i], worker->node, sim_now);
+			if (fetched > start)
+				start = fetched;
+		}
+	}
+
+	end = start + task->length[worker->type];
+	worker->busy = 1;
+	worker->busy_time += end - sim_now;
+	worker->ntasks++;
+	sim_heap_push(&sim_events, end, task->release_order, task);
+	/* Remember who runs it */
+	task->taken = 1 + (worker - sim_workers);
+}
+
+static void sim_release(struct sim_task *task);
+
+/* Task terminated at sim_now */
+static void sim_terminate(struct sim_task *task, struct sim_worker *worker)
+{
+	unsigned i;
+
+	if (worker)
+	{
+		worker->busy = 0;
+		for (i = 0; i < task->nbuffers; i++)
+			if (task->modes[i] & STARPU_W)
+				task->data[i]->valid = 1ULL << worker->node;
+	}
+
+	for (i = 0; i < task->nsuccs; i++)
+		if (!--task->succs[i]->ndeps)
+			sim_release(task->succs[i]);
+}
+
+static void sim_release(struct sim_task *task)
+{
+	unsigned i;
+
+	if (!task->task->cl)
+	{
+		/* Does not need a worker */
+		sim_terminate(task, NULL);
+		return;
+	}
+
+	for (i = 0; i < sim_nworkers; i++)
+		if (sim_can_execute(task, sim_workers[i].type))
+			break;
+	if (i == sim_nworkers)
+	{
+		fprintf(stderr, "Task %s (submit order %ld) can not be executed on any of the simulated workers\n",
+			task->task->name ? task->task->name : "unknown", task->submit_order);
+		exit(EXIT_FAILURE);
+	}
+
+	sim_push(task);
+}
+
+static void sim_dispatch(void)
+{
+	unsigned i;
+
+	for (i = 0; i < sim_nworkers; i++)
+	{
+		struct sim_worker *worker = &sim_workers[i];
+		struct sim_task *task;
+
+		if (worker->busy)
+			continue;
+		task = sim_pop(worker);
+		if (task)
+			sim_start(worker, task);
+	}
+}
+
+/*
+ * Main loop
+ */
+
+void replay_sim_run(double total_flops)
+{
+	struct sim_task *task, *tmp;
+	double date;
+	unsigned i;
+	enum starpu_worker_archtype type;
+
+	sim_init_machine();
+
+	sim_now = 0.;
+	HASH_ITER(hh, sim_tasks, task, tmp)
+		if (!task->ndeps)
+			sim_release(task);
+	sim_dispatch();
+
+	while ((task = sim_heap_pop(&sim_events, &date)))
+	{
+		sim_now = date;
+		sim_terminate(task, &sim_workers[task->taken - 1]);
+		sim_dispatch();
+	}
+
+	HASH_ITER(hh, sim_tasks, task, tmp)
+		if (task->ndeps)
+		{
+			fprintf(stderr, "Task %s (submit order %ld) was never released, the graph has a cycle or missing tasks\n",
+				task->task->name ? task->task->name : "unknown", task->submit_order);
+			break;
+		}
+
+	fprintf(stderr, "Simulated %lu tasks, %g MB transferred\n", sim_ntasks, sim_transferred / 1000000.);
+	for (i = 0; i < sim_nworkers; i++)
+		fprintf(stderr, "%s %u: %lu tasks, %.2f%% busy\n",
+			sim_type_name(sim_workers[i].type),
+			sim_workers[i].type == STARPU_CPU_WORKER ? i : i - sim_ncpus,
+			sim_workers[i].ntasks,
+			sim_now > 0. ? sim_workers[i].busy_time * 100. / sim_now : 0.);
+
+	printf("%g ms", sim_now / 1000.);
+	if (total_flops != 0. && sim_now > 0.)
+		printf("\t%g GF/s", (total_flops / sim_now) / 1000.);
+	printf("\n");
+
+	/* Free everything */
+	HASH_ITER(hh, sim_tasks, task, tmp)
+	{
+		HASH_DEL(sim_tasks, task);
+		free(task->succs);
+		free(task->data);
+		free(task->modes);
+		free(task);
+	}
+	struct sim_data *data, *datatmp;
+	HASH_ITER(hh, sim_data, data, datatmp)
+	{
+		HASH_DEL(sim_data, data);
+		free(data);
+	}
+	for (i = 0; i < sim_nworkers; i++)
+		free(sim_workers[i].queue.entries);
+	free(sim_workers);
+	for (type = 0; type < STARPU_NARCH; type++)
+		free(sim_type_queues[type].entries);
+	free(sim_events.entries);
+}